@@ -27,6 +27,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
 #include "client.h"
+#include "composite.h"
 #include "cursor.h"
 #include "focuschain.h"
 #include "netinfo.h"
@@ -406,6 +407,49 @@ void Workspace::clientHidden(Client* c)
     activateNextClient(c);
 }
 
+void Workspace::clientMappingChanged(Client* c, bool hidden)
+{
+    if (Compositor::isCreated()) {
+        Compositor::self()->checkUnredirect(c);
+    }
+    if (block_visibility_updates > 0) {
+        pending_mapping_changes = true;
+        if (hidden) {
+            pending_hidden_region += c->visibleRect();
+            pending_hidden_clients.append(c);
+        }
+        return;
+    }
+    if (hidden) {
+        c->addWorkspaceRepaint(c->visibleRect());
+        clientHidden(c);
+    }
+}
+
+void Workspace::blockVisibilityUpdates(bool block)
+{
+    if (block) {
+        ++block_visibility_updates;
+        return;
+    }
+    if (--block_visibility_updates > 0 || !pending_mapping_changes) {
+        return;
+    }
+    pending_mapping_changes = false;
+    if (compositing()) {
+        Compositor::self()->addRepaint(pending_hidden_region);
+    }
+    pending_hidden_region = QRegion();
+    const ClientList hidden = pending_hidden_clients;
+    pending_hidden_clients.clear();
+    foreach (Client *c, hidden) {
+        // the client might have been shown again while updates were blocked
+        if (!c->isShown(true) || !c->isOnCurrentDesktop() || !c->isOnCurrentActivity()) {
+            clientHidden(c);
+        }
+    }
+}
+
 Client *Workspace::clientUnderMouse(int screen) const
 {
     ToplevelList::const_iterator it = stackingOrder().constEnd();
@@ -18,6 +18,7 @@ You should have received a copy of the GNU General Public License
 along with this program.  If not, see <http://www.gnu.org/licenses/>.
 *********************************************************************/
 #include "../effectloader.h"
+#include "../effects/activationstub.h"
 #include "../effects/effect_builtins.h"
 #include "mock_effectshandler.h"
 #include "../scripting/scriptedeffect.h" // for mocking ScriptedEffect::create
@@ -25,6 +26,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <KConfig>
 #include <KConfigGroup>
 // Qt
+#include <QAction>
 #include <QtTest/QtTest>
 #include <QStringList>
 Q_DECLARE_METATYPE(KWin::CompositingType)
@@ -57,6 +59,9 @@ private Q_SLOTS:
     void testLoadBuiltInEffect_data();
     void testLoadBuiltInEffect();
     void testLoadAllEffects();
+    void testLoadOnActivation();
+    void testActivationStub_data();
+    void testActivationStub();
 };
 
 void TestBuiltInEffectLoader::testHasEffect_data()
@@ -544,5 +549,93 @@ void TestBuiltInEffectLoader::testLoadAllEffects()
     QCOMPARE(loadedEffects.at(1), QStringLiteral("mouseclick"));
 }
 
+void TestBuiltInEffectLoader::testLoadOnActivation()
+{
+    MockEffectsHandler mockHandler(KWin::OpenGL2Compositing);
+    KWin::BuiltInEffectLoader loader;
+    KSharedConfig::Ptr config = KSharedConfig::openConfig(QString(), KConfig::SimpleConfig);
+    config->group("Effect-DesktopGrid").writeEntry("BorderActivate", QList<int>() << int(KWin::ElectricLeft));
+    loader.setConfig(config);
+
+    qRegisterMetaType<KWin::Effect*>();
+    QSignalSpy spy(&loader, SIGNAL(effectLoaded(KWin::Effect*,QString)));
+
+    // loading all effects only creates a stub for the desktop grid
+    QVERIFY(loader.loadEffect(KWin::BuiltInEffect::DesktopGrid, KWin::LoadEffectFlag::Load | KWin::LoadEffectFlag::CreateOnActivation));
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(spy.first().at(1).toString(), QStringLiteral("desktopgrid"));
+    KWin::ActivationStub *stub = qobject_cast<KWin::ActivationStub*>(spy.first().first().value<KWin::Effect*>());
+    QVERIFY(stub);
+    QCOMPARE(stub->effect(), KWin::BuiltInEffect::DesktopGrid);
+    QVERIFY(!stub->isActive());
+    // the stub counts as loaded
+    QVERIFY(!loader.loadEffect(QStringLiteral("desktopgrid")));
+    QCOMPARE(spy.count(), 1);
+
+    QSignalSpy activatedSpy(stub, SIGNAL(activated()));
+    QVERIFY(activatedSpy.isValid());
+    // only the configured screen edge activates it
+    QVERIFY(!stub->borderActivated(KWin::ElectricTop));
+    QVERIFY(activatedSpy.isEmpty());
+    QVERIFY(stub->borderActivated(KWin::ElectricLeft));
+    QCOMPARE(activatedSpy.count(), 1);
+    QCOMPARE(stub->triggeredBorder(), KWin::ElectricLeft);
+
+    // the stub provides the shortcut of the effect
+    QAction *action = stub->findChild<QAction*>(QStringLiteral("ShowDesktopGrid"));
+    QVERIFY(action);
+    action->trigger();
+    QCOMPARE(activatedSpy.count(), 2);
+    QCOMPARE(stub->triggeredShortcut(), QStringLiteral("ShowDesktopGrid"));
+
+    // the pending replacement must not touch the deleted stub
+    delete stub;
+    QTest::qWait(1);
+
+    // loading without the flag creates the real effect
+    QVERIFY(loader.loadEffect(KWin::BuiltInEffect::LookingGlass, KWin::LoadEffectFlag::Load));
+    QCOMPARE(spy.count(), 2);
+    QCOMPARE(spy.last().at(1).toString(), QStringLiteral("lookingglass"));
+    KWin::Effect *effect = spy.last().first().value<KWin::Effect*>();
+    QVERIFY(!qobject_cast<KWin::ActivationStub*>(effect));
+    delete effect;
+}
+
+void TestBuiltInEffectLoader::testActivationStub_data()
+{
+    QTest::addColumn<KWin::BuiltInEffect>("effect");
+    QTest::addColumn<QString>("group");
+    QTest::addColumn<QString>("key");
+    QTest::addColumn<QVariant>("value");
+    QTest::addColumn<bool>("expected");
+
+    QTest::newRow("MouseClick")        << KWin::BuiltInEffect::MouseClick << QString() << QString() << QVariant() << false;
+    QTest::newRow("PresentWindows")    << KWin::BuiltInEffect::PresentWindows << QString() << QString() << QVariant() << false;
+    QTest::newRow("Cube")              << KWin::BuiltInEffect::Cube << QString() << QString() << QVariant() << true;
+    QTest::newRow("Cube-TabBox")       << KWin::BuiltInEffect::Cube << QStringLiteral("Effect-Cube") << QStringLiteral("TabBox") << QVariant(true) << false;
+    QTest::newRow("FlipSwitch")        << KWin::BuiltInEffect::FlipSwitch << QString() << QString() << QVariant() << true;
+    QTest::newRow("FlipSwitch-TabBox") << KWin::BuiltInEffect::FlipSwitch << QStringLiteral("Effect-FlipSwitch") << QStringLiteral("TabBoxAlternative") << QVariant(true) << false;
+    QTest::newRow("Magnifier")         << KWin::BuiltInEffect::Magnifier << QString() << QString() << QVariant() << true;
+    QTest::newRow("Zoom")              << KWin::BuiltInEffect::Zoom << QString() << QString() << QVariant() << true;
+    QTest::newRow("Zoom-Initial")      << KWin::BuiltInEffect::Zoom << QStringLiteral("Effect-Zoom") << QStringLiteral("InitialZoom") << QVariant(2.0) << false;
+}
+
+void TestBuiltInEffectLoader::testActivationStub()
+{
+    QFETCH(KWin::BuiltInEffect, effect);
+    QFETCH(QString, group);
+    QFETCH(QString, key);
+    QFETCH(QVariant, value);
+
+    MockEffectsHandler mockHandler(KWin::OpenGL2Compositing);
+    KSharedConfig::Ptr config = KSharedConfig::openConfig(QString(), KConfig::SimpleConfig);
+    if (!group.isEmpty()) {
+        config->group(group).writeEntry(key, value);
+    }
+
+    QScopedPointer<KWin::ActivationStub> stub(KWin::ActivationStub::create(effect, config));
+    QTEST(!stub.isNull(), "expected");
+}
+
 QTEST_MAIN(TestBuiltInEffectLoader)
 #include "test_builtin_effectloader.moc"
@@ -0,0 +1,226 @@
+/********************************************************************
+ KWin - the KDE window manager
+ This file is part of the KDE project.
+
+Copyright (C) 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#include "../focuschainlist.h"
+
+#include <QtTest/QtTest>
+
+using namespace KWin;
+
+// the list never dereferences the clients
+static Client *fakeClient(quintptr id)
+{
+    return reinterpret_cast<Client*>(id);
+}
+
+class TestFocusChainList : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testEmpty();
+    void testAppendPrepend();
+    void testInsert();
+    void testRemove();
+    void testMatchesQList();
+    void benchmarkFocusCycling();
+
+private:
+    static QList<Client*> toList(const FocusChainList &chain);
+};
+
+QList<Client*> TestFocusChainList::toList(const FocusChainList &chain)
+{
+    QList<Client*> list;
+    for (Client *c = chain.first(); c; c = chain.next(c)) {
+        list << c;
+    }
+    // the backward links have to match
+    QList<Client*> reversed;
+    for (Client *c = chain.last(); c; c = chain.previous(c)) {
+        reversed.prepend(c);
+    }
+    if (list != reversed) {
+        qWarning() << "Forward and backward links differ" << list << reversed;
+        return QList<Client*>();
+    }
+    return list;
+}
+
+void TestFocusChainList::testEmpty()
+{
+    FocusChainList chain;
+    QVERIFY(chain.isEmpty());
+    QCOMPARE(chain.count(), 0);
+    QVERIFY(!chain.first());
+    QVERIFY(!chain.last());
+    QVERIFY(!chain.contains(fakeClient(1)));
+    QVERIFY(!chain.previous(fakeClient(1)));
+    QVERIFY(!chain.next(fakeClient(1)));
+    // removing an unknown client is fine
+    chain.remove(fakeClient(1));
+    QVERIFY(chain.isEmpty());
+}
+
+void TestFocusChainList::testAppendPrepend()
+{
+    FocusChainList chain;
+    chain.append(fakeClient(1));
+    chain.append(fakeClient(2));
+    chain.prepend(fakeClient(3));
+    QCOMPARE(toList(chain), QList<Client*>() << fakeClient(3) << fakeClient(1) << fakeClient(2));
+    QCOMPARE(chain.first(), fakeClient(3));
+    QCOMPARE(chain.last(), fakeClient(2));
+    QCOMPARE(chain.count(), 3);
+
+    // appending an existing client moves it
+    chain.append(fakeClient(3));
+    QCOMPARE(toList(chain), QList<Client*>() << fakeClient(1) << fakeClient(2) << fakeClient(3));
+    chain.prepend(fakeClient(2));
+    QCOMPARE(toList(chain), QList<Client*>() << fakeClient(2) << fakeClient(1) << fakeClient(3));
+    QCOMPARE(chain.count(), 3);
+
+    chain.clear();
+    QVERIFY(chain.isEmpty());
+    QVERIFY(!chain.contains(fakeClient(1)));
+}
+
+void TestFocusChainList::testInsert()
+{
+    FocusChainList chain;
+    chain.append(fakeClient(1));
+    chain.append(fakeClient(2));
+    chain.insertBefore(fakeClient(3), fakeClient(2));
+    QCOMPARE(toList(chain), QList<Client*>() << fakeClient(1) << fakeClient(3) << fakeClient(2));
+    chain.insertBefore(fakeClient(4), fakeClient(1));
+    QCOMPARE(toList(chain), QList<Client*>() << fakeClient(4) << fakeClient(1) << fakeClient(3) << fakeClient(2));
+    chain.insertAfter(fakeClient(4), fakeClient(2));
+    QCOMPARE(toList(chain), QList<Client*>() << fakeClient(1) << fakeClient(3) << fakeClient(2) << fakeClient(4));
+    chain.insertAfter(fakeClient(2), fakeClient(1));
+    QCOMPARE(toList(chain), QList<Client*>() << fakeClient(1) << fakeClient(2) << fakeClient(3) << fakeClient(4));
+
+    // unknown reference appends, client as its own reference does nothing
+    chain.insertBefore(fakeClient(1), fakeClient(5));
+    QCOMPARE(toList(chain), QList<Client*>() << fakeClient(2) << fakeClient(3) << fakeClient(4) << fakeClient(1));
+    chain.insertAfter(fakeClient(3), fakeClient(3));
+    QCOMPARE(toList(chain), QList<Client*>() << fakeClient(2) << fakeClient(3) << fakeClient(4) << fakeClient(1));
+    QVERIFY(!chain.contains(fakeClient(5)));
+}
+
+void TestFocusChainList::testRemove()
+{
+    FocusChainList chain;
+    for (int i = 1; i <= 4; ++i) {
+        chain.append(fakeClient(i));
+    }
+    chain.remove(fakeClient(1));
+    QCOMPARE(chain.first(), fakeClient(2));
+    chain.remove(fakeClient(4));
+    QCOMPARE(chain.last(), fakeClient(3));
+    chain.remove(fakeClient(2));
+    QCOMPARE(toList(chain), QList<Client*>() << fakeClient(3));
+    QVERIFY(!chain.previous(fakeClient(3)));
+    QVERIFY(!chain.next(fakeClient(3)));
+    chain.remove(fakeClient(3));
+    QVERIFY(chain.isEmpty());
+    QVERIFY(!chain.first());
+    QVERIFY(!chain.last());
+}
+
+void TestFocusChainList::testMatchesQList()
+{
+    // random operations on the chain and the list based implementation it replaces
+    qsrand(42);
+    FocusChainList chain;
+    QList<Client*> list;
+    for (int i = 0; i < 5000; ++i) {
+        Client *client = fakeClient(1 + qrand() % 30);
+        Client *reference = fakeClient(1 + qrand() % 30);
+        switch (qrand() % 5) {
+        case 0:
+            chain.append(client);
+            list.removeAll(client);
+            list.append(client);
+            break;
+        case 1:
+            chain.prepend(client);
+            list.removeAll(client);
+            list.prepend(client);
+            break;
+        case 2:
+            if (client == reference || !list.contains(reference)) {
+                continue;
+            }
+            chain.insertBefore(client, reference);
+            list.removeAll(client);
+            list.insert(list.indexOf(reference), client);
+            break;
+        case 3:
+            if (client == reference || !list.contains(reference)) {
+                continue;
+            }
+            chain.insertAfter(client, reference);
+            list.removeAll(client);
+            list.insert(list.indexOf(reference) + 1, client);
+            break;
+        case 4:
+            chain.remove(client);
+            list.removeAll(client);
+            break;
+        }
+        QCOMPARE(chain.count(), list.count());
+        QCOMPARE(chain.contains(client), list.contains(client));
+    }
+    QCOMPARE(toList(chain), list);
+}
+
+void TestFocusChainList::benchmarkFocusCycling()
+{
+    // the operations of FocusChain while cycling through thousands of windows on many
+    // desktops: each activation makes the window the last one in its desktop chain and in
+    // the most recently used chain, the next one gets inserted after the active one
+    const int clientCount = 5000;
+    const int desktopCount = 20;
+    QVector<FocusChainList> desktops(desktopCount);
+    FocusChainList mostRecentlyUsed;
+    for (int i = 1; i <= clientCount; ++i) {
+        desktops[i % desktopCount].append(fakeClient(i));
+        mostRecentlyUsed.append(fakeClient(i));
+    }
+    QBENCHMARK {
+        for (int i = 1; i <= clientCount; ++i) {
+            Client *client = fakeClient(i);
+            FocusChainList &desktop = desktops[i % desktopCount];
+            desktop.append(client);
+            mostRecentlyUsed.append(client);
+            Client *next = fakeClient(1 + (i * 7) % clientCount);
+            mostRecentlyUsed.insertBefore(next, client);
+            // close and reopen a window
+            if (i % 10 == 0) {
+                desktop.remove(client);
+                mostRecentlyUsed.remove(client);
+                desktop.insertBefore(client, desktop.last());
+                mostRecentlyUsed.insertBefore(client, mostRecentlyUsed.last());
+            }
+        }
+    }
+    QCOMPARE(mostRecentlyUsed.count(), clientCount);
+}
+
+QTEST_MAIN(TestFocusChainList)
+#include "test_focus_chain_list.moc"
@@ -0,0 +1,100 @@
+/********************************************************************
+KWin - the KDE window manager
+This file is part of the KDE project.
+
+Copyright (C) 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#include "../hiddenpixmapbudget.h"
+
+#include <QtTest/QtTest>
+
+using namespace KWin;
+
+Q_DECLARE_METATYPE(QVector<HiddenPixmapBudget::Pixmap>)
+
+class TestHiddenPixmapBudget : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testSelect_data();
+    void testSelect();
+    void testThumbnailAfterRelease();
+};
+
+static HiddenPixmapBudget::Pixmap pixmap(quint64 memory, quint64 lastUse, bool recreatable)
+{
+    HiddenPixmapBudget::Pixmap p;
+    p.memory = memory;
+    p.lastUse = lastUse;
+    p.recreatable = recreatable;
+    return p;
+}
+
+void TestHiddenPixmapBudget::testSelect_data()
+{
+    QTest::addColumn<QVector<HiddenPixmapBudget::Pixmap> >("pixmaps");
+    QTest::addColumn<quint64>("budget");
+    QTest::addColumn<QVector<int> >("expected");
+
+    QTest::newRow("empty") << QVector<HiddenPixmapBudget::Pixmap>() << quint64(100) << QVector<int>();
+    QTest::newRow("within budget")
+        << (QVector<HiddenPixmapBudget::Pixmap>() << pixmap(40, 1, true) << pixmap(60, 2, true))
+        << quint64(100) << QVector<int>();
+    QTest::newRow("least recently used first")
+        << (QVector<HiddenPixmapBudget::Pixmap>() << pixmap(40, 3, true) << pixmap(40, 1, true) << pixmap(40, 2, true))
+        << quint64(100) << (QVector<int>() << 1);
+    QTest::newRow("several")
+        << (QVector<HiddenPixmapBudget::Pixmap>() << pixmap(40, 3, true) << pixmap(40, 1, true) << pixmap(40, 2, true))
+        << quint64(40) << (QVector<int>() << 1 << 2);
+    QTest::newRow("used in this pass")
+        << (QVector<HiddenPixmapBudget::Pixmap>() << pixmap(40, 5, true) << pixmap(40, 1, true))
+        << quint64(0) << (QVector<int>() << 1);
+    // a minimized window is unmapped, its pixmap could not be recreated for a thumbnail
+    QTest::newRow("unmapped")
+        << (QVector<HiddenPixmapBudget::Pixmap>() << pixmap(100, 1, false) << pixmap(40, 2, true))
+        << quint64(50) << (QVector<int>() << 1);
+    QTest::newRow("only unmapped")
+        << (QVector<HiddenPixmapBudget::Pixmap>() << pixmap(100, 1, false) << pixmap(100, 2, false))
+        << quint64(0) << QVector<int>();
+}
+
+void TestHiddenPixmapBudget::testSelect()
+{
+    QFETCH(QVector<HiddenPixmapBudget::Pixmap>, pixmaps);
+    QFETCH(quint64, budget);
+    QTEST(HiddenPixmapBudget::select(pixmaps, budget, 5), "expected");
+}
+
+void TestHiddenPixmapBudget::testThumbnailAfterRelease()
+{
+    // a kept and a minimized window over budget, only the kept one gets released
+    QVector<HiddenPixmapBudget::Pixmap> pixmaps;
+    pixmaps << pixmap(100, 1, true) << pixmap(100, 1, false);
+    QCOMPARE(HiddenPixmapBudget::select(pixmaps, 100, 2), QVector<int>() << 0);
+
+    // a thumbnail recreates the pixmap of the kept window in the next pass, the minimized
+    // window still has its pixmap, so neither of them may be released now
+    pixmaps[0].lastUse = 3;
+    pixmaps[1].lastUse = 3;
+    QCOMPARE(HiddenPixmapBudget::select(pixmaps, 100, 3), QVector<int>());
+
+    // once the thumbnail is gone the kept window is released again, never the minimized one
+    QCOMPARE(HiddenPixmapBudget::select(pixmaps, 100, 4), QVector<int>() << 0);
+    QCOMPARE(HiddenPixmapBudget::select(pixmaps, 0, 4), QVector<int>() << 0);
+}
+
+QTEST_MAIN(TestHiddenPixmapBudget)
+#include "test_hidden_pixmap_budget.moc"
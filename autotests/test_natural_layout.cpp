@@ -0,0 +1,132 @@
+/********************************************************************
+KWin - the KDE window manager
+This file is part of the KDE project.
+
+Copyright (C) 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#include "../effects/presentwindows/naturallayout.h"
+
+#include <QtTest/QtTest>
+
+using namespace KWin;
+
+class TestNaturalLayout : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testEmpty();
+    void testNoOverlap_data();
+    void testNoOverlap();
+    void testDeterministic();
+    void benchmarkLayout_data();
+    void benchmarkLayout();
+
+private:
+    static QVector<QRect> randomGeometries(int count, const QRect &area);
+    static const QRect s_area;
+};
+
+const QRect TestNaturalLayout::s_area = QRect(0, 0, 1920, 1080);
+
+QVector<QRect> TestNaturalLayout::randomGeometries(int count, const QRect &area)
+{
+    // fixed seed so that every run lays out the same windows
+    qsrand(count);
+    QVector<QRect> geometries;
+    geometries.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        const int width = 100 + qrand() % (area.width() / 2);
+        const int height = 100 + qrand() % (area.height() / 2);
+        geometries << QRect(area.x() + qrand() % (area.width() - width),
+                            area.y() + qrand() % (area.height() - height),
+                            width, height);
+    }
+    return geometries;
+}
+
+void TestNaturalLayout::testEmpty()
+{
+    NaturalLayout layout(s_area, 20, true);
+    QVERIFY(layout.layout(QVector<QRect>()).isEmpty());
+}
+
+void TestNaturalLayout::testNoOverlap_data()
+{
+    QTest::addColumn<int>("count");
+    QTest::addColumn<bool>("fillGaps");
+
+    QTest::newRow("2") << 2 << false;
+    QTest::newRow("10") << 10 << false;
+    QTest::newRow("30") << 30 << false;
+    QTest::newRow("2/fill") << 2 << true;
+    QTest::newRow("10/fill") << 10 << true;
+    QTest::newRow("30/fill") << 30 << true;
+}
+
+void TestNaturalLayout::testNoOverlap()
+{
+    QFETCH(int, count);
+    QFETCH(bool, fillGaps);
+    const QVector<QRect> geometries = randomGeometries(count, s_area);
+    const QVector<QRect> targets = NaturalLayout(s_area, 20, fillGaps).layout(geometries);
+    QCOMPARE(targets.count(), count);
+    for (int i = 0; i < count; ++i) {
+        // windows are never scaled to more than twice their size
+        QVERIFY(targets.at(i).width() <= geometries.at(i).width() * 2);
+        for (int j = i + 1; j < count; ++j) {
+            // allow for rounding when scaling the targets onto the screen
+            QVERIFY(!targets.at(i).adjusted(1, 1, -1, -1).intersects(targets.at(j).adjusted(1, 1, -1, -1)));
+        }
+    }
+}
+
+void TestNaturalLayout::testDeterministic()
+{
+    const QVector<QRect> geometries = randomGeometries(50, s_area);
+    NaturalLayout layout(s_area, 20, true);
+    QCOMPARE(layout.layout(geometries), layout.layout(geometries));
+}
+
+void TestNaturalLayout::benchmarkLayout_data()
+{
+    QTest::addColumn<int>("count");
+    QTest::addColumn<bool>("fillGaps");
+
+    QTest::newRow("10") << 10 << false;
+    QTest::newRow("50") << 50 << false;
+    QTest::newRow("100") << 100 << false;
+    QTest::newRow("250") << 250 << false;
+    QTest::newRow("500") << 500 << false;
+    QTest::newRow("10/fill") << 10 << true;
+    QTest::newRow("50/fill") << 50 << true;
+    QTest::newRow("100/fill") << 100 << true;
+    QTest::newRow("250/fill") << 250 << true;
+    QTest::newRow("500/fill") << 500 << true;
+}
+
+void TestNaturalLayout::benchmarkLayout()
+{
+    QFETCH(int, count);
+    QFETCH(bool, fillGaps);
+    const QVector<QRect> geometries = randomGeometries(count, s_area);
+    NaturalLayout layout(s_area, 20, fillGaps);
+    QBENCHMARK {
+        layout.layout(geometries);
+    }
+}
+
+QTEST_MAIN(TestNaturalLayout)
+#include "test_natural_layout.moc"
@@ -0,0 +1,187 @@
+/********************************************************************
+ KWin - the KDE window manager
+ This file is part of the KDE project.
+
+Copyright (C) 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#include "../occupancymap.h"
+
+#include <QtTest/QtTest>
+
+using namespace KWin;
+
+class TestOccupancyMap : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testEmpty();
+    void testSingleRect_data();
+    void testSingleRect();
+    void testWeights();
+    void testOverlappingRects();
+    void testMatchesBruteForce();
+    void benchmarkSmartPlacementQueries();
+
+private:
+    struct Window {
+        QRect rect;
+        int weight;
+    };
+    static QVector<Window> randomWindows(int count, const QRect &screen);
+    static qint64 bruteForce(const QVector<Window> &windows, int left, int top, int right, int bottom);
+};
+
+QVector<TestOccupancyMap::Window> TestOccupancyMap::randomWindows(int count, const QRect &screen)
+{
+    QVector<Window> windows;
+    for (int i = 0; i < count; ++i) {
+        Window w;
+        const int width = 50 + qrand() % (screen.width() / 2);
+        const int height = 50 + qrand() % (screen.height() / 2);
+        w.rect = QRect(screen.x() + qrand() % (screen.width() - width),
+                       screen.y() + qrand() % (screen.height() - height),
+                       width, height);
+        w.weight = (i % 7 == 0) ? 16 : 1;
+        windows << w;
+    }
+    return windows;
+}
+
+qint64 TestOccupancyMap::bruteForce(const QVector<Window> &windows, int left, int top, int right, int bottom)
+{
+    // the overlap computation of the former Placement::placeSmart
+    qint64 overlap = 0;
+    foreach (const Window &w, windows) {
+        int xl = w.rect.x();
+        int yt = w.rect.y();
+        int xr = xl + w.rect.width();
+        int yb = yt + w.rect.height();
+        if ((left < xr) && (right > xl) && (top < yb) && (bottom > yt)) {
+            xl = qMax(left, xl); xr = qMin(right, xr);
+            yt = qMax(top, yt); yb = qMin(bottom, yb);
+            overlap += qint64(w.weight) * (xr - xl) * (yb - yt);
+        }
+    }
+    return overlap;
+}
+
+void TestOccupancyMap::testEmpty()
+{
+    OccupancyMap map;
+    map.build();
+    QCOMPARE(map.overlap(0, 0, 100, 100), qint64(0));
+
+    // empty rects and rects without weight are ignored
+    map.addRect(QRect(0, 0, 0, 100), 1);
+    map.addRect(QRect(0, 0, 100, 100), 0);
+    map.build();
+    QCOMPARE(map.overlap(0, 0, 100, 100), qint64(0));
+}
+
+void TestOccupancyMap::testSingleRect_data()
+{
+    QTest::addColumn<QRect>("query");
+    QTest::addColumn<qint64>("expected");
+
+    // the map contains QRect(100, 100, 100, 50)
+    QTest::newRow("same")     << QRect(100, 100, 100, 50) << qint64(5000);
+    QTest::newRow("covering") << QRect(0, 0, 500, 500)    << qint64(5000);
+    QTest::newRow("inside")   << QRect(110, 110, 10, 10)  << qint64(100);
+    QTest::newRow("left")     << QRect(50, 100, 60, 50)   << qint64(500);
+    QTest::newRow("corner")   << QRect(190, 140, 20, 20)  << qint64(100);
+    QTest::newRow("touching") << QRect(200, 100, 50, 50)  << qint64(0);
+    QTest::newRow("outside")  << QRect(300, 300, 50, 50)  << qint64(0);
+}
+
+void TestOccupancyMap::testSingleRect()
+{
+    OccupancyMap map;
+    map.addRect(QRect(100, 100, 100, 50), 1);
+    map.build();
+
+    QFETCH(QRect, query);
+    QFETCH(qint64, expected);
+    QCOMPARE(map.overlap(query.x(), query.y(), query.x() + query.width(), query.y() + query.height()), expected);
+}
+
+void TestOccupancyMap::testWeights()
+{
+    OccupancyMap map;
+    map.addRect(QRect(0, 0, 10, 10), 16);
+    map.addRect(QRect(20, 0, 10, 10), 1);
+    map.build();
+    QCOMPARE(map.overlap(0, 0, 10, 10), qint64(1600));
+    QCOMPARE(map.overlap(20, 0, 30, 10), qint64(100));
+    QCOMPARE(map.overlap(5, 0, 25, 10), qint64(16 * 50 + 50));
+}
+
+void TestOccupancyMap::testOverlappingRects()
+{
+    // overlapping windows are counted for each window
+    OccupancyMap map;
+    map.addRect(QRect(0, 0, 100, 100), 1);
+    map.addRect(QRect(50, 50, 100, 100), 1);
+    map.build();
+    QCOMPARE(map.overlap(0, 0, 150, 150), qint64(20000));
+    QCOMPARE(map.overlap(50, 50, 100, 100), qint64(5000));
+}
+
+void TestOccupancyMap::testMatchesBruteForce()
+{
+    const QRect screen(0, 0, 1920, 1080);
+    qsrand(42);
+    for (int round = 0; round < 20; ++round) {
+        const QVector<Window> windows = randomWindows(1 + round * 5, screen);
+        OccupancyMap map;
+        foreach (const Window &w, windows) {
+            map.addRect(w.rect, w.weight);
+        }
+        map.build();
+        for (int i = 0; i < 200; ++i) {
+            const int left = qrand() % screen.width() - 100;
+            const int top = qrand() % screen.height() - 100;
+            const int right = left + qrand() % 800;
+            const int bottom = top + qrand() % 600;
+            QCOMPARE(map.overlap(left, top, right, bottom), bruteForce(windows, left, top, right, bottom));
+        }
+    }
+}
+
+void TestOccupancyMap::benchmarkSmartPlacementQueries()
+{
+    // the query pattern of smart placement on a desktop with many windows:
+    // one table, overlap queries for each candidate position
+    const QRect screen(0, 0, 1920, 1080);
+    qsrand(23);
+    const QVector<Window> windows = randomWindows(300, screen);
+    qint64 total = 0;
+    QBENCHMARK {
+        OccupancyMap map;
+        foreach (const Window &w, windows) {
+            map.addRect(w.rect, w.weight);
+        }
+        map.build();
+        for (int y = 0; y < screen.height(); y += 20) {
+            for (int x = 0; x < screen.width(); x += 20) {
+                total += map.overlap(x, y, x + 400, y + 300);
+            }
+        }
+    }
+    QVERIFY(total > 0);
+}
+
+QTEST_MAIN(TestOccupancyMap)
+#include "test_occupancy_map.moc"
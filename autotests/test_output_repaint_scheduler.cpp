@@ -0,0 +1,101 @@
+/********************************************************************
+KWin - the KDE window manager
+This file is part of the KDE project.
+
+Copyright (C) 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#include "../outputrepaintscheduler.h"
+
+#include <QtTest/QtTest>
+
+using namespace KWin;
+
+class TestOutputRepaintScheduler : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testSetOutputs();
+    void testFrameInterval_data();
+    void testFrameInterval();
+    void testStatistics();
+};
+
+void TestOutputRepaintScheduler::testSetOutputs()
+{
+    OutputRepaintScheduler scheduler;
+    QCOMPARE(scheduler.count(), 0);
+    QCOMPARE(scheduler.frameInterval(QRegion(0, 0, 10, 10)), qint64(0));
+
+    scheduler.setOutputs(QVector<QRect>() << QRect(0, 0, 100, 100) << QRect(100, 0, 200, 100) << QRect(0, 100, 100, 100),
+                         QVector<int>() << 60 << 30 << -1);
+    QCOMPARE(scheduler.count(), 3);
+    QCOMPARE(scheduler.geometry(1), QRect(100, 0, 200, 100));
+    QCOMPARE(scheduler.refreshRate(0), 60);
+    QCOMPARE(scheduler.refreshRate(1), 30);
+    QCOMPARE(scheduler.refreshRate(2), -1);
+
+    // missing rates are unknown
+    scheduler.setOutputs(QVector<QRect>() << QRect(0, 0, 100, 100), QVector<int>());
+    QCOMPARE(scheduler.count(), 1);
+    QCOMPARE(scheduler.refreshRate(0), -1);
+}
+
+void TestOutputRepaintScheduler::testFrameInterval_data()
+{
+    QTest::addColumn<QRegion>("damage");
+    QTest::addColumn<qint64>("expected");
+
+    QTest::newRow("empty") << QRegion() << qint64(0);
+    QTest::newRow("60 Hz") << QRegion(10, 10, 20, 20) << qint64(1000000000 / 60);
+    QTest::newRow("30 Hz") << QRegion(150, 10, 20, 20) << qint64(1000000000 / 30);
+    QTest::newRow("fastest wins") << QRegion(90, 10, 20, 20) << qint64(1000000000 / 60);
+    QTest::newRow("unknown") << QRegion(10, 150, 20, 20) << qint64(0);
+    QTest::newRow("unknown and 30 Hz") << (QRegion(150, 10, 20, 20) | QRegion(10, 150, 20, 20)) << qint64(0);
+    QTest::newRow("offscreen") << QRegion(200, 150, 20, 20) << qint64(0);
+}
+
+void TestOutputRepaintScheduler::testFrameInterval()
+{
+    // a 60 Hz output next to a 30 Hz output and one with unknown rate below
+    OutputRepaintScheduler scheduler;
+    scheduler.setOutputs(QVector<QRect>() << QRect(0, 0, 100, 100) << QRect(100, 0, 200, 100) << QRect(0, 100, 100, 100),
+                         QVector<int>() << 60 << 30 << -1);
+    QFETCH(QRegion, damage);
+    QTEST(scheduler.frameInterval(damage), "expected");
+}
+
+void TestOutputRepaintScheduler::testStatistics()
+{
+    OutputRepaintScheduler scheduler;
+    scheduler.setOutputs(QVector<QRect>() << QRect(0, 0, 100, 100) << QRect(100, 0, 200, 100) << QRect(0, 100, 100, 100),
+                         QVector<int>() << 60 << 30 << -1);
+    scheduler.addFrame(QRegion(10, 10, 20, 20));
+    scheduler.addFrame(QRegion(90, 10, 20, 20));
+    scheduler.addFrame(QRegion());
+    QCOMPARE(scheduler.frameCount(), quint64(3));
+    QCOMPARE(scheduler.dirtyFrameCount(0), quint64(2));
+    QCOMPARE(scheduler.dirtyFrameCount(1), quint64(1));
+    QCOMPARE(scheduler.dirtyFrameCount(2), quint64(0));
+    QVERIFY(scheduler.supportInformation().contains(QStringLiteral("damaged in 2 of 3 frames")));
+
+    // new outputs start from scratch
+    scheduler.setOutputs(QVector<QRect>() << QRect(0, 0, 100, 100), QVector<int>() << 60);
+    QCOMPARE(scheduler.frameCount(), quint64(0));
+    QCOMPARE(scheduler.dirtyFrameCount(0), quint64(0));
+}
+
+QTEST_MAIN(TestOutputRepaintScheduler)
+#include "test_output_repaint_scheduler.moc"
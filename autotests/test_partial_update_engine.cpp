@@ -0,0 +1,205 @@
+/********************************************************************
+KWin - the KDE window manager
+This file is part of the KDE project.
+
+Copyright (C) 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#include "../partialupdateengine.h"
+
+#include <QtTest/QtTest>
+
+using namespace KWin;
+
+class TestPartialUpdateEngine : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testBufferAge();
+    void testPresentStrategy();
+    void testHeuristic_data();
+    void testHeuristic();
+    void testMeasuredCost();
+    void testOverheadCost();
+    void testUnmeasuredFrame();
+    void testStatistics();
+    void testScreenSizeResetsCost();
+
+private:
+    static void measure(PartialUpdateEngine &engine, PartialUpdateEngine::Strategy strategy,
+                        const QRegion &region, qint64 time);
+    static const QSize s_screen;
+};
+
+const QSize TestPartialUpdateEngine::s_screen = QSize(1000, 1000);
+
+void TestPartialUpdateEngine::measure(PartialUpdateEngine &engine, PartialUpdateEngine::Strategy strategy,
+                                      const QRegion &region, qint64 time)
+{
+    for (int i = 0; i < PartialUpdateEngine::minimumSamples; ++i) {
+        engine.addRenderedFrame(region, time / 2);
+        engine.addPresentedFrame(strategy, time / 2);
+    }
+}
+
+void TestPartialUpdateEngine::testBufferAge()
+{
+    PartialUpdateEngine engine;
+    engine.setScreenSize(s_screen);
+    engine.setSupportsBufferAge(true);
+    QVERIFY(engine.supportsBufferAge());
+    QVERIFY(!engine.prefersFullRepaint(QRegion(0, 0, 1000, 999), false));
+    QCOMPARE(engine.presentStrategy(QRegion(0, 0, 10, 10)), PartialUpdateEngine::BufferAge);
+    QCOMPARE(engine.presentStrategy(QRegion(QRect(QPoint(0, 0), s_screen))), PartialUpdateEngine::BufferAge);
+}
+
+void TestPartialUpdateEngine::testPresentStrategy()
+{
+    PartialUpdateEngine engine;
+    engine.setScreenSize(s_screen);
+    QCOMPARE(engine.presentStrategy(QRegion(0, 0, 10, 10)), PartialUpdateEngine::CopySubBuffer);
+    QCOMPARE(engine.presentStrategy(QRegion(QRect(QPoint(0, 0), s_screen))), PartialUpdateEngine::FullSwap);
+}
+
+void TestPartialUpdateEngine::testHeuristic_data()
+{
+    QTest::addColumn<QRegion>("damage");
+    QTest::addColumn<bool>("opaqueFullscreen");
+    QTest::addColumn<bool>("fullRepaint");
+
+    QTest::newRow("empty") << QRegion() << false << false;
+    QTest::newRow("small") << QRegion(0, 0, 100, 100) << false << false;
+    QTest::newRow("large") << QRegion(0, 0, 1000, 800) << false << true;
+    QTest::newRow("half") << QRegion(0, 0, 1000, 500) << false << false;
+    QTest::newRow("half/fullscreen") << QRegion(0, 0, 1000, 500) << true << true;
+    // the threshold applies to single rects
+    QTest::newRow("two halfs") << QRegion(0, 0, 1000, 400).united(QRegion(0, 500, 1000, 400)) << false << false;
+}
+
+void TestPartialUpdateEngine::testHeuristic()
+{
+    PartialUpdateEngine engine;
+    engine.setScreenSize(s_screen);
+    QFETCH(QRegion, damage);
+    QFETCH(bool, opaqueFullscreen);
+    QTEST(engine.prefersFullRepaint(damage, opaqueFullscreen), "fullRepaint");
+}
+
+void TestPartialUpdateEngine::testMeasuredCost()
+{
+    PartialUpdateEngine engine;
+    engine.setScreenSize(s_screen);
+    // a full swap costs 1 ns per pixel, copying costs 4 ns per pixel
+    measure(engine, PartialUpdateEngine::FullSwap, QRegion(QRect(QPoint(0, 0), s_screen)), 1000000);
+    measure(engine, PartialUpdateEngine::CopySubBuffer, QRegion(0, 0, 100, 100), 40000);
+    QCOMPARE(engine.costPerPixel(PartialUpdateEngine::FullSwap), 1.0);
+    QCOMPARE(engine.costPerPixel(PartialUpdateEngine::CopySubBuffer), 4.0);
+    QCOMPARE(engine.costPerPixel(PartialUpdateEngine::BufferAge), 0.0);
+
+    // break even is at a quarter of the screen
+    QVERIFY(!engine.prefersFullRepaint(QRegion(0, 0, 1000, 240), false));
+    QVERIFY(engine.prefersFullRepaint(QRegion(0, 0, 1000, 260), false));
+    // the measured cost also applies to damage split in several rects
+    QVERIFY(engine.prefersFullRepaint(QRegion(0, 0, 1000, 130).united(QRegion(0, 500, 1000, 130)), false));
+}
+
+void TestPartialUpdateEngine::testOverheadCost()
+{
+    PartialUpdateEngine engine;
+    engine.setScreenSize(s_screen);
+    measure(engine, PartialUpdateEngine::FullSwap, QRegion(QRect(QPoint(0, 0), s_screen)), 1000000);
+    // copying costs 100 us per present, 20 us per rect and 2 ns per pixel
+    const QRegion twoRects = QRegion(0, 0, 100, 100).united(QRegion(0, 500, 100, 100));
+    for (int i = 0; i < PartialUpdateEngine::minimumSamples; ++i) {
+        measure(engine, PartialUpdateEngine::CopySubBuffer, QRegion(0, 0, 100, 100), 100000 + 20000 + 2 * 10000);
+        measure(engine, PartialUpdateEngine::CopySubBuffer, QRegion(0, 0, 1000, 100), 100000 + 20000 + 2 * 100000);
+        measure(engine, PartialUpdateEngine::CopySubBuffer, twoRects, 100000 + 2 * 20000 + 2 * 20000);
+    }
+    QCOMPARE(engine.costPerPresent(PartialUpdateEngine::CopySubBuffer), 100000.0);
+    QCOMPARE(engine.costPerRect(PartialUpdateEngine::CopySubBuffer), 20000.0);
+    QCOMPARE(engine.costPerPixel(PartialUpdateEngine::CopySubBuffer), 2.0);
+    // a full swap does not vary, so all of it is attributed to the pixels
+    QCOMPARE(engine.costPerPresent(PartialUpdateEngine::FullSwap), 0.0);
+    QCOMPARE(engine.costPerPixel(PartialUpdateEngine::FullSwap), 1.0);
+
+    // break even of a single rect is at 440000 pixels
+    QVERIFY(!engine.prefersFullRepaint(QRegion(0, 0, 1000, 430), false));
+    QVERIFY(engine.prefersFullRepaint(QRegion(0, 0, 1000, 450), false));
+    // many small rects are expensive because of the overhead per rect
+    QRegion small;
+    for (int i = 0; i < 40; ++i) {
+        small |= QRegion(i * 20, 0, 10, 10);
+    }
+    QVERIFY(!engine.prefersFullRepaint(small, false));
+    for (int i = 40; i < 50; ++i) {
+        small |= QRegion(i * 20, 0, 10, 10);
+    }
+    QVERIFY(engine.prefersFullRepaint(small, false));
+}
+
+void TestPartialUpdateEngine::testUnmeasuredFrame()
+{
+    PartialUpdateEngine engine;
+    engine.setScreenSize(s_screen);
+    measure(engine, PartialUpdateEngine::FullSwap, QRegion(QRect(QPoint(0, 0), s_screen)), 1000000);
+    // a frame presented without measurement is counted but does not change the cost
+    engine.addRenderedFrame(QRegion(0, 0, 100, 100), 1000000);
+    engine.addPresentedFrame(PartialUpdateEngine::FullSwap, -1);
+    QCOMPARE(engine.presentCount(PartialUpdateEngine::FullSwap), quint64(PartialUpdateEngine::minimumSamples + 1));
+    QCOMPARE(engine.costPerPixel(PartialUpdateEngine::FullSwap), 1.0);
+    engine.addRenderedFrame(QRegion(0, 0, 100, 100), 40000);
+    engine.addPresentedFrame(PartialUpdateEngine::CopySubBuffer, -1);
+    QCOMPARE(engine.costPerPixel(PartialUpdateEngine::CopySubBuffer), 0.0);
+    QCOMPARE(engine.lastStrategy(), PartialUpdateEngine::CopySubBuffer);
+}
+
+void TestPartialUpdateEngine::testStatistics()
+{
+    PartialUpdateEngine engine;
+    engine.setScreenSize(s_screen);
+    QCOMPARE(engine.frameCount(), quint64(0));
+    QCOMPARE(engine.averageRepaintRatio(), 0.0);
+
+    engine.addRenderedFrame(QRegion(0, 0, 1000, 500), 10);
+    engine.addPresentedFrame(PartialUpdateEngine::CopySubBuffer, 10);
+    QCOMPARE(engine.lastRepaintRatio(), 0.5);
+    engine.addRenderedFrame(QRegion(QRect(QPoint(0, 0), s_screen)), 10);
+    engine.addPresentedFrame(PartialUpdateEngine::FullSwap, 10);
+    QCOMPARE(engine.lastRepaintRatio(), 1.0);
+    engine.addRenderedFrame(QRegion(), 10);
+    QCOMPARE(engine.lastRepaintRatio(), 0.0);
+
+    QCOMPARE(engine.frameCount(), quint64(3));
+    QCOMPARE(engine.averageRepaintRatio(), 0.5);
+    QCOMPARE(engine.presentCount(PartialUpdateEngine::CopySubBuffer), quint64(1));
+    QCOMPARE(engine.presentCount(PartialUpdateEngine::FullSwap), quint64(1));
+    QCOMPARE(engine.presentCount(PartialUpdateEngine::BufferAge), quint64(0));
+    QCOMPARE(engine.lastStrategy(), PartialUpdateEngine::FullSwap);
+    QVERIFY(!engine.supportInformation().isEmpty());
+}
+
+void TestPartialUpdateEngine::testScreenSizeResetsCost()
+{
+    PartialUpdateEngine engine;
+    engine.setScreenSize(s_screen);
+    measure(engine, PartialUpdateEngine::FullSwap, QRegion(QRect(QPoint(0, 0), s_screen)), 1000000);
+    QCOMPARE(engine.costPerPixel(PartialUpdateEngine::FullSwap), 1.0);
+    engine.setScreenSize(QSize(2000, 1000));
+    QCOMPARE(engine.costPerPixel(PartialUpdateEngine::FullSwap), 0.0);
+    QCOMPARE(engine.screenSize(), QSize(2000, 1000));
+}
+
+QTEST_MAIN(TestPartialUpdateEngine)
+#include "test_partial_update_engine.moc"
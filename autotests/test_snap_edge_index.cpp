@@ -0,0 +1,142 @@
+/********************************************************************
+ KWin - the KDE window manager
+ This file is part of the KDE project.
+
+Copyright (C) 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#include "../snapedgeindex.h"
+
+#include <QtTest/QtTest>
+
+using namespace KWin;
+
+// the index never dereferences the clients
+static Client *fakeClient(quintptr id)
+{
+    return reinterpret_cast<Client*>(id);
+}
+
+class TestSnapEdgeIndex : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testInsertRemove();
+    void testCandidates_data();
+    void testCandidates();
+    void testUpdate();
+    void testInsertionOrder();
+    void testZeroSize();
+};
+
+void TestSnapEdgeIndex::testInsertRemove()
+{
+    SnapEdgeIndex index;
+    QCOMPARE(index.count(), 0);
+    index.insert(fakeClient(1), QRect(0, 0, 100, 100));
+    index.insert(fakeClient(2), QRect(200, 0, 100, 100));
+    QCOMPARE(index.count(), 2);
+    QVERIFY(index.contains(fakeClient(1)));
+    QVERIFY(index.contains(fakeClient(2)));
+
+    index.remove(fakeClient(1));
+    QCOMPARE(index.count(), 1);
+    QVERIFY(!index.contains(fakeClient(1)));
+    QVERIFY(index.candidates(QRect(0, 0, 100, 100), 10).isEmpty());
+
+    // removing again is a no-op
+    index.remove(fakeClient(1));
+    QCOMPARE(index.count(), 1);
+
+    index.clear();
+    QCOMPARE(index.count(), 0);
+    QVERIFY(index.candidates(QRect(200, 0, 100, 100), 10).isEmpty());
+}
+
+void TestSnapEdgeIndex::testCandidates_data()
+{
+    QTest::addColumn<QRect>("geometry");
+    QTest::addColumn<int>("distance");
+    QTest::addColumn<bool>("found");
+
+    // the indexed client is at QRect(100, 100, 100, 100)
+    QTest::newRow("far away")         << QRect(500, 500, 50, 50)  << 10 << false;
+    QTest::newRow("left to right")    << QRect(205, 400, 50, 50)  << 10 << true;
+    QTest::newRow("right to left")    << QRect(45, 400, 50, 50)   << 10 << true;
+    QTest::newRow("top to bottom")    << QRect(400, 209, 50, 50)  << 10 << true;
+    QTest::newRow("bottom to top")    << QRect(400, 41, 50, 50)   << 10 << true;
+    QTest::newRow("exclusive limit")  << QRect(210, 400, 50, 50)  << 10 << false;
+    QTest::newRow("exclusive limit2") << QRect(400, 40, 50, 50)   << 10 << false;
+    QTest::newRow("same edge")        << QRect(100, 400, 50, 50)  << 1  << true;
+    QTest::newRow("no distance")      << QRect(100, 100, 100, 100) << 0 << false;
+}
+
+void TestSnapEdgeIndex::testCandidates()
+{
+    SnapEdgeIndex index;
+    index.insert(fakeClient(1), QRect(100, 100, 100, 100));
+
+    QFETCH(QRect, geometry);
+    QFETCH(int, distance);
+    QFETCH(bool, found);
+    QCOMPARE(index.candidates(geometry, distance).contains(fakeClient(1)), found);
+}
+
+void TestSnapEdgeIndex::testUpdate()
+{
+    SnapEdgeIndex index;
+    index.insert(fakeClient(1), QRect(0, 0, 100, 100));
+    QCOMPARE(index.candidates(QRect(100, 400, 50, 50), 5), QList<Client*>() << fakeClient(1));
+
+    index.update(fakeClient(1), QRect(500, 500, 100, 100));
+    QVERIFY(index.candidates(QRect(100, 400, 50, 50), 5).isEmpty());
+    QCOMPARE(index.candidates(QRect(600, 0, 50, 50), 5), QList<Client*>() << fakeClient(1));
+
+    // updating a client which is not indexed does not add it
+    index.update(fakeClient(2), QRect(600, 0, 50, 50));
+    QVERIFY(!index.contains(fakeClient(2)));
+    QCOMPARE(index.candidates(QRect(600, 0, 50, 50), 5), QList<Client*>() << fakeClient(1));
+}
+
+void TestSnapEdgeIndex::testInsertionOrder()
+{
+    SnapEdgeIndex index;
+    // inserted in an order which differs from the spatial and the pointer order
+    index.insert(fakeClient(3), QRect(0, 0, 100, 100));
+    index.insert(fakeClient(1), QRect(100, 0, 100, 100));
+    index.insert(fakeClient(2), QRect(50, 0, 50, 100));
+
+    // every client touches the query with several edges, each must be returned once
+    const QList<Client*> expected = QList<Client*>() << fakeClient(3) << fakeClient(1) << fakeClient(2);
+    QCOMPARE(index.candidates(QRect(0, 0, 100, 100), 60), expected);
+
+    // an update keeps the position in the order
+    index.update(fakeClient(3), QRect(10, 0, 100, 100));
+    QCOMPARE(index.candidates(QRect(0, 0, 100, 100), 60), expected);
+}
+
+void TestSnapEdgeIndex::testZeroSize()
+{
+    SnapEdgeIndex index;
+    index.insert(fakeClient(1), QRect(100, 100, 0, 0));
+    QCOMPARE(index.candidates(QRect(100, 100, 10, 10), 1), QList<Client*>() << fakeClient(1));
+    index.update(fakeClient(1), QRect(300, 300, 10, 10));
+    QVERIFY(index.candidates(QRect(100, 100, 10, 10), 5).isEmpty());
+    index.remove(fakeClient(1));
+    QVERIFY(index.candidates(QRect(300, 300, 10, 10), 5).isEmpty());
+}
+
+QTEST_MAIN(TestSnapEdgeIndex)
+#include "test_snap_edge_index.moc"
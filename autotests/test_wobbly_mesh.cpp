@@ -0,0 +1,158 @@
+/********************************************************************
+KWin - the KDE window manager
+This file is part of the KDE project.
+
+Copyright (C) 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#include "../effects/wobblywindows/wobblymesh.h"
+
+#include <QtTest/QtTest>
+
+using namespace KWin;
+
+// the default "wobblyness" of the effect
+static const WobblyMeshParameters s_parameters = {
+    0.15f,
+    0.80f,
+    0.10f,
+    0.0f,
+    1000.0f,
+    0.0f,
+    1000.0f
+};
+static const float s_stopAcceleration = 0.5f;
+static const float s_stopVelocity = 0.5f;
+
+class TestWobblyMesh : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testAtRest();
+    void testComesToRest();
+    void testFollowsGeometry();
+    void testNoWobble();
+    void benchmarkStep_data();
+    void benchmarkStep();
+};
+
+void TestWobblyMesh::testAtRest()
+{
+    const QRectF geometry(100, 50, 300, 200);
+    WobblyMesh mesh;
+    mesh.init(geometry);
+    QCOMPARE(mesh.originX[0], 100.0f);
+    QCOMPARE(mesh.originY[0], 50.0f);
+    QCOMPARE(mesh.originX[WobblyMesh::Count - 1], 400.0f);
+    QCOMPARE(mesh.originY[WobblyMesh::Count - 1], 250.0f);
+
+    WobblyMeshEnergy energy;
+    WobblyMesh::step(&mesh, &geometry, 1, 10.0f, s_parameters, &energy);
+    QVERIFY(energy.acceleration < s_stopAcceleration);
+    QVERIFY(energy.velocity < s_stopVelocity);
+    for (int i = 0; i < WobblyMesh::Count; ++i) {
+        QVERIFY(qAbs(mesh.positionX[i] - mesh.originX[i]) < 0.01f);
+        QVERIFY(qAbs(mesh.positionY[i] - mesh.originY[i]) < 0.01f);
+    }
+}
+
+void TestWobblyMesh::testComesToRest()
+{
+    const QRectF geometry(0, 0, 500, 400);
+    WobblyMesh mesh;
+    mesh.init(geometry);
+    // throb outwards like a window getting maximized
+    for (int j = 0; j < WobblyMesh::Height; ++j) {
+        for (int i = 0; i < WobblyMesh::Width; ++i) {
+            mesh.velocityX[j * WobblyMesh::Width + i] = 10.0f * (i / float(WobblyMesh::Width - 1) - 0.5f);
+            mesh.velocityY[j * WobblyMesh::Width + i] = 10.0f * (j / float(WobblyMesh::Height - 1) - 0.5f);
+        }
+    }
+
+    WobblyMeshEnergy energy;
+    int steps = 0;
+    do {
+        WobblyMesh::step(&mesh, &geometry, 1, 10.0f, s_parameters, &energy);
+        ++steps;
+    } while ((energy.acceleration >= s_stopAcceleration || energy.velocity >= s_stopVelocity) && steps < 1000);
+    QVERIFY(steps > 1);
+    QVERIFY(steps < 1000);
+    for (int i = 0; i < WobblyMesh::Count; ++i) {
+        QVERIFY(qAbs(mesh.positionX[i] - mesh.originX[i]) < 5.0f);
+        QVERIFY(qAbs(mesh.positionY[i] - mesh.originY[i]) < 5.0f);
+    }
+}
+
+void TestWobblyMesh::testFollowsGeometry()
+{
+    WobblyMesh mesh;
+    mesh.init(QRectF(0, 0, 300, 300));
+    // grab the top left corner and move the window
+    mesh.constraint[0] = 1.0f;
+    const QRectF geometry(200, 100, 300, 300);
+    WobblyMeshEnergy energy;
+    for (int i = 0; i < 500; ++i) {
+        WobblyMesh::step(&mesh, &geometry, 1, 10.0f, s_parameters, &energy);
+    }
+    QVERIFY(qAbs(mesh.positionX[0] - 200.0f) < 5.0f);
+    QVERIFY(qAbs(mesh.positionY[0] - 100.0f) < 5.0f);
+    QVERIFY(qAbs(mesh.positionX[WobblyMesh::Count - 1] - 500.0f) < 5.0f);
+    QVERIFY(qAbs(mesh.positionY[WobblyMesh::Count - 1] - 400.0f) < 5.0f);
+}
+
+void TestWobblyMesh::testNoWobble()
+{
+    WobblyMesh mesh;
+    mesh.init(QRectF(0, 0, 300, 300));
+    mesh.canWobbleTop = mesh.canWobbleLeft = mesh.canWobbleRight = mesh.canWobbleBottom = false;
+    mesh.constraint[0] = 1.0f;
+    const QRectF geometry(50, 50, 300, 300);
+    WobblyMeshEnergy energy;
+    WobblyMesh::step(&mesh, &geometry, 1, 10.0f, s_parameters, &energy);
+    for (int i = 0; i < WobblyMesh::Count; ++i) {
+        QCOMPARE(mesh.positionX[i], mesh.originX[i]);
+        QCOMPARE(mesh.positionY[i], mesh.originY[i]);
+    }
+}
+
+void TestWobblyMesh::benchmarkStep_data()
+{
+    QTest::addColumn<int>("count");
+
+    QTest::newRow("1") << 1;
+    QTest::newRow("8") << 8;
+    QTest::newRow("32") << 32;
+    QTest::newRow("128") << 128;
+}
+
+void TestWobblyMesh::benchmarkStep()
+{
+    QFETCH(int, count);
+    QVector<WobblyMesh> meshes(count);
+    QVector<QRectF> geometries;
+    QVector<WobblyMeshEnergy> energies(count);
+    for (int i = 0; i < count; ++i) {
+        meshes[i].init(QRectF(i * 10, i * 5, 400, 300));
+        meshes[i].constraint[5] = 1.0f;
+        // every window is being dragged
+        geometries << QRectF(i * 10 + 50, i * 5 + 30, 400, 300);
+    }
+    QBENCHMARK {
+        WobblyMesh::step(meshes.data(), geometries.constData(), count, 10.0f, s_parameters, energies.data());
+    }
+}
+
+QTEST_MAIN(TestWobblyMesh)
+#include "test_wobbly_mesh.moc"
@@ -231,6 +231,7 @@ Client::Client()
 #endif
     , m_decoInputExtent()
     , m_focusOutTimer(nullptr)
+    , m_moveResizeFrameTimer(nullptr)
     , m_palette(QApplication::palette())
     , m_clientSideDecorated(false)
 {
@@ -240,6 +241,9 @@ Client::Client()
     syncRequest.lastTimestamp = xTime();
     syncRequest.isPending = false;
 
+    m_pendingMotion.x = m_pendingMotion.y = m_pendingMotion.xRoot = m_pendingMotion.yRoot = 0;
+    m_pendingMotion.isPending = false;
+
     // Set the initial mapping state
     mapping_state = Withdrawn;
     quick_tile_mode = QuickTileNone;
@@ -1260,9 +1264,7 @@ void Client::internalShow()
         m_decoInputExtent.map();
         updateHiddenPreview();
     }
-    if (Compositor::isCreated()) {
-        Compositor::self()->checkUnredirect();
-    }
+    workspace()->clientMappingChanged(this, false);
 }
 
 void Client::internalHide()
@@ -1275,11 +1277,7 @@ void Client::internalHide()
         unmap();
     if (old == Kept)
         updateHiddenPreview();
-    addWorkspaceRepaint(visibleRect());
-    workspace()->clientHidden(this);
-    if (Compositor::isCreated()) {
-        Compositor::self()->checkUnredirect();
-    }
+    workspace()->clientMappingChanged(this, true);
 }
 
 void Client::internalKeep()
@@ -1295,11 +1293,7 @@ void Client::internalKeep()
     if (isActive())
         workspace()->focusToNull(); // get rid of input focus, bug #317484
     updateHiddenPreview();
-    addWorkspaceRepaint(visibleRect());
-    workspace()->clientHidden(this);
-    if (Compositor::isCreated()) {
-        Compositor::self()->checkUnredirect();
-    }
+    workspace()->clientMappingChanged(this, true);
 }
 
 /**
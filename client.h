@@ -719,7 +719,7 @@ private:
 
 protected:
     virtual void debug(QDebug& stream) const;
-    virtual bool shouldUnredirect() const;
+    virtual bool isUnredirectCandidate() const;
 
 private Q_SLOTS:
     void delayedSetShortcut();
@@ -818,6 +818,8 @@ private:
     void leaveMoveResize();
     void checkUnrestrictedMoveResize();
     void handleMoveResize(int x, int y, int x_root, int y_root);
+    void applyPendingMotion();
+    void startMoveResizeFrameTimer();
     void startDelayedMoveResize();
     void stopDelayedMoveResize();
     void positionGeometryTip();
@@ -907,6 +909,10 @@ private:
     xcb_window_t verifyTransientFor(xcb_window_t transient_for, bool set);
     void addTransient(Client* cl);
     void removeTransient(Client* cl);
+    /**
+     * Removes @p cl from the transients list without changing the transiency of @p cl.
+     **/
+    void removeFromTransientsList(Client* cl);
     void removeFromMainClients();
     void cleanGrouping();
     void checkGroupTransients();
@@ -1021,6 +1027,12 @@ private:
     QPoint input_offset;
 
     QTimer *m_focusOutTimer;
+    // pointer motion during move/resize is collapsed and applied at most once per frame
+    QTimer *m_moveResizeFrameTimer;
+    struct {
+        int x, y, xRoot, yRoot;
+        bool isPending;
+    } m_pendingMotion;
 
     QPalette m_palette;
     QList<QMetaObject::Connection> m_connections;
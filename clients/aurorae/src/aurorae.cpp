@@ -26,7 +26,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QDirIterator>
 #include <QFileInfo>
 #include <QMutex>
+#include <QOpenGLContext>
 #include <QOpenGLFramebufferObject>
+#include <QOpenGLFunctions>
 #include <QPainter>
 #include <QQmlComponent>
 #include <QQmlContext>
@@ -34,6 +36,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QQuickItem>
 #include <QQuickWindow>
 #include <QStandardPaths>
+#include <QVarLengthArray>
 #include <QWidget>
 
 #include <KConfig>
@@ -42,6 +45,16 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <KPluginInfo>
 #include <KServiceTypeTrader>
 
+#ifndef GL_PACK_ROW_LENGTH
+#define GL_PACK_ROW_LENGTH 0x0D02
+#endif
+#ifndef GL_BGRA
+#define GL_BGRA 0x80E1
+#endif
+#ifndef GL_UNSIGNED_INT_8_8_8_8_REV
+#define GL_UNSIGNED_INT_8_8_8_8_REV 0x8367
+#endif
+
 K_PLUGIN_FACTORY_WITH_JSON(AuroraePluginFactory,
                            "aurorae.json",
                            registerPlugin<Aurorae::AuroraeFactory>(QString(), &Aurorae::AuroraeFactory::createInstance);)
@@ -323,7 +336,7 @@ void AuroraeClient::init()
         });
         connect(m_view, &QQuickWindow::afterRendering, [this]{
             QMutexLocker locker(AuroraeFactory::instance()->mutex());
-            m_buffer = m_fbo->toImage();
+            readBack();
         });
         connect(m_view, &QQuickWindow::afterRendering, this,
                 static_cast<void (KDecoration::*)(void)>(&KDecoration::update), Qt::QueuedConnection);
@@ -619,6 +632,89 @@ void AuroraeClient::render(QPaintDevice *device, const QRegion &sourceRegion)
     painter.drawImage(QPoint(0, 0), m_buffer);
 }
 
+void AuroraeClient::readBack()
+{
+    if (m_fbo.isNull()) {
+        return;
+    }
+    QOpenGLContext *context = QOpenGLContext::currentContext();
+    if (!context) {
+        return;
+    }
+    const QSize size = m_fbo->size();
+    if (m_buffer.size() != size) {
+        m_buffer = QImage(size, QImage::Format_ARGB32_Premultiplied);
+        m_buffer.fill(Qt::transparent);
+    }
+    // Only the area around the client is used by the compositor. Reading back just the borders
+    // instead of the complete framebuffer avoids transferring the (mostly large) client area
+    // from the GPU after every frame.
+    int paddingLeft, paddingRight, paddingTop, paddingBottom;
+    paddingLeft = paddingRight = paddingTop = paddingBottom = 0;
+    padding(paddingLeft, paddingRight, paddingTop, paddingBottom);
+    int left, right, top, bottom;
+    left = right = top = bottom = 0;
+    borders(left, right, top, bottom);
+    const QRect clientRect = QRect(0, 0, width(), height())
+                                .adjusted(left, top, -right, -bottom)
+                                .translated(paddingLeft, paddingTop);
+    const QRegion area = QRegion(QRect(QPoint(0, 0), size)).subtract(clientRect);
+
+    const bool wasBound = m_fbo->isBound();
+    if (!wasBound) {
+        m_fbo->bind();
+    }
+    QOpenGLFunctions *gl = context->functions();
+    gl->glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    // Read in the layout of m_buffer, so that render() does not need to convert the image on every
+    // paint. OpenGL ES 2 only guarantees RGBA, those rects get swizzled once after reading.
+    const bool hasBgra = !context->isOpenGLES();
+    const GLenum format = hasBgra ? GL_BGRA : GL_RGBA;
+    const GLenum type = hasBgra ? GL_UNSIGNED_INT_8_8_8_8_REV : GL_UNSIGNED_BYTE;
+    // With a row length the rects are read into their place in m_buffer, OpenGL ES 2 lacks it
+    const bool hasRowLength = !context->isOpenGLES() || context->format().majorVersion() >= 3;
+    if (hasRowLength) {
+        gl->glPixelStorei(GL_PACK_ROW_LENGTH, m_buffer.bytesPerLine() / 4);
+    }
+    foreach (const QRect &r, area.rects()) {
+        const int y = size.height() - r.y() - r.height();
+        const int bytes = r.width() * 4;
+        if (hasRowLength) {
+            gl->glReadPixels(r.x(), y, r.width(), r.height(), format, type,
+                             m_buffer.scanLine(r.y()) + r.x() * 4);
+            // OpenGL stores the rows bottom up
+            QVarLengthArray<uchar, 1024> row(bytes);
+            for (int top = r.y(), bottom = r.y() + r.height() - 1; top < bottom; ++top, --bottom) {
+                uchar *topLine = m_buffer.scanLine(top) + r.x() * 4;
+                uchar *bottomLine = m_buffer.scanLine(bottom) + r.x() * 4;
+                memcpy(row.data(), topLine, bytes);
+                memcpy(topLine, bottomLine, bytes);
+                memcpy(bottomLine, row.constData(), bytes);
+            }
+        } else {
+            for (int i = 0; i < r.height(); ++i) {
+                gl->glReadPixels(r.x(), y + i, r.width(), 1, format, type,
+                                 m_buffer.scanLine(r.y() + r.height() - 1 - i) + r.x() * 4);
+            }
+        }
+        if (!hasBgra) {
+            for (int i = r.y(); i < r.y() + r.height(); ++i) {
+                uchar *rgba = m_buffer.scanLine(i) + r.x() * 4;
+                QRgb *pixels = reinterpret_cast<QRgb*>(rgba);
+                for (int j = 0; j < r.width(); ++j, rgba += 4) {
+                    pixels[j] = qRgba(rgba[0], rgba[1], rgba[2], rgba[3]);
+                }
+            }
+        }
+    }
+    if (hasRowLength) {
+        gl->glPixelStorei(GL_PACK_ROW_LENGTH, 0);
+    }
+    if (!wasBound) {
+        m_fbo->release();
+    }
+}
+
 void AuroraeClient::setupBorders()
 {
     if (!m_item) {
@@ -169,6 +169,11 @@ private Q_SLOTS:
 private:
     void sizesFromBorders(const KWin::Borders *borders, int &left, int &right, int &top, int &bottom) const;
     void setupBorders();
+    /**
+     * Copies the decoration area of the framebuffer object into m_buffer.
+     * Has to be called from the render thread with the context current.
+     **/
+    void readBack();
     QQuickWindow *m_view;
     QQuickItem *m_item;
     QScopedPointer<QOpenGLFramebufferObject> m_fbo;
@@ -32,7 +32,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "scene_xrender.h"
 #include "scene_opengl.h"
 #include "scene_qpainter.h"
+#include "screens.h"
 #include "shadow.h"
+#include "timingstatistics.h"
 #include "useractions.h"
 #include "compositingprefs.h"
 #include "xcbutils.h"
@@ -47,6 +49,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QMenu>
 #include <QTimerEvent>
 #include <QDateTime>
+#include <QElapsedTimer>
 #include <KGlobalAccel>
 #include <KLocalizedString>
 #include <KNotification>
@@ -83,8 +86,13 @@ Compositor::Compositor(QObject* workspace)
     , cm_selection(NULL)
     , vBlankInterval(0)
     , fpsInterval(0)
+    , m_outputFpsInterval(0)
     , m_xrrRefreshRate(0)
     , forceUnredirectCheck(false)
+    , m_unredirectSweep(false)
+    , m_unredirectEvaluations(0)
+    , m_unredirectCount(0)
+    , m_redirectCount(0)
     , m_finishing(false)
     , m_timeSinceLastVBlank(0)
     , m_scene(NULL)
@@ -94,8 +102,11 @@ Compositor::Compositor(QObject* workspace)
     connect(&unredirectTimer, SIGNAL(timeout()), SLOT(delayedCheckUnredirect()));
     connect(&compositeResetTimer, SIGNAL(timeout()), SLOT(restart()));
     connect(workspace, SIGNAL(configChanged()), SLOT(slotConfigChanged()));
-    connect(options, SIGNAL(unredirectFullscreenChanged()), SLOT(delayedCheckUnredirect()));
+    connect(options, SIGNAL(unredirectFullscreenChanged()), SLOT(unredirectFullscreenChanged()));
+    connect(screens(), SIGNAL(changed()), SLOT(updateOutputs()));
+    connect(screens(), SIGNAL(refreshRatesChanged()), SLOT(updateOutputs()));
     unredirectTimer.setSingleShot(true);
+    m_unredirectClock.start();
     compositeResetTimer.setSingleShot(true);
     nextPaintReference.invalidate(); // Initialize the timer
 
@@ -270,6 +281,8 @@ void Compositor::slotCompositingOptionsInitialized()
     } else
         vBlankInterval = milliToNano(1); // no sync - DO NOT set "0", would cause div-by-zero segfaults.
     m_timeSinceLastVBlank = fpsInterval - (options->vBlankTime() + 1); // means "start now" - we don't have even a slight idea when the first vsync will occur
+    m_outputFpsInterval = fpsInterval;
+    updateOutputs();
     scheduleRepaint();
     xcb_composite_redirect_subwindows(connection(), rootWindow(), XCB_COMPOSITE_REDIRECT_MANUAL);
     new EffectsHandlerImpl(this, m_scene);   // sets also the 'effects' pointer
@@ -325,6 +338,10 @@ void Compositor::finish()
     c->finishCompositing();
     foreach (Deleted * c, Workspace::self()->deletedList())
     c->finishCompositing();
+    m_unredirectDirty.clear();
+    m_unredirectCandidates.clear();
+    m_unredirectedWindows.clear();
+    m_unredirectEligible.clear();
     xcb_composite_unredirect_subwindows(connection(), rootWindow(), XCB_COMPOSITE_REDIRECT_MANUAL);
     delete effects;
     effects = NULL;
@@ -574,6 +591,8 @@ void Compositor::performCompositing()
         m_waitingForFrameRendered = true;
         return; // frame wouldn't make it on the screen
     }
+    QElapsedTimer compositingTimer;
+    compositingTimer.start();
 
     // Create a list of all windows in the stacking order
     ToplevelList windows = Workspace::self()->xStackingOrder();
@@ -600,9 +619,8 @@ void Compositor::performCompositing()
     foreach (Toplevel *win, damaged) {
         // Discard the cached lanczos texture
         if (win->effectWindow()) {
-            const QVariant texture = win->effectWindow()->data(LanczosCacheRole);
-            if (texture.isValid()) {
-                delete static_cast<GLTexture *>(texture.value<void*>());
+            if (GLTexture *texture = static_cast<GLTexture *>(win->effectWindow()->dataPointer(LanczosCacheRole))) {
+                delete texture;
                 win->effectWindow()->setData(LanczosCacheRole, QVariant());
             }
         }
@@ -613,6 +631,7 @@ void Compositor::performCompositing()
     if (repaints_region.isEmpty() && !windowRepaintsPending()) {
         m_scene->idle();
         m_timeSinceLastVBlank = fpsInterval - (options->vBlankTime() + 1); // means "start now"
+        m_outputFpsInterval = fpsInterval;
         // Note: It would seem here we should undo suspended unredirect, but when scenes need
         // it for some reason, e.g. transformations or translucency, the next pass that does not
         // need this anymore and paints normally will also reset the suspended unredirect.
@@ -629,11 +648,28 @@ void Compositor::performCompositing()
         if (!t->readyForPainting())
             windows.removeAll(t);
 
+    if (m_outputRepaints.count() > 1) {
+        // collecting the repaints of all windows is not for free, so it is done once per frame
+        // and the outputs damaged now also pace the next frame
+        const QRegion damage = pendingRepaints();
+        m_outputRepaints.addFrame(damage);
+        m_outputFpsInterval = outputFpsInterval(damage);
+    } else {
+        m_outputFpsInterval = fpsInterval;
+    }
+
     QRegion repaints = repaints_region;
     // clear all repaints, so that post-pass can add repaints for the next repaint
     repaints_region = QRegion();
 
+    const qint64 paintStart = compositingTimer.nsecsElapsed();
+    const qint64 presentStart = TimingStatistics::total(TimingStatistics::Present);
     m_timeSinceLastVBlank = m_scene->paint(repaints, windows);
+    const qint64 paintEnd = compositingTimer.nsecsElapsed();
+    // a swap blocking for the retrace is not part of painting
+    const qint64 presentTime = TimingStatistics::total(TimingStatistics::Present) - presentStart;
+    TimingStatistics::addSample(TimingStatistics::ScenePaint, paintEnd - paintStart - presentTime);
+    TimingStatistics::addSample(TimingStatistics::Compositing, paintEnd);
 
     compositeTimer.stop(); // stop here to ensure *we* cause the next repaint schedule - not some effect through m_scene->paint()
 
@@ -661,6 +697,47 @@ bool Compositor::windowRepaintsPending() const
     return false;
 }
 
+QRegion Compositor::pendingRepaints() const
+{
+    QRegion repaints = repaints_region;
+    foreach (Toplevel * c, Workspace::self()->clientList())
+        repaints |= c->repaints();
+    foreach (Toplevel * c, Workspace::self()->desktopList())
+        repaints |= c->repaints();
+    foreach (Toplevel * c, Workspace::self()->unmanagedList())
+        repaints |= c->repaints();
+    foreach (Toplevel * c, Workspace::self()->deletedList())
+        repaints |= c->repaints();
+    return repaints;
+}
+
+void Compositor::updateOutputs()
+{
+    QVector<QRect> geometries;
+    QVector<int> refreshRates;
+    for (int i = 0; i < screens()->count(); ++i) {
+        geometries << screens()->geometry(i);
+        refreshRates << screens()->refreshRate(i);
+    }
+    m_outputRepaints.setOutputs(geometries, refreshRates);
+}
+
+qint64 Compositor::outputFpsInterval(const QRegion &damage) const
+{
+    // All outputs are presented with the same swap, but if only slower outputs are damaged
+    // there is no point in producing frames faster than they can show them.
+    qint64 interval = m_outputRepaints.frameInterval(damage);
+    if (interval <= fpsInterval) {
+        return fpsInterval;
+    }
+    if (m_scene->syncsToVBlank()) {
+        // the swap waits for the vblank of one output, stay on its ticks without going below
+        // the rate of the damaged outputs
+        interval = (interval / vBlankInterval) * vBlankInterval;
+    }
+    return qMax(interval, fpsInterval);
+}
+
 void Compositor::setCompositeResetTimer(int msecs)
 {
     compositeResetTimer.start(msecs);
@@ -672,6 +749,7 @@ void Compositor::setCompositeTimer()
         return;
 
     uint waitTime = 1;
+    const qint64 interval = m_outputFpsInterval;
 
     if (m_scene->blocksForRetrace()) {
 
@@ -682,11 +760,11 @@ void Compositor::setCompositeTimer()
         // while another ooold 15" TFT requires about 6ms
 
         qint64 padding = m_timeSinceLastVBlank;
-        if (padding > fpsInterval) {
+        if (padding > interval) {
             // we're at low repaints or spent more time in painting than the user wanted to wait for that frame
             padding = vBlankInterval - (padding%vBlankInterval); // -> align to next vblank
         } else {  // -> align to the next maxFps tick
-            padding = ((vBlankInterval - padding%vBlankInterval) + (fpsInterval/vBlankInterval-1)*vBlankInterval);
+            padding = ((vBlankInterval - padding%vBlankInterval) + (interval/vBlankInterval-1)*vBlankInterval);
             //               "remaining time of the first vsync" + "time for the other vsyncs of the frame"
         }
 
@@ -697,12 +775,12 @@ void Compositor::setCompositeTimer()
         }
     }
     else { // w/o blocking vsync we just jump to the next demanded tick
-        if (fpsInterval > m_timeSinceLastVBlank) {
-            waitTime = nanoToMilli(fpsInterval - m_timeSinceLastVBlank);
+        if (interval > m_timeSinceLastVBlank) {
+            waitTime = nanoToMilli(interval - m_timeSinceLastVBlank);
             if (!waitTime) {
                 waitTime = 1; // will ensure we don't block out the eventloop - the system's just not faster ...
             }
-        }/* else if (m_scene->syncsToVBlank() && m_timeSinceLastVBlank - fpsInterval < (vBlankInterval<<1)) {
+        }/* else if (m_scene->syncsToVBlank() && m_timeSinceLastVBlank - interval < (vBlankInterval<<1)) {
             // NOTICE - "for later" ------------------------------------------------------------------
             // It can happen that we push two frames within one refresh cycle.
             // Swapping will then block even with triple buffering when the GPU does not discard but
@@ -714,7 +792,7 @@ void Compositor::setCompositeTimer()
             // free
             // NOTICE: obviously m_timeSinceLastVBlank can be too big because we're too slow as well
             // So if this code was enabled, we'd needlessly half the framerate once more (15 instead of 30)
-            waitTime = nanoToMilli(vBlankInterval - (m_timeSinceLastVBlank - fpsInterval)%vBlankInterval) + 2;
+            waitTime = nanoToMilli(vBlankInterval - (m_timeSinceLastVBlank - interval)%vBlankInterval) + 2;
         }*/ else {
             waitTime = 1; // ... "0" would be sufficient, but the compositor isn't the WMs only task
         }
@@ -727,50 +805,149 @@ bool Compositor::isActive()
     return !m_finishing && hasScene();
 }
 
+bool Compositor::hasUnredirectOverlay() const
+{
+    return hasScene() && m_scene->overlayWindow() && m_scene->overlayWindow()->window() != None;
+}
+
 void Compositor::checkUnredirect()
 {
     checkUnredirect(false);
 }
 
-// force is needed when the list of windows changes (e.g. a window goes away)
+// force is needed when the conditions change for all windows (e.g. the screen size changes)
 void Compositor::checkUnredirect(bool force)
 {
-    if (!hasScene() || !m_scene->overlayWindow() || m_scene->overlayWindow()->window() == None || !options->isUnredirectFullscreen())
+    if (!hasUnredirectOverlay() || !options->isUnredirectFullscreen())
         return;
-    if (force)
+    if (force) {
+        forceUnredirectCheck = true;
+        m_unredirectSweep = true;
+    }
+    unredirectTimer.start(0);
+}
+
+void Compositor::checkUnredirect(Toplevel *window)
+{
+    if (!hasUnredirectOverlay() || !options->isUnredirectFullscreen())
+        return;
+    m_unredirectDirty.insert(window);
+    unredirectTimer.start(0);
+}
+
+void Compositor::checkSenderUnredirect()
+{
+    if (Toplevel *window = qobject_cast<Toplevel*>(sender())) {
+        checkUnredirect(window);
+    }
+}
+
+void Compositor::removeFromUnredirectCheck(Toplevel *window)
+{
+    m_unredirectDirty.remove(window);
+    m_unredirectCandidates.remove(window);
+    m_unredirectEligible.remove(window);
+    if (m_unredirectedWindows.remove(window) && hasUnredirectOverlay()) {
+        // the overlay window has to cover the area again
         forceUnredirectCheck = true;
-    if (!unredirectTimer.isActive())
         unredirectTimer.start(0);
+    }
+}
+
+void Compositor::unredirectFullscreenChanged()
+{
+    // windows have not been tracked while unredirection was disabled
+    m_unredirectSweep = true;
+    delayedCheckUnredirect();
 }
 
 void Compositor::delayedCheckUnredirect()
 {
-    if (!hasScene() || !m_scene->overlayWindow() || m_scene->overlayWindow()->window() == None || !(options->isUnredirectFullscreen() || sender() == options))
+    if (!hasUnredirectOverlay())
         return;
-    ToplevelList list;
+    if (!options->isUnredirectFullscreen() && m_unredirectedWindows.isEmpty()) {
+        m_unredirectDirty.clear();
+        return;
+    }
+    TimingStatistics::Measurement measurement(TimingStatistics::UnredirectCheck);
+    QSet<Toplevel*> windows = m_unredirectDirty;
+    m_unredirectDirty.clear();
+    if (m_unredirectSweep) {
+        m_unredirectSweep = false;
+        foreach (Client * c, Workspace::self()->clientList())
+        windows.insert(c);
+        foreach (Unmanaged * c, Workspace::self()->unmanagedList())
+        windows.insert(c);
+    }
+    // stacking changes and global conditions only matter for these windows
+    windows.unite(m_unredirectCandidates);
+    windows.unite(m_unredirectedWindows);
+
     bool changed = forceUnredirectCheck;
-    foreach (Client * c, Workspace::self()->clientList())
-    list.append(c);
-    foreach (Unmanaged * c, Workspace::self()->unmanagedList())
-    list.append(c);
-    foreach (Toplevel * c, list) {
-        if (c->updateUnredirectedState())
-            changed = true;
+    qint64 nextCheck = -1;
+    foreach (Toplevel * c, windows) {
+        ++m_unredirectEvaluations;
+        if (c->isUnredirectCandidate())
+            m_unredirectCandidates.insert(c);
+        else
+            m_unredirectCandidates.remove(c);
+        const bool should = c->canUnredirect();
+        if (should == c->unredirected()) {
+            m_unredirectEligible.remove(c);
+            continue;
+        }
+        if (should) {
+            // Only unredirect after the window stayed eligible for a moment, so that e.g. a
+            // short notification on top of a video does not make it flip back and forth.
+            // Redirecting has to happen immediately.
+            const qint64 now = m_unredirectClock.elapsed();
+            QHash<Toplevel*, qint64>::iterator it = m_unredirectEligible.find(c);
+            if (it == m_unredirectEligible.end())
+                it = m_unredirectEligible.insert(c, now);
+            const qint64 remaining = s_unredirectDelay - (now - it.value());
+            if (remaining > 0) {
+                nextCheck = nextCheck < 0 ? remaining : qMin(nextCheck, remaining);
+                continue;
+            }
+            m_unredirectEligible.erase(it);
+            m_unredirectedWindows.insert(c);
+            ++m_unredirectCount;
+        } else {
+            m_unredirectedWindows.remove(c);
+            ++m_redirectCount;
+        }
+        c->setUnredirected(should);
+        changed = true;
     }
-    // no desktops, no Deleted ones
+    if (nextCheck >= 0)
+        unredirectTimer.start(nextCheck);
     if (!changed)
         return;
     forceUnredirectCheck = false;
     // Cut out parts from the overlay window where unredirected windows are,
     // so that they are actually visible.
     QRegion reg(0, 0, displayWidth(), displayHeight());
-    foreach (Toplevel * c, list) {
-        if (c->unredirected())
-            reg -= c->geometry();
-    }
+    foreach (Toplevel * c, m_unredirectedWindows)
+        reg -= c->geometry();
     m_scene->overlayWindow()->setShape(reg);
 }
 
+QString Compositor::unredirectSupportInformation() const
+{
+    return QStringLiteral("Unredirected windows: %1 (%2 candidates)\n"
+                          "Unredirect checks evaluated %3 windows, unredirected %4 times, redirected %5 times\n")
+        .arg(m_unredirectedWindows.count())
+        .arg(m_unredirectCandidates.count())
+        .arg(m_unredirectEvaluations)
+        .arg(m_unredirectCount)
+        .arg(m_redirectCount);
+}
+
+QString Compositor::outputSupportInformation() const
+{
+    return m_outputRepaints.supportInformation();
+}
+
 bool Compositor::checkForOverlayWindow(WId w) const
 {
     if (!hasScene()) {
@@ -842,7 +1019,7 @@ bool Toplevel::setupCompositing()
     effect_window = new EffectWindowImpl(this);
     unredirect = false;
 
-    Compositor::self()->checkUnredirect(true);
+    Compositor::self()->checkUnredirect(this);
     Compositor::self()->scene()->windowAdded(this);
 
     // With unmanaged windows there is a race condition between the client painting the window
@@ -859,7 +1036,7 @@ void Toplevel::finishCompositing(ReleaseReason releaseReason)
 {
     if (damage_handle == XCB_NONE)
         return;
-    Compositor::self()->checkUnredirect(true);
+    Compositor::self()->removeFromUnredirectCheck(this);
     if (effect_window->window() == this) { // otherwise it's already passed to Deleted, don't free data
         discardWindowPixmap();
         delete effect_window;
@@ -1061,22 +1238,35 @@ void Toplevel::addWorkspaceRepaint(const QRect& r2)
     Compositor::self()->addRepaint(r2);
 }
 
-bool Toplevel::updateUnredirectedState()
+bool Toplevel::canUnredirect() const
 {
     assert(compositing());
-    bool should = options->isUnredirectFullscreen() && shouldUnredirect() && !unredirectSuspend &&
-                  !shape() && !hasAlpha() && opacity() == 1.0 &&
-                  !static_cast<EffectsHandlerImpl*>(effects)->activeFullScreenEffect();
-    if (should == unredirect)
-        return false;
-    static QElapsedTimer lastUnredirect;
-    static const qint64 msecRedirectInterval = 100;
-    if (!lastUnredirect.hasExpired(msecRedirectInterval)) {
-        QTimer::singleShot(msecRedirectInterval, Compositor::self(), SLOT(checkUnredirect()));
-        return false;
+    return options->isUnredirectFullscreen() && !unredirectSuspend &&
+           !shape() && !hasAlpha() && opacity() == 1.0 &&
+           !static_cast<EffectsHandlerImpl*>(effects)->activeFullScreenEffect() &&
+           isUnredirectCandidate() && !isCovered();
+}
+
+bool Toplevel::isCovered() const
+{
+    ToplevelList stacking = workspace()->xStackingOrder();
+    for (int pos = stacking.count() - 1;
+            pos >= 0;
+            --pos) {
+        Toplevel* c = stacking.at(pos);
+        if (c == this)   // is not covered by any other window, ok to unredirect
+            return false;
+        if (c->geometry().intersects(geometry()))
+            return true;
     }
-    lastUnredirect.start();
-    unredirect = should;
+    abort();
+}
+
+void Toplevel::setUnredirected(bool set)
+{
+    if (unredirect == set)
+        return;
+    unredirect = set;
     if (unredirect) {
         qDebug() << "Unredirecting:" << this;
         xcb_composite_unredirect_window(connection(), frameId(), XCB_COMPOSITE_REDIRECT_MANUAL);
@@ -1085,7 +1275,6 @@ bool Toplevel::updateUnredirectedState()
         xcb_composite_redirect_window(connection(), frameId(), XCB_COMPOSITE_REDIRECT_MANUAL);
         discardWindowPixmap();
     }
-    return true;
 }
 
 void Toplevel::suspendUnredirect(bool suspend)
@@ -1093,7 +1282,7 @@ void Toplevel::suspendUnredirect(bool suspend)
     if (unredirectSuspend == suspend)
         return;
     unredirectSuspend = suspend;
-    Compositor::self()->checkUnredirect();
+    Compositor::self()->checkUnredirect(this);
 }
 
 //****************************************
@@ -1125,22 +1314,9 @@ void Client::finishCompositing(ReleaseReason releaseReason)
     s_haveResizeEffect = false;
 }
 
-bool Client::shouldUnredirect() const
+bool Client::isUnredirectCandidate() const
 {
-    if (isActiveFullScreen()) {
-        ToplevelList stacking = workspace()->xStackingOrder();
-        for (int pos = stacking.count() - 1;
-                pos >= 0;
-                --pos) {
-            Toplevel* c = stacking.at(pos);
-            if (c == this)   // is not covered by any other window, ok to unredirect
-                return true;
-            if (c->geometry().intersects(geometry()))
-                return false;
-        }
-        abort();
-    }
-    return false;
+    return isActiveFullScreen();
 }
 
 
@@ -1148,7 +1324,7 @@ bool Client::shouldUnredirect() const
 // Unmanaged
 //****************************************
 
-bool Unmanaged::shouldUnredirect() const
+bool Unmanaged::isUnredirectCandidate() const
 {
     // the pixmap is needed for the login effect, a nicer solution would be the login effect increasing
     // refcount for the window pixmap (which would prevent unredirect), avoiding this hack
@@ -1159,28 +1335,15 @@ bool Unmanaged::shouldUnredirect() const
         return false;
 // it must cover whole display or one xinerama screen, and be the topmost there
     const int desktop = VirtualDesktopManager::self()->current();
-    if (geometry() == workspace()->clientArea(FullArea, geometry().center(), desktop)
-            || geometry() == workspace()->clientArea(ScreenArea, geometry().center(), desktop)) {
-        ToplevelList stacking = workspace()->xStackingOrder();
-        for (int pos = stacking.count() - 1;
-                pos >= 0;
-                --pos) {
-            Toplevel* c = stacking.at(pos);
-            if (c == this)   // is not covered by any other window, ok to unredirect
-                return true;
-            if (c->geometry().intersects(geometry()))
-                return false;
-        }
-        abort();
-    }
-    return false;
+    return geometry() == workspace()->clientArea(FullArea, geometry().center(), desktop)
+            || geometry() == workspace()->clientArea(ScreenArea, geometry().center(), desktop);
 }
 
 //****************************************
 // Deleted
 //****************************************
 
-bool Deleted::shouldUnredirect() const
+bool Deleted::isUnredirectCandidate() const
 {
     return false;
 }
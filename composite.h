@@ -23,6 +23,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define KWIN_COMPOSITE_H
 // KWin
 #include <kwinglobals.h>
+#include "outputrepaintscheduler.h"
 // KDE
 #include <KSelectionOwner>
 // Qt
@@ -30,12 +31,15 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QElapsedTimer>
 #include <QTimer>
 #include <QBasicTimer>
+#include <QHash>
 #include <QRegion>
+#include <QSet>
 
 namespace KWin {
 
 class Client;
 class Scene;
+class Toplevel;
 
 class CompositorSelectionOwner : public KSelectionOwner
 {
@@ -68,6 +72,12 @@ public:
     int xrrRefreshRate() const {
         return m_xrrRefreshRate;
     }
+    /**
+     * @returns The time in milliseconds between two composited frames.
+     **/
+    int frameInterval() const {
+        return qMax<qint64>(1, fpsInterval / (1000 * 1000));
+    }
     void setCompositeResetTimer(int msecs);
 
     bool hasScene() const {
@@ -78,6 +88,18 @@ public:
      * Checks whether @p w is the Scene's overlay window.
      **/
     bool checkForOverlayWindow(WId w) const;
+    /**
+     * Stops tracking @p window for unredirection, to be called when it is no longer composited.
+     **/
+    void removeFromUnredirectCheck(Toplevel *window);
+    /**
+     * @returns Statistics about the unredirection of fullscreen windows for the support information.
+     **/
+    QString unredirectSupportInformation() const;
+    /**
+     * @returns Statistics about the damage per output for the support information.
+     **/
+    QString outputSupportInformation() const;
     /**
      * @returns The Scene's Overlay X Window.
      **/
@@ -175,6 +197,15 @@ public Q_SLOTS:
     void scheduleRepaint();
     void checkUnredirect();
     void checkUnredirect(bool force);
+    /**
+     * Schedules checking whether @p window can be unredirected. Only the windows passed
+     * here and the ones which are or could be unredirected are checked.
+     **/
+    void checkUnredirect(KWin::Toplevel *window);
+    /**
+     * Schedules the check for the window emitting the signal.
+     **/
+    void checkSenderUnredirect();
     void updateCompositeBlocking();
     void updateCompositeBlocking(KWin::Client* c);
 
@@ -199,13 +230,25 @@ private Q_SLOTS:
     void fallbackToXRenderCompositing();
     void performCompositing();
     void delayedCheckUnredirect();
+    void unredirectFullscreenChanged();
     void slotConfigChanged();
     void releaseCompositorSelection();
     void deleteUnusedSupportProperties();
+    void updateOutputs();
 
 private:
     void setCompositeTimer();
     bool windowRepaintsPending() const;
+    /**
+     * @returns The repaints of the compositor and all windows in screen coordinates.
+     **/
+    QRegion pendingRepaints() const;
+    /**
+     * @returns The time in nanoseconds to wait between two frames, taking into account the
+     * refresh rates of the outputs touched by @p damage.
+     **/
+    qint64 outputFpsInterval(const QRegion &damage) const;
+    bool hasUnredirectOverlay() const;
 
     /**
      * Whether the Compositor is currently suspended, 8 bits encoding the reason
@@ -218,12 +261,26 @@ private:
     QList<xcb_atom_t> m_unusedSupportProperties;
     QTimer m_unusedSupportPropertyTimer;
     qint64 vBlankInterval, fpsInterval;
+    // frame interval for the outputs damaged in the last frame
+    qint64 m_outputFpsInterval;
     int m_xrrRefreshRate;
+    OutputRepaintScheduler m_outputRepaints;
     QElapsedTimer nextPaintReference;
     QRegion repaints_region;
 
     QTimer unredirectTimer;
     bool forceUnredirectCheck;
+    bool m_unredirectSweep; // check all windows instead of the tracked ones
+    QSet<Toplevel*> m_unredirectDirty;
+    QSet<Toplevel*> m_unredirectCandidates;
+    QSet<Toplevel*> m_unredirectedWindows;
+    QHash<Toplevel*, qint64> m_unredirectEligible; // time since when a window can be unredirected
+    QElapsedTimer m_unredirectClock;
+    quint64 m_unredirectEvaluations;
+    quint64 m_unredirectCount;
+    quint64 m_redirectCount;
+    // how long a window has to stay eligible before it gets unredirected
+    static const qint64 s_unredirectDelay = 100;
     QTimer compositeResetTimer; // for compressing composite resets
     bool m_finishing; // finish() sets this variable while shutting down
     bool m_starting; // start() sets this variable while starting
@@ -26,9 +26,11 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "composite.h"
 #include "compositingprefs.h"
 #include "main.h"
+#include "partialupdateengine.h"
 #include "placement.h"
 #include "kwinadaptor.h"
 #include "scene.h"
+#include "timingstatistics.h"
 #include "workspace.h"
 #include "virtualdesktops.h"
 #ifdef KWIN_BUILD_ACTIVITIES
@@ -83,6 +85,11 @@ WRAP(reconfigure)
 
 #undef WRAP
 
+void DBusInterface::resetTimingStatistics()
+{
+    TimingStatistics::reset();
+}
+
 void DBusInterface::killWindow()
 {
     Workspace::self()->slotKillWindow();
@@ -213,6 +220,34 @@ void CompositorDBusInterface::suspend()
     m_compositor->suspend(Compositor::ScriptSuspend);
 }
 
+double CompositorDBusInterface::lastFrameRepaintRatio() const
+{
+    if (!m_compositor->hasScene() || !m_compositor->scene()->partialUpdate()) {
+        return 0.0;
+    }
+    return m_compositor->scene()->partialUpdate()->lastRepaintRatio();
+}
+
+double CompositorDBusInterface::averageRepaintRatio() const
+{
+    if (!m_compositor->hasScene() || !m_compositor->scene()->partialUpdate()) {
+        return 0.0;
+    }
+    return m_compositor->scene()->partialUpdate()->averageRepaintRatio();
+}
+
+QString CompositorDBusInterface::presentStrategy() const
+{
+    if (!m_compositor->hasScene() || !m_compositor->scene()->partialUpdate()) {
+        return QString();
+    }
+    const PartialUpdateEngine *partialUpdate = m_compositor->scene()->partialUpdate();
+    if (partialUpdate->frameCount() == 0) {
+        return QString();
+    }
+    return PartialUpdateEngine::strategyToString(partialUpdate->lastStrategy());
+}
+
 QStringList CompositorDBusInterface::supportedOpenGLPlatformInterfaces() const
 {
     QStringList interfaces;
@@ -59,6 +59,11 @@ public Q_SLOTS: // METHODS
     void nextDesktop();
     void previousDesktop();
     Q_NOREPLY void reconfigure();
+    /**
+     * Resets the statistics about the duration of compositing and window management,
+     * which are part of the support information.
+     **/
+    void resetTimingStatistics();
     bool setCurrentDesktop(int desktop);
     bool startActivity(const QString &in0);
     bool stopActivity(const QString &in0);
@@ -110,6 +115,27 @@ class CompositorDBusInterface : public QObject
      * Values depend on operation mode and compile time options.
      **/
     Q_PROPERTY(QStringList supportedOpenGLPlatformInterfaces READ supportedOpenGLPlatformInterfaces)
+    /**
+     * @brief Fraction of the screen which got repainted in the last frame.
+     *
+     * Is @c 0 if the Scene does not track the repainted area.
+     **/
+    Q_PROPERTY(double lastFrameRepaintRatio READ lastFrameRepaintRatio)
+    /**
+     * @brief Fraction of the screen which got repainted per frame, averaged over all frames.
+     *
+     * Is @c 0 if the Scene does not track the repainted area.
+     **/
+    Q_PROPERTY(double averageRepaintRatio READ averageRepaintRatio)
+    /**
+     * The way the last frame got to the screen:
+     * @li @c buffer age
+     * @li @c copy sub buffer
+     * @li @c full swap
+     *
+     * Empty if the Scene does not track it.
+     **/
+    Q_PROPERTY(QString presentStrategy READ presentStrategy)
 public:
     explicit CompositorDBusInterface(Compositor *parent);
     virtual ~CompositorDBusInterface() = default;
@@ -120,6 +146,9 @@ public:
     bool isOpenGLBroken() const;
     QString compositingType() const;
     QStringList supportedOpenGLPlatformInterfaces() const;
+    double lastFrameRepaintRatio() const;
+    double averageRepaintRatio() const;
+    QString presentStrategy() const;
 
 public Q_SLOTS:
     /**
@@ -72,7 +72,7 @@ public:
     }
 protected:
     virtual void debug(QDebug& stream) const;
-    virtual bool shouldUnredirect() const;
+    virtual bool isUnredirectCandidate() const;
 private Q_SLOTS:
     void mainClientClosed(KWin::Toplevel *client);
 private:
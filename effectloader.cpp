@@ -22,6 +22,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 // KWin
 #include <config-kwin.h>
 #include <kwineffects.h>
+#include "effects/activationstub.h"
 #include "effects/effect_builtins.h"
 #include "scripting/scriptedeffect.h"
 // KDE
@@ -30,9 +31,11 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <KServiceTypeTrader>
 // Qt
 #include <QtConcurrentRun>
+#include <QAction>
 #include <QDebug>
 #include <QFutureWatcher>
 #include <QMap>
+#include <QPointer>
 #include <QStringList>
 
 namespace KWin
@@ -72,6 +75,11 @@ LoadEffectFlags AbstractEffectLoader::readConfig(const QString &effectName, bool
     return LoadEffectFlags();
 }
 
+KSharedConfig::Ptr AbstractEffectLoader::config() const
+{
+    return m_config;
+}
+
 BuiltInEffectLoader::BuiltInEffectLoader(QObject *parent)
     : AbstractEffectLoader(parent)
     , m_queue(new EffectLoadQueue<BuiltInEffectLoader, BuiltInEffect>(this))
@@ -113,7 +121,7 @@ void BuiltInEffectLoader::queryAndLoadAll()
         const QString key = BuiltInEffects::nameForEffect(effect);
         const LoadEffectFlags flags = readConfig(key, BuiltInEffects::enabledByDefault(effect));
         if (flags.testFlag(LoadEffectFlag::Load)) {
-            m_queue->enqueue(qMakePair(effect, flags));
+            m_queue->enqueue(qMakePair(effect, flags | LoadEffectFlag::CreateOnActivation));
         }
     }
 }
@@ -154,7 +162,24 @@ bool BuiltInEffectLoader::loadEffect(const QString &name, BuiltInEffect effect,
     }
 
     // ok, now we can try to create the Effect
-    Effect *e = BuiltInEffects::create(effect);
+    Effect *e = nullptr;
+    if (flags.testFlag(LoadEffectFlag::CreateOnActivation)) {
+        if (ActivationStub *stub = ActivationStub::create(effect, config())) {
+            QPointer<ActivationStub> guard(stub);
+            connect(stub, &ActivationStub::activated, this,
+                [this, guard]() {
+                    // a second trigger might have replaced the stub already
+                    if (guard) {
+                        replaceStub(guard.data());
+                    }
+                }, Qt::QueuedConnection
+            );
+            e = stub;
+        }
+    }
+    if (!e) {
+        e = BuiltInEffects::create(effect);
+    }
     if (!e) {
         qDebug() << "Failed to create effect: " << name;
         return false;
@@ -171,6 +196,27 @@ bool BuiltInEffectLoader::loadEffect(const QString &name, BuiltInEffect effect,
     return true;
 }
 
+void BuiltInEffectLoader::replaceStub(ActivationStub *stub)
+{
+    const BuiltInEffect effect = stub->effect();
+    const QString shortcut = stub->triggeredShortcut();
+    const ElectricBorder border = stub->triggeredBorder();
+    // unloads the stub and loads the real Effect through loadEffect(const QString&)
+    effects->reloadEffect(stub);
+    Effect *e = m_loadedEffects.value(effect);
+    if (!e || qobject_cast<ActivationStub*>(e)) {
+        return;
+    }
+    // the real Effect registered the same triggers, pass on the one which activated the stub
+    if (!shortcut.isEmpty()) {
+        if (QAction *action = e->findChild<QAction*>(shortcut)) {
+            action->trigger();
+        }
+    } else if (border != ElectricNone) {
+        e->borderActivated(border);
+    }
+}
+
 QString BuiltInEffectLoader::internalName(const QString& name) const
 {
     return name.toLower();
@@ -33,6 +33,7 @@ class KPluginInfo;
 
 namespace KWin
 {
+class ActivationStub;
 class Effect;
 class EffectPluginFactory;
 enum class BuiltInEffect;
@@ -47,7 +48,8 @@ enum class BuiltInEffect;
  */
 enum class LoadEffectFlag {
     Load = 1 << 0, ///< Effect should be loaded
-    CheckDefaultFunction = 1 << 2 ///< The Check Default Function needs to be invoked if the Effect provides it
+    CheckDefaultFunction = 1 << 2, ///< The Check Default Function needs to be invoked if the Effect provides it
+    CreateOnActivation = 1 << 3 ///< The Effect may be created the first time it gets activated
 };
 Q_DECLARE_FLAGS(LoadEffectFlags, LoadEffectFlag);
 
@@ -189,6 +191,7 @@ protected:
      * @returns Flags indicating whether the Effect should be loaded and how it should be loaded
      */
     LoadEffectFlags readConfig(const QString &effectName, bool defaultValue) const;
+    KSharedConfig::Ptr config() const;
 
 private:
     KSharedConfig::Ptr m_config;
@@ -264,6 +267,9 @@ private:
 /**
  * @brief Can load the Built-In-Effects
  *
+ * When loading all effects, an Effect which only reacts to its global shortcuts and screen
+ * edges is represented by an ActivationStub. The stub gets replaced by the real Effect the
+ * first time one of these triggers fires.
  */
 class BuiltInEffectLoader : public AbstractEffectLoader
 {
@@ -282,6 +288,7 @@ public:
 
 private:
     bool loadEffect(const QString &name, BuiltInEffect effect, LoadEffectFlags flags);
+    void replaceStub(ActivationStub *stub);
     QString internalName(const QString &name) const;
     EffectLoadQueue<BuiltInEffectLoader, BuiltInEffect> *m_queue;
     QMap<BuiltInEffect, Effect*> m_loadedEffects;
@@ -1511,15 +1511,15 @@ EffectWindowImpl::EffectWindowImpl(Toplevel *toplevel)
     , toplevel(toplevel)
     , sw(NULL)
 {
+    for (int i = 0; i < DataRoleCount; ++i) {
+        m_dataSlots[i].flag = false;
+        m_dataSlots[i].pointer = nullptr;
+    }
 }
 
 EffectWindowImpl::~EffectWindowImpl()
 {
-    QVariant cachedTextureVariant = data(LanczosCacheRole);
-    if (cachedTextureVariant.isValid()) {
-        GLTexture *cachedTexture = static_cast< GLTexture*>(cachedTextureVariant.value<void*>());
-        delete cachedTexture;
-    }
+    delete static_cast<GLTexture*>(dataPointer(LanczosCacheRole));
 }
 
 bool EffectWindowImpl::isPaintingEnabled()
@@ -1625,8 +1625,42 @@ WindowQuadList EffectWindowImpl::buildQuads(bool force) const
     return sceneWindow()->buildQuads(force);
 }
 
+WindowQuadList EffectWindowImpl::cachedGrid(const WindowQuadList &quads, int maxQuadSize) const
+{
+    if (!sceneWindow()) {
+        return EffectWindow::cachedGrid(quads, maxQuadSize);
+    }
+    return sceneWindow()->cachedGrid(quads, maxQuadSize);
+}
+
+WindowQuadList EffectWindowImpl::cachedRegularGrid(const WindowQuadList &quads, int xSubdivisions, int ySubdivisions) const
+{
+    if (!sceneWindow()) {
+        return EffectWindow::cachedRegularGrid(quads, xSubdivisions, ySubdivisions);
+    }
+    return sceneWindow()->cachedRegularGrid(quads, xSubdivisions, ySubdivisions);
+}
+
+bool EffectWindowImpl::isSlotRole(int role)
+{
+    return role > 0 && role < DataRoleCount;
+}
+
 void EffectWindowImpl::setData(int role, const QVariant &data)
 {
+    if (isSlotRole(role)) {
+        DataSlot &slot = m_dataSlots[role];
+        if (!data.isNull()) {
+            slot.value = data;
+            slot.flag = data.toBool();
+            slot.pointer = data.value<void*>();
+        } else {
+            slot.value = QVariant();
+            slot.flag = false;
+            slot.pointer = nullptr;
+        }
+        return;
+    }
     if (!data.isNull())
         dataMap[ role ] = data;
     else
@@ -1635,11 +1669,34 @@ void EffectWindowImpl::setData(int role, const QVariant &data)
 
 QVariant EffectWindowImpl::data(int role) const
 {
+    if (isSlotRole(role))
+        return m_dataSlots[role].value;
     if (!dataMap.contains(role))
         return QVariant();
     return dataMap[ role ];
 }
 
+bool EffectWindowImpl::hasData(int role) const
+{
+    if (isSlotRole(role))
+        return m_dataSlots[role].value.isValid();
+    return dataMap.contains(role);
+}
+
+bool EffectWindowImpl::dataFlag(int role) const
+{
+    if (isSlotRole(role))
+        return m_dataSlots[role].flag;
+    return EffectWindow::dataFlag(role);
+}
+
+void *EffectWindowImpl::dataPointer(int role) const
+{
+    if (isSlotRole(role))
+        return m_dataSlots[role].pointer;
+    return EffectWindow::dataPointer(role);
+}
+
 EffectWindow* effectWindow(Toplevel* w)
 {
     EffectWindowImpl* ret = w->effectWindow();
@@ -302,6 +302,8 @@ public:
     EffectWindowList mainWindows() const override;
 
     WindowQuadList buildQuads(bool force = false) const override;
+    WindowQuadList cachedGrid(const WindowQuadList &quads, int maxQuadSize) const override;
+    WindowQuadList cachedRegularGrid(const WindowQuadList &quads, int xSubdivisions, int ySubdivisions) const override;
 
     void referencePreviousWindowPixmap() override;
     void unreferencePreviousWindowPixmap() override;
@@ -316,8 +318,11 @@ public:
 
     void elevate(bool elevate);
 
-    void setData(int role, const QVariant &data);
-    QVariant data(int role) const;
+    void setData(int role, const QVariant &data) override;
+    QVariant data(int role) const override;
+    bool hasData(int role) const override;
+    bool dataFlag(int role) const override;
+    void *dataPointer(int role) const override;
 
     void registerThumbnail(AbstractThumbnailItem *item);
     QHash<WindowThumbnailItem*, QWeakPointer<EffectWindowImpl> > const &thumbnails() const {
@@ -334,6 +339,14 @@ private:
     void insertThumbnail(WindowThumbnailItem *item);
     Toplevel* toplevel;
     Scene::Window* sw; // This one is used only during paint pass.
+    // the global DataRole values are stored in slots with their typed values, other roles in dataMap
+    struct DataSlot {
+        QVariant value;
+        bool flag;
+        void *pointer;
+    };
+    static bool isSlotRole(int role);
+    DataSlot m_dataSlots[DataRoleCount];
     QHash<int, QVariant> dataMap;
     QHash<WindowThumbnailItem*, QWeakPointer<EffectWindowImpl> > m_thumbnails;
     QList<DesktopThumbnailItem*> m_desktopThumbnails;
@@ -0,0 +1,221 @@
+/********************************************************************
+ KWin - the KDE window manager
+ This file is part of the KDE project.
+
+Copyright (C) 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#include "activationstub.h"
+#include "effect_builtins.h"
+
+#include <QAction>
+#include <KGlobalAccel>
+#include <KLocalizedString>
+#include <KStandardAction>
+
+namespace KWin
+{
+
+/**
+ * The config group of @p effect and the IntList keys of its screen edges,
+ * which have to match the effect's kcfg file.
+ * @returns @c false if @p effect does not only react to shortcuts and screen edges.
+ **/
+static bool activationTriggers(BuiltInEffect effect, QString *group, QStringList *borderKeys)
+{
+    switch (effect) {
+    case BuiltInEffect::Cube:
+        *group = QStringLiteral("Effect-Cube");
+        *borderKeys << QStringLiteral("BorderActivate")
+                    << QStringLiteral("BorderActivateCylinder")
+                    << QStringLiteral("BorderActivateSphere");
+        return true;
+    case BuiltInEffect::DesktopGrid:
+        *group = QStringLiteral("Effect-DesktopGrid");
+        *borderKeys << QStringLiteral("BorderActivate");
+        return true;
+    case BuiltInEffect::FlipSwitch:
+        *group = QStringLiteral("Effect-FlipSwitch");
+        return true;
+    case BuiltInEffect::LookingGlass:
+        *group = QStringLiteral("Effect-LookingGlass");
+        return true;
+    case BuiltInEffect::Magnifier:
+        *group = QStringLiteral("Effect-Magnifier");
+        return true;
+    case BuiltInEffect::Zoom:
+        *group = QStringLiteral("Effect-Zoom");
+        return true;
+    default:
+        // e.g. Present Windows also reacts to window properties and provides a proxy
+        return false;
+    }
+}
+
+/**
+ * Whether the configuration of @p effect in @p group requires the effect without any activation.
+ **/
+static bool neededWithoutActivation(BuiltInEffect effect, const KConfigGroup &group)
+{
+    switch (effect) {
+    case BuiltInEffect::Cube:
+        return group.readEntry("TabBox", false);
+    case BuiltInEffect::FlipSwitch:
+        return group.readEntry("TabBox", false) || group.readEntry("TabBoxAlternative", false);
+    case BuiltInEffect::Zoom:
+        // restores the zoom level of the previous session
+        return group.readEntry("InitialZoom", 1.0) > 1.0;
+    default:
+        return false;
+    }
+}
+
+ActivationStub *ActivationStub::create(BuiltInEffect effect, KSharedConfig::Ptr config)
+{
+    QString group;
+    QStringList borderKeys;
+    if (!activationTriggers(effect, &group, &borderKeys)) {
+        return nullptr;
+    }
+    const KConfigGroup configGroup = config->group(group);
+    if (neededWithoutActivation(effect, configGroup)) {
+        return nullptr;
+    }
+    return new ActivationStub(effect, configGroup, borderKeys);
+}
+
+ActivationStub::ActivationStub(BuiltInEffect effect, const KConfigGroup &group, const QStringList &borderKeys)
+    : Effect()
+    , m_effect(effect)
+    , m_group(group)
+    , m_borderKeys(borderKeys)
+    , m_triggeredBorder(ElectricNone)
+{
+    registerShortcuts();
+    reserveBorders();
+}
+
+ActivationStub::~ActivationStub()
+{
+}
+
+void ActivationStub::reconfigure(ReconfigureFlags)
+{
+    if (neededWithoutActivation(m_effect, m_group)) {
+        // e.g. the effect has to follow the tabbox from now on
+        emit activated();
+        return;
+    }
+    reserveBorders();
+}
+
+bool ActivationStub::isActive() const
+{
+    return false;
+}
+
+bool ActivationStub::borderActivated(ElectricBorder border)
+{
+    if (!m_borders.contains(border)) {
+        return false;
+    }
+    m_triggeredBorder = border;
+    emit activated();
+    return true;
+}
+
+void ActivationStub::reserveBorders()
+{
+    foreach (ElectricBorder border, m_borders) {
+        effects->unreserveElectricBorder(border, this);
+    }
+    m_borders.clear();
+    for (const QString &key : m_borderKeys) {
+        foreach (int i, m_group.readEntry(key, QList<int>())) {
+            m_borders.append(ElectricBorder(i));
+            effects->reserveElectricBorder(ElectricBorder(i), this);
+        }
+    }
+}
+
+QAction *ActivationStub::addShortcut(const QString &name, const QString &text, const QKeySequence &shortcut)
+{
+    QAction *a = new QAction(this);
+    a->setObjectName(name);
+    a->setText(text);
+    return addShortcut(a, shortcut);
+}
+
+QAction *ActivationStub::addShortcut(QAction *action, const QKeySequence &shortcut)
+{
+    QList<QKeySequence> shortcuts;
+    if (!shortcut.isEmpty()) {
+        shortcuts << shortcut;
+        KGlobalAccel::self()->setDefaultShortcut(action, shortcuts);
+    }
+    KGlobalAccel::self()->setShortcut(action, shortcuts);
+    effects->registerGlobalShortcut(shortcut, action);
+    connect(action, &QAction::triggered, this,
+        [this, action]() {
+            m_triggeredShortcut = action->objectName();
+            emit activated();
+        }
+    );
+    return action;
+}
+
+void ActivationStub::registerShortcuts()
+{
+    // the shortcuts have to match the ones the effects register
+    QAction *a = nullptr;
+    switch (m_effect) {
+    case BuiltInEffect::Cube:
+        a = addShortcut(QStringLiteral("Cube"), i18n("Desktop Cube"), Qt::CTRL + Qt::Key_F11);
+        effects->registerPointerShortcut(Qt::ControlModifier | Qt::AltModifier, Qt::LeftButton, a);
+        addShortcut(QStringLiteral("Cylinder"), i18n("Desktop Cylinder"), QKeySequence());
+        addShortcut(QStringLiteral("Sphere"), i18n("Desktop Sphere"), QKeySequence());
+        break;
+    case BuiltInEffect::DesktopGrid:
+        addShortcut(QStringLiteral("ShowDesktopGrid"), i18n("Show Desktop Grid"), Qt::CTRL + Qt::Key_F8);
+        break;
+    case BuiltInEffect::FlipSwitch:
+        addShortcut(QStringLiteral("FlipSwitchCurrent"), i18n("Toggle Flip Switch (Current desktop)"), QKeySequence());
+        addShortcut(QStringLiteral("FlipSwitchAll"), i18n("Toggle Flip Switch (All desktops)"), QKeySequence());
+        break;
+    case BuiltInEffect::Zoom:
+        a = addShortcut(KStandardAction::zoomIn(nullptr, nullptr, this), Qt::META + Qt::Key_Equal);
+        effects->registerAxisShortcut(Qt::ControlModifier | Qt::MetaModifier, PointerAxisDown, a);
+        a = addShortcut(KStandardAction::zoomOut(nullptr, nullptr, this), Qt::META + Qt::Key_Minus);
+        effects->registerAxisShortcut(Qt::ControlModifier | Qt::MetaModifier, PointerAxisUp, a);
+        addShortcut(KStandardAction::actualSize(nullptr, nullptr, this), Qt::META + Qt::Key_0);
+        addShortcut(QStringLiteral("MoveZoomLeft"), i18n("Move Zoomed Area to Left"), Qt::META + Qt::Key_Left);
+        addShortcut(QStringLiteral("MoveZoomRight"), i18n("Move Zoomed Area to Right"), Qt::META + Qt::Key_Right);
+        addShortcut(QStringLiteral("MoveZoomUp"), i18n("Move Zoomed Area Upwards"), Qt::META + Qt::Key_Up);
+        addShortcut(QStringLiteral("MoveZoomDown"), i18n("Move Zoomed Area Downwards"), Qt::META + Qt::Key_Down);
+        addShortcut(QStringLiteral("MoveMouseToFocus"), i18n("Move Mouse to Focus"), Qt::META + Qt::Key_F5);
+        addShortcut(QStringLiteral("MoveMouseToCenter"), i18n("Move Mouse to Center"), Qt::META + Qt::Key_F6);
+        break;
+    case BuiltInEffect::LookingGlass:
+    case BuiltInEffect::Magnifier:
+        addShortcut(KStandardAction::zoomIn(nullptr, nullptr, this), Qt::META + Qt::Key_Equal);
+        addShortcut(KStandardAction::zoomOut(nullptr, nullptr, this), Qt::META + Qt::Key_Minus);
+        addShortcut(KStandardAction::actualSize(nullptr, nullptr, this), Qt::META + Qt::Key_0);
+        break;
+    default:
+        Q_UNREACHABLE();
+    }
+}
+
+} // namespace
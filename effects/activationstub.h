@@ -0,0 +1,112 @@
+/********************************************************************
+ KWin - the KDE window manager
+ This file is part of the KDE project.
+
+Copyright (C) 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#ifndef KWIN_ACTIVATION_STUB_H
+#define KWIN_ACTIVATION_STUB_H
+#include <kwineffects.h>
+#include <kwineffects_export.h>
+
+#include <KConfigGroup>
+#include <KSharedConfig>
+
+namespace KWin
+{
+enum class BuiltInEffect;
+
+/**
+ * @short Placeholder for a built-in effect which only does something once the user activates it.
+ *
+ * Effects like the Desktop Cube or Zoom are only activated through their global shortcuts or
+ * reserved screen edges. The stub registers the same shortcuts (using the object names of the
+ * effect's actions) and reserves the configured screen edges, but does not create any of the
+ * effect's resources and is never active. When one of the triggers fires the stub emits
+ * activated() and the effect loader replaces the stub by the real effect, which then gets the
+ * trigger forwarded.
+ *
+ * Effects which are configured to follow the tabbox, or Zoom restoring the zoom level of the
+ * previous session, are needed right away and do not get a stub.
+ **/
+class KWINEFFECTS_EXPORT ActivationStub : public Effect
+{
+    Q_OBJECT
+public:
+    virtual ~ActivationStub();
+    void reconfigure(ReconfigureFlags flags) override;
+    bool isActive() const override;
+
+    BuiltInEffect effect() const;
+    /**
+     * @returns The object name of the action which activated the stub, empty if none did.
+     **/
+    QString triggeredShortcut() const;
+    /**
+     * @returns The screen edge which activated the stub, ElectricNone if none did.
+     **/
+    ElectricBorder triggeredBorder() const;
+
+    /**
+     * Creates the stub for @p effect, reading the triggers from @p config.
+     * @returns @c null if @p effect has to be created right away.
+     **/
+    static ActivationStub *create(BuiltInEffect effect, KSharedConfig::Ptr config);
+
+public Q_SLOTS:
+    bool borderActivated(ElectricBorder border) override;
+
+Q_SIGNALS:
+    /**
+     * Emitted when the real effect is needed.
+     **/
+    void activated();
+
+private:
+    ActivationStub(BuiltInEffect effect, const KConfigGroup &group, const QStringList &borderKeys);
+    void registerShortcuts();
+    QAction *addShortcut(QAction *action, const QKeySequence &shortcut);
+    QAction *addShortcut(const QString &name, const QString &text, const QKeySequence &shortcut);
+    void reserveBorders();
+    BuiltInEffect m_effect;
+    KConfigGroup m_group;
+    QStringList m_borderKeys;
+    QList<ElectricBorder> m_borders;
+    QString m_triggeredShortcut;
+    ElectricBorder m_triggeredBorder;
+};
+
+inline
+BuiltInEffect ActivationStub::effect() const
+{
+    return m_effect;
+}
+
+inline
+QString ActivationStub::triggeredShortcut() const
+{
+    return m_triggeredShortcut;
+}
+
+inline
+ElectricBorder ActivationStub::triggeredBorder() const
+{
+    return m_triggeredBorder;
+}
+
+} // namespace
+
+#endif
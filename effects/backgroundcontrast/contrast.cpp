@@ -305,7 +305,7 @@ bool ContrastEffect::shouldContrast(const EffectWindow *w, int mask, const Windo
     if (!shader || !shader->isValid())
         return false;
 
-    if (effects->activeFullScreenEffect() && !w->data(WindowForceBackgroundContrastRole).toBool())
+    if (effects->activeFullScreenEffect() && !w->dataFlag(WindowForceBackgroundContrastRole))
         return false;
 
     if (w->isDesktop())
@@ -314,7 +314,7 @@ bool ContrastEffect::shouldContrast(const EffectWindow *w, int mask, const Windo
     bool scaled = !qFuzzyCompare(data.xScale(), 1.0) && !qFuzzyCompare(data.yScale(), 1.0);
     bool translated = data.xTranslation() || data.yTranslation();
 
-    if (scaled || ((translated || (mask & PAINT_WINDOW_TRANSFORMED)) && !w->data(WindowForceBackgroundContrastRole).toBool()))
+    if (scaled || ((translated || (mask & PAINT_WINDOW_TRANSFORMED)) && !w->dataFlag(WindowForceBackgroundContrastRole)))
         return false;
 
     if (!w->hasAlpha())
@@ -368,7 +368,7 @@ bool BlurEffect::shouldBlur(const EffectWindow *w, int mask, const WindowPaintDa
     if (!target->valid() || !shader || !shader->isValid())
         return false;
 
-    if (effects->activeFullScreenEffect() && !w->data(WindowForceBlurRole).toBool())
+    if (effects->activeFullScreenEffect() && !w->dataFlag(WindowForceBlurRole))
         return false;
 
     if (w->isDesktop())
@@ -377,7 +377,7 @@ bool BlurEffect::shouldBlur(const EffectWindow *w, int mask, const WindowPaintDa
     bool scaled = !qFuzzyCompare(data.xScale(), 1.0) && !qFuzzyCompare(data.yScale(), 1.0);
     bool translated = data.xTranslation() || data.yTranslation();
 
-    if (scaled || ((translated || (mask & PAINT_WINDOW_TRANSFORMED)) && !w->data(WindowForceBlurRole).toBool()))
+    if (scaled || ((translated || (mask & PAINT_WINDOW_TRANSFORMED)) && !w->dataFlag(WindowForceBlurRole)))
         return false;
 
     bool blurBehindDecos = effects->decorationsHaveAlpha() &&
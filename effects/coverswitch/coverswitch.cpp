@@ -52,6 +52,7 @@ CoverSwitchEffect::CoverSwitchEffect()
     , captionFrame(NULL)
     , primaryTabBox(false)
     , secondaryTabBox(false)
+    , m_reflectionShader(NULL)
 {
     reconfigure(ReconfigureAll);
 
@@ -59,31 +60,38 @@ CoverSwitchEffect::CoverSwitchEffect()
     captionFont.setBold(true);
     captionFont.setPointSize(captionFont.pointSize() * 2);
 
-    if (effects->compositingType() == OpenGL2Compositing) {
-        QString shadersDir = QStringLiteral("kwin/shaders/1.10/");
-#ifdef KWIN_HAVE_OPENGLES
-        const qint64 coreVersionNumber = kVersionNumber(3, 0);
-#else
-        const qint64 coreVersionNumber = kVersionNumber(1, 40);
-#endif
-        if (GLPlatform::instance()->glslVersion() >= coreVersionNumber)
-            shadersDir = QStringLiteral("kwin/shaders/1.40/");
-        const QString fragmentshader = QStandardPaths::locate(QStandardPaths::GenericDataLocation, shadersDir + QStringLiteral("coverswitch-reflection.glsl"));
-        m_reflectionShader = ShaderManager::instance()->loadFragmentShader(ShaderManager::GenericShader, fragmentshader);
-    } else {
-        m_reflectionShader = NULL;
-    }
     connect(effects, SIGNAL(windowClosed(KWin::EffectWindow*)), this, SLOT(slotWindowClosed(KWin::EffectWindow*)));
     connect(effects, SIGNAL(tabBoxAdded(int)), this, SLOT(slotTabBoxAdded(int)));
     connect(effects, SIGNAL(tabBoxClosed()), this, SLOT(slotTabBoxClosed()));
     connect(effects, SIGNAL(tabBoxUpdated()), this, SLOT(slotTabBoxUpdated()));
     connect(effects, SIGNAL(tabBoxKeyEvent(QKeyEvent*)), this, SLOT(slotTabBoxKeyEvent(QKeyEvent*)));
+    connect(effects, SIGNAL(windowDamaged(KWin::EffectWindow*,QRect)), this, SLOT(slotWindowDamaged(KWin::EffectWindow*)));
+    connect(effects, SIGNAL(windowDeleted(KWin::EffectWindow*)), this, SLOT(slotWindowDeleted(KWin::EffectWindow*)));
 }
 
 CoverSwitchEffect::~CoverSwitchEffect()
 {
     delete captionFrame;
     delete m_reflectionShader;
+    deleteReflectionTextures();
+}
+
+void CoverSwitchEffect::loadReflectionShader()
+{
+    // loaded on first use instead of in the constructor, the effect might never be used
+    if (m_reflectionShader || effects->compositingType() != OpenGL2Compositing) {
+        return;
+    }
+    QString shadersDir = QStringLiteral("kwin/shaders/1.10/");
+#ifdef KWIN_HAVE_OPENGLES
+    const qint64 coreVersionNumber = kVersionNumber(3, 0);
+#else
+    const qint64 coreVersionNumber = kVersionNumber(1, 40);
+#endif
+    if (GLPlatform::instance()->glslVersion() >= coreVersionNumber)
+        shadersDir = QStringLiteral("kwin/shaders/1.40/");
+    const QString fragmentshader = QStandardPaths::locate(QStandardPaths::GenericDataLocation, shadersDir + QStringLiteral("coverswitch-reflection.glsl"));
+    m_reflectionShader = ShaderManager::instance()->loadFragmentShader(ShaderManager::GenericShader, fragmentshader);
 }
 
 bool CoverSwitchEffect::supported()
@@ -253,6 +261,7 @@ void CoverSwitchEffect::paintScreen(int mask, QRegion region, ScreenPaintData& d
         }
 
         if (reflection) {
+            loadReflectionShader();
             // no reflections during start and stop animation
             // except when using a shader
             if ((!start && !stop) || effects->compositingType() == OpenGL2Compositing)
@@ -365,6 +374,7 @@ void CoverSwitchEffect::postPaintScreen()
                 }
                 referrencedWindows.clear();
                 currentWindowList.clear();
+                deleteReflectionTextures();
                 if (startRequested) {
                     startRequested = false;
                     mActivated = true;
@@ -686,6 +696,8 @@ void CoverSwitchEffect::paintWindowCover(EffectWindow* w, bool reflectedWindow,
     }
 
     if (reflectedWindow) {
+        // painting the cached window is a lot cheaper than running through the scene again
+        GLTexture *texture = reflectionTexture(w);
         GLShader *shader = ShaderManager::instance()->pushShader(ShaderManager::GenericShader);
         QMatrix4x4 origMatrix = shader->getUniformMatrix4x4("screenTransformation");
         QMatrix4x4 reflectionMatrix;
@@ -697,9 +709,13 @@ void CoverSwitchEffect::paintWindowCover(EffectWindow* w, bool reflectedWindow,
         } else if (stop) {
             data.multiplyOpacity(1.0 - timeLine.currentValue());
         }
-        effects->drawWindow(w,
+        if (texture) {
+            paintReflectionTexture(w, texture, data);
+        } else {
+            effects->drawWindow(w,
                                 PAINT_WINDOW_TRANSFORMED,
                                 infiniteRegion(), data);
+        }
         shader->setUniform("screenTransformation", origMatrix);
         ShaderManager::instance()->popShader();
     } else {
@@ -923,6 +939,7 @@ void CoverSwitchEffect::abort()
     stopRequested = false;
     effects->addRepaintFull();
     captionFrame->free();
+    deleteReflectionTextures();
 }
 
 void CoverSwitchEffect::slotWindowClosed(EffectWindow* c)
@@ -939,6 +956,142 @@ void CoverSwitchEffect::slotWindowClosed(EffectWindow* c)
     }
 }
 
+void CoverSwitchEffect::slotWindowDamaged(EffectWindow *w)
+{
+    if (m_reflectionTextures.contains(w)) {
+        m_dirtyReflections.insert(w);
+    }
+}
+
+void CoverSwitchEffect::slotWindowDeleted(EffectWindow *w)
+{
+    delete m_reflectionTextures.take(w);
+    m_dirtyReflections.remove(w);
+}
+
+GLTexture *CoverSwitchEffect::reflectionTexture(EffectWindow *w)
+{
+    if (effects->compositingType() != OpenGL2Compositing || !GLRenderTarget::supported()
+            || !GLTexture::NPOTTextureSupported()) {
+        return NULL;
+    }
+    const QRect geometry = w->expandedGeometry();
+    if (geometry.isEmpty()) {
+        return NULL;
+    }
+    // the reflection is faded out anyway, half of the resolution is good enough
+    const QSize size((geometry.width() + 1) / 2, (geometry.height() + 1) / 2);
+    GLTexture *texture = m_reflectionTextures.value(w);
+    if (texture && texture->size() == size && !m_dirtyReflections.contains(w)) {
+        return texture;
+    }
+    if (!texture || texture->size() != size) {
+        delete texture;
+        texture = new GLTexture(size.width(), size.height());
+        texture->setFilter(GL_LINEAR);
+        texture->setWrapMode(GL_CLAMP_TO_EDGE);
+        m_reflectionTextures.insert(w, texture);
+    }
+    GLRenderTarget target(*texture);
+    if (!target.valid()) {
+        delete m_reflectionTextures.take(w);
+        m_dirtyReflections.remove(w);
+        return NULL;
+    }
+
+    // render the window including decoration and shadow without any transformation,
+    // opacity is applied when painting the texture. The projection covers the complete
+    // window, the viewport of the smaller texture scales it down
+    WindowPaintData data(w);
+    data.setOpacity(1.0);
+    data.setXTranslation(-geometry.x());
+    data.setYTranslation(-geometry.y());
+    QMatrix4x4 projection;
+    projection.ortho(QRect(0, 0, geometry.width(), geometry.height()));
+
+    GLRenderTarget::pushRenderTarget(&target);
+    glClearColor(0.0, 0.0, 0.0, 0.0);
+    glClear(GL_COLOR_BUFFER_BIT);
+    glClearColor(0.0, 0.0, 0.0, 1.0);
+    GLShader *shader = ShaderManager::instance()->pushShader(ShaderManager::GenericShader);
+    const QMatrix4x4 origProjection = shader->getUniformMatrix4x4("projection");
+    const QMatrix4x4 origModelview = shader->getUniformMatrix4x4("modelview");
+    const QMatrix4x4 origScreenTransformation = shader->getUniformMatrix4x4("screenTransformation");
+    shader->setUniform(GLShader::ProjectionMatrix, projection);
+    shader->setUniform(GLShader::ModelViewMatrix, QMatrix4x4());
+    shader->setUniform(GLShader::ScreenTransformation, QMatrix4x4());
+    effects->drawWindow(w, PAINT_WINDOW_TRANSFORMED | PAINT_WINDOW_TRANSLUCENT, infiniteRegion(), data);
+    shader->setUniform(GLShader::ProjectionMatrix, origProjection);
+    shader->setUniform(GLShader::ModelViewMatrix, origModelview);
+    shader->setUniform(GLShader::ScreenTransformation, origScreenTransformation);
+    ShaderManager::instance()->popShader();
+    GLRenderTarget::popRenderTarget();
+
+    m_dirtyReflections.remove(w);
+    return texture;
+}
+
+void CoverSwitchEffect::paintReflectionTexture(EffectWindow *w, GLTexture *texture, const WindowPaintData &data)
+{
+    const QRect geometry = w->expandedGeometry();
+    const float left = geometry.x() - w->x();
+    const float top = geometry.y() - w->y();
+    const float right = left + geometry.width();
+    const float bottom = top + geometry.height();
+    const float verts[] = {
+        left, top,
+        right, top,
+        right, bottom,
+        right, bottom,
+        left, bottom,
+        left, top
+    };
+    const float texcoords[] = {
+        0.0, 1.0,
+        1.0, 1.0,
+        1.0, 0.0,
+        1.0, 0.0,
+        0.0, 0.0,
+        0.0, 1.0
+    };
+    GLVertexBuffer *vbo = GLVertexBuffer::streamingBuffer();
+    vbo->reset();
+    vbo->setData(6, 2, verts, texcoords);
+
+    // the transformation the scene uses for a transformed window
+    QMatrix4x4 windowTransformation;
+    windowTransformation.translate(w->x(), w->y());
+    windowTransformation.translate(data.translation());
+    windowTransformation.scale(data.xScale(), data.yScale(), data.zScale());
+    if (data.rotationAngle() != 0.0) {
+        const QVector3D axis = data.rotationAxis();
+        windowTransformation.translate(data.rotationOrigin());
+        windowTransformation.rotate(data.rotationAngle(), axis.x(), axis.y(), axis.z());
+        windowTransformation.translate(-data.rotationOrigin());
+    }
+
+    // the texture contains premultiplied colors
+    const float opacity = data.opacity();
+    GLShader *shader = ShaderManager::instance()->getBoundShader();
+    shader->setUniform(GLShader::WindowTransformation, windowTransformation);
+    shader->setUniform(GLShader::ModulationConstant, QVector4D(opacity, opacity, opacity, opacity));
+    shader->setUniform(GLShader::Saturation, 1.0f);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    texture->bind();
+    vbo->render(GL_TRIANGLES);
+    texture->unbind();
+    glDisable(GL_BLEND);
+    shader->setUniform(GLShader::WindowTransformation, QMatrix4x4());
+}
+
+void CoverSwitchEffect::deleteReflectionTextures()
+{
+    qDeleteAll(m_reflectionTextures);
+    m_reflectionTextures.clear();
+    m_dirtyReflections.clear();
+}
+
 bool CoverSwitchEffect::isActive() const
 {
     return mActivated || stop || stopRequested;
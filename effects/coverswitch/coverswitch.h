@@ -24,6 +24,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QHash>
 #include <QRect>
 #include <QRegion>
+#include <QSet>
 #include <QSize>
 #include <QTimeLine>
 #include <QQueue>
@@ -101,6 +102,8 @@ public Q_SLOTS:
     void slotTabBoxClosed();
     void slotTabBoxUpdated();
     void slotTabBoxKeyEvent(QKeyEvent* event);
+    void slotWindowDamaged(KWin::EffectWindow *w);
+    void slotWindowDeleted(KWin::EffectWindow *w);
 
 private:
     void paintScene(EffectWindow* frontWindow, const EffectWindowList& leftWindows, const EffectWindowList& rightWindows,
@@ -118,6 +121,15 @@ private:
      * As well sets the icon for the caption frame.
      **/
     void updateCaption();
+    /**
+     * @returns Texture with the untransformed window at half of its size, used to paint its reflection.
+     * The window is only rendered again if it got damaged since the last call.
+     * @c null if rendering into a texture is not possible.
+     **/
+    GLTexture *reflectionTexture(EffectWindow *w);
+    void paintReflectionTexture(EffectWindow *w, GLTexture *texture, const WindowPaintData &data);
+    void deleteReflectionTextures();
+    void loadReflectionShader();
 
     bool mActivated;
     float angle;
@@ -157,6 +169,8 @@ private:
     bool secondaryTabBox;
 
     GLShader *m_reflectionShader;
+    QHash<EffectWindow*, GLTexture*> m_reflectionTextures;
+    QSet<EffectWindow*> m_dirtyReflections;
 };
 
 } // namespace
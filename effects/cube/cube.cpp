@@ -38,6 +38,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QtConcurrentRun>
 #include <QVector2D>
 #include <QVector3D>
+#include <QVector4D>
 
 #include <math.h>
 
@@ -74,6 +75,7 @@ CubeEffect::CubeEffect()
     , start(false)
     , stop(false)
     , reflectionPainting(false)
+    , facePainting(false)
     , activeScreen(0)
     , bottomCap(false)
     , closeOnMouseRelease(false)
@@ -86,6 +88,8 @@ CubeEffect::CubeEffect()
     , useShaders(false)
     , cylinderShader(0)
     , sphereShader(0)
+    , m_reflectionShader(NULL)
+    , m_capShader(NULL)
     , zOrderingFactor(0.0f)
     , mAddedHeightCoeff1(0.0f)
     , mAddedHeightCoeff2(0.0f)
@@ -104,21 +108,20 @@ CubeEffect::CubeEffect()
     if (GLPlatform::instance()->glslVersion() >= coreVersionNumber)
         m_shadersDir = QStringLiteral("kwin/shaders/1.40/");
 
-    if (effects->compositingType() == OpenGL2Compositing) {
-        const QString fragmentshader = QStandardPaths::locate(QStandardPaths::GenericDataLocation, m_shadersDir + QStringLiteral("cube-reflection.glsl"));
-        m_reflectionShader = ShaderManager::instance()->loadFragmentShader(ShaderManager::GenericShader, fragmentshader);
-        const QString capshader = QStandardPaths::locate(QStandardPaths::GenericDataLocation, m_shadersDir + QStringLiteral("cube-cap.glsl"));
-        m_capShader = ShaderManager::instance()->loadFragmentShader(ShaderManager::GenericShader, capshader);
-    } else {
-        m_reflectionShader = NULL;
-        m_capShader = NULL;
-    }
     m_textureMirrorMatrix.scale(1.0, -1.0, 1.0);
     m_textureMirrorMatrix.translate(0.0, -1.0, 0.0);
     connect(effects, SIGNAL(tabBoxAdded(int)), this, SLOT(slotTabBoxAdded(int)));
     connect(effects, SIGNAL(tabBoxClosed()), this, SLOT(slotTabBoxClosed()));
     connect(effects, SIGNAL(tabBoxUpdated()), this, SLOT(slotTabBoxUpdated()));
     connect(effects, SIGNAL(screenGeometryChanged(const QSize&)), this, SLOT(slotResetShaders()));
+    connect(effects, SIGNAL(screenGeometryChanged(const QSize&)), this, SLOT(slotDeleteFaceTextures()));
+    connect(effects, SIGNAL(windowDamaged(KWin::EffectWindow*,QRect)), this, SLOT(slotWindowDamaged(KWin::EffectWindow*)));
+    connect(effects, SIGNAL(windowAdded(KWin::EffectWindow*)), this, SLOT(slotWindowDamaged(KWin::EffectWindow*)));
+    connect(effects, SIGNAL(windowClosed(KWin::EffectWindow*)), this, SLOT(slotWindowDamaged(KWin::EffectWindow*)));
+    connect(effects, SIGNAL(windowOpacityChanged(KWin::EffectWindow*,qreal,qreal)), this, SLOT(slotWindowDamaged(KWin::EffectWindow*)));
+    connect(effects, SIGNAL(windowGeometryShapeChanged(KWin::EffectWindow*,QRect)), this, SLOT(slotInvalidateFaceTextures()));
+    connect(effects, SIGNAL(desktopPresenceChanged(KWin::EffectWindow*,int,int)), this, SLOT(slotInvalidateFaceTextures()));
+    connect(effects, SIGNAL(stackingOrderChanged()), this, SLOT(slotInvalidateFaceTextures()));
 
     reconfigure(ReconfigureAll);
 }
@@ -167,6 +170,8 @@ void CubeEffect::reconfigure(ReconfigureFlags)
 
     cubeOpacity = (float)CubeConfig::opacity() / 100.0f;
     opacityDesktopOnly = CubeConfig::opacityDesktopOnly();
+    // the face textures contain the desktop opacity
+    slotInvalidateFaceTextures();
     displayDesktopName = CubeConfig::displayDesktopName();
     reflection = CubeConfig::reflection();
     // TODO: rename rotationDuration to duration
@@ -240,6 +245,7 @@ CubeEffect::~CubeEffect()
     delete m_reflectionShader;
     delete m_capShader;
     delete m_cubeCapBuffer;
+    deleteFaceTextures();
 }
 
 QImage CubeEffect::loadCubeCap(const QString &capPath)
@@ -302,6 +308,23 @@ void CubeEffect::slotResetShaders()
     ShaderManager::instance()->resetShader(sphereShader,        ShaderManager::GenericShader);
 }
 
+void CubeEffect::loadCapAndReflectionShaders()
+{
+    // not done in the constructor, the cube might never be used
+    if (m_capShader || effects->compositingType() != OpenGL2Compositing) {
+        return;
+    }
+    effects->makeOpenGLContextCurrent();
+    const QString fragmentshader = QStandardPaths::locate(QStandardPaths::GenericDataLocation, m_shadersDir + QStringLiteral("cube-reflection.glsl"));
+    m_reflectionShader = ShaderManager::instance()->loadFragmentShader(ShaderManager::GenericShader, fragmentshader);
+    const QString capshader = QStandardPaths::locate(QStandardPaths::GenericDataLocation, m_shadersDir + QStringLiteral("cube-cap.glsl"));
+    m_capShader = ShaderManager::instance()->loadFragmentShader(ShaderManager::GenericShader, capshader);
+    if (m_capShader->isValid()) {
+        ShaderBinder binder(m_capShader);
+        m_capShader->setUniform("u_capColor", capColor);
+    }
+}
+
 bool CubeEffect::loadShader()
 {
     effects->makeOpenGLContextCurrent();
@@ -445,6 +468,11 @@ void CubeEffect::paintScreen(int mask, QRegion region, ScreenPaintData& data)
             } else {
                 m_reflectionMatrix.translate(0.0, sin(fabs(manualAngle) * M_PI / 360.0f * float(effects->numberOfDesktops())) * addedHeight2 + addedHeight1 - float(rect.height()), 0.0);
             }
+            // the reflection is painted from flat renderings of the desktops which are only
+            // updated when damaged instead of running the effect chain for all desktops again
+            const bool faceTextures = useFaceTextures() && updateFaceTextures(mask, region);
+            glEnable(GL_BLEND);
+            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
 #ifndef KWIN_HAVE_OPENGLES
             // TODO: find a solution for GLES
@@ -456,10 +484,18 @@ void CubeEffect::paintScreen(int mask, QRegion region, ScreenPaintData& data)
 
             // cube
             glCullFace(GL_BACK);
-            paintCube(mask, region, data);
+            if (faceTextures) {
+                paintFaceTextures(data);
+            } else {
+                paintCube(mask, region, data);
+            }
 
             glCullFace(GL_FRONT);
-            paintCube(mask, region, data);
+            if (faceTextures) {
+                paintFaceTextures(data);
+            } else {
+                paintCube(mask, region, data);
+            }
 
             paintCap(false, -point - zTranslate);
             glDisable(GL_CULL_FACE);
@@ -704,6 +740,187 @@ void CubeEffect::paintCube(int mask, QRegion region, ScreenPaintData& data)
     painting_desktop = effects->currentDesktop();
 }
 
+bool CubeEffect::useFaceTextures() const
+{
+    // windows spanning several desktops and z-ordering need the per window transformations
+    return mode == Cube && !useZOrdering && effects->compositingType() == OpenGL2Compositing
+            && GLRenderTarget::supported() && GLTexture::NPOTTextureSupported();
+}
+
+bool CubeEffect::updateFaceTextures(int mask, QRegion region)
+{
+    const int desktops = effects->numberOfDesktops();
+    if (m_faceTextures.count() != desktops) {
+        deleteFaceTextures();
+        const QRect rect = effects->clientArea(FullArea, activeScreen, effects->currentDesktop());
+        // the reflection is faded out anyway, half of the resolution is good enough
+        const QSize size((rect.width() + 1) / 2, (rect.height() + 1) / 2);
+        for (int i = 0; i < desktops; i++) {
+            GLTexture *texture = new GLTexture(size.width(), size.height());
+            texture->setFilter(GL_LINEAR);
+            texture->setWrapMode(GL_CLAMP_TO_EDGE);
+            GLRenderTarget *target = new GLRenderTarget(*texture);
+            m_faceTextures << texture;
+            m_faceTargets << target;
+            m_faceDirty << true;
+            if (!target->valid()) {
+                deleteFaceTextures();
+                return false;
+            }
+        }
+    }
+    float clearColor[4];
+    glGetFloatv(GL_COLOR_CLEAR_VALUE, clearColor);
+    glClearColor(0.0, 0.0, 0.0, 0.0);
+    cube_painting = true;
+    facePainting = true;
+    for (int i = 0; i < desktops; i++) {
+        if (!m_faceDirty.at(i)) {
+            continue;
+        }
+        painting_desktop = i + 1;
+        GLRenderTarget::pushRenderTarget(m_faceTargets.at(i));
+        glClear(GL_COLOR_BUFFER_BIT);
+        ScreenPaintData faceData;
+        effects->paintScreen(mask, region, faceData);
+        GLRenderTarget::popRenderTarget();
+        m_faceDirty[i] = false;
+    }
+    facePainting = false;
+    cube_painting = false;
+    painting_desktop = effects->currentDesktop();
+    glClearColor(clearColor[0], clearColor[1], clearColor[2], clearColor[3]);
+    return true;
+}
+
+void CubeEffect::paintFaceTextures(const ScreenPaintData &data)
+{
+    const QRect rect = effects->clientArea(FullArea, activeScreen, effects->currentDesktop());
+    const int desktops = effects->numberOfDesktops();
+    float internalCubeAngle = 360.0f / desktops;
+    float zTranslate = zPosition + zoom;
+    if (start)
+        zTranslate *= timeLine.currentValue();
+    if (stop)
+        zTranslate *= (1.0 - timeLine.currentValue());
+    float cubeAngle = (float)((float)(desktops - 2) / (float)desktops * 180.0f);
+    float point = rect.width() / 2 * tan(cubeAngle * 0.5f * M_PI / 180.0f);
+
+    // same opacity as paintWindow uses for reflected windows, applied to the complete face
+    // if only the desktop is translucent it already got its opacity in the face texture
+    float opacity = cubeOpacity;
+    if (start)
+        opacity = 0.5 + (cubeOpacity - 0.5) * timeLine.currentValue();
+    if (stop)
+        opacity = 0.5 + (cubeOpacity - 0.5) * (1.0 - timeLine.currentValue());
+    if (opacity > 0.99f || opacityDesktopOnly)
+        opacity = 0.99f;
+
+    // same winding as the window quads, otherwise face culling picks the wrong side
+    const float left = rect.x();
+    const float top = rect.y();
+    const float right = rect.x() + rect.width();
+    const float bottom = rect.y() + rect.height();
+    const float verts[] = {
+        left, top,
+        right, top,
+        right, bottom,
+        right, bottom,
+        left, bottom,
+        left, top
+    };
+    const float texcoords[] = {
+        0.0, 1.0,
+        1.0, 1.0,
+        1.0, 0.0,
+        1.0, 0.0,
+        0.0, 0.0,
+        0.0, 1.0
+    };
+    GLVertexBuffer *vbo = GLVertexBuffer::streamingBuffer();
+    vbo->reset();
+    vbo->setData(6, 2, verts, texcoords);
+
+    // the textures contain premultiplied colors
+    glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    ShaderBinder binder(ShaderManager::GenericShader);
+    GLShader *shader = binder.shader();
+    shader->setUniform(GLShader::WindowTransformation, QMatrix4x4());
+    shader->setUniform(GLShader::ModulationConstant, QVector4D(opacity, opacity, opacity, opacity));
+    shader->setUniform(GLShader::Saturation, 1.0f);
+    for (int i = 0; i < desktops; i++) {
+        int desktop = (i + frontDesktop) % desktops;
+        if (desktop == 0) {
+            desktop = desktops;
+        }
+        // the transformation paintCube passes to the scene for this desktop
+        QMatrix4x4 faceMatrix;
+        faceMatrix.translate(data.xTranslation(), data.yTranslation(), -zTranslate);
+        faceMatrix.scale(data.xScale(), data.yScale(), data.zScale());
+        const QVector3D origin(rect.width() / 2, 0.0, -point);
+        faceMatrix.translate(origin);
+        faceMatrix.rotate(internalCubeAngle * i, 0.0, 1.0, 0.0);
+        faceMatrix.translate(-origin);
+        shader->setUniform(GLShader::ScreenTransformation, m_reflectionMatrix * m_rotationMatrix * faceMatrix);
+
+        GLTexture *texture = m_faceTextures.at(desktop - 1);
+        texture->bind();
+        vbo->render(GL_TRIANGLES);
+        texture->unbind();
+    }
+    shader->setUniform(GLShader::ScreenTransformation, QMatrix4x4());
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+}
+
+void CubeEffect::deleteFaceTextures()
+{
+    qDeleteAll(m_faceTargets);
+    m_faceTargets.clear();
+    qDeleteAll(m_faceTextures);
+    m_faceTextures.clear();
+    m_faceDirty.clear();
+}
+
+void CubeEffect::invalidateFaceTexture(int desktop)
+{
+    if (desktop < 1 || desktop > m_faceDirty.count()) {
+        return;
+    }
+    m_faceDirty[desktop - 1] = true;
+}
+
+void CubeEffect::slotInvalidateFaceTextures()
+{
+    m_faceDirty.fill(true);
+}
+
+void CubeEffect::slotDeleteFaceTextures()
+{
+    deleteFaceTextures();
+}
+
+void CubeEffect::slotWindowDamaged(EffectWindow *w)
+{
+    if (!activated || m_faceDirty.isEmpty()) {
+        return;
+    }
+    const int desktops = m_faceDirty.count();
+    const int desktop = w->desktop();
+    if (w->isOnAllDesktops() || desktop < 1 || desktop > desktops) {
+        slotInvalidateFaceTextures();
+        return;
+    }
+    invalidateFaceTexture(desktop);
+    // parts outside of the desktop are painted on the neighbouring faces
+    const QRect rect = effects->clientArea(FullArea, activeScreen, desktop);
+    if (w->x() < rect.x()) {
+        invalidateFaceTexture(desktop == 1 ? desktops : desktop - 1);
+    }
+    if (w->x() + w->width() > rect.x() + rect.width()) {
+        invalidateFaceTexture(desktop == desktops ? 1 : desktop + 1);
+    }
+}
+
 void CubeEffect::paintCap(bool frontFirst, float zOffset)
 {
     if ((!paintCaps) || effects->numberOfDesktops() <= 2)
@@ -1051,6 +1268,7 @@ void CubeEffect::postPaintScreen()
                 stop = false;
                 timeLine.setCurrentTime(0);
                 activated = false;
+                deleteFaceTextures();
                 // set the new desktop
                 if (keyboard_grab)
                     effects->ungrabKeyboard();
@@ -1147,11 +1365,11 @@ void CubeEffect::prePaintWindow(EffectWindow* w, WindowPrePaintData& data, int t
                 if (rightDesktop > effects->numberOfDesktops())
                     rightDesktop = 1;
                 if (painting_desktop == frontDesktop)
-                    data.quads = data.quads.makeGrid(40);
+                    data.quads = w->cachedGrid(data.quads, 40);
                 else if (painting_desktop == leftDesktop || painting_desktop == rightDesktop)
-                    data.quads = data.quads.makeGrid(100);
+                    data.quads = w->cachedGrid(data.quads, 100);
                 else
-                    data.quads = data.quads.makeGrid(250);
+                    data.quads = w->cachedGrid(data.quads, 250);
             }
             if (w->isOnDesktop(painting_desktop)) {
                 QRect rect = effects->clientArea(FullArea, activeScreen, painting_desktop);
@@ -1225,7 +1443,10 @@ void CubeEffect::paintWindow(EffectWindow* w, int mask, QRegion region, WindowPa
     QMatrix4x4 origMatrix;
     if (activated && cube_painting) {
         region= infiniteRegion(); // we need to explicitly prevent any clipping, bug #325432
-        shader = shaderManager->pushShader(ShaderManager::GenericShader);
+        // face textures are rendered flat, the cube transformation is applied when painting them
+        if (!facePainting) {
+            shader = shaderManager->pushShader(ShaderManager::GenericShader);
+        }
         //qCDebug(KWINEFFECTS) << w->caption();
         float opacity = cubeOpacity;
         if (start) {
@@ -1269,7 +1490,7 @@ void CubeEffect::paintWindow(EffectWindow* w, int mask, QRegion region, WindowPa
                 }
             }
             data.quads = new_quads;
-            if (shader) {
+            if (shader || facePainting) {
                 data.setXTranslation(-rect.width());
             }
         }
@@ -1282,7 +1503,7 @@ void CubeEffect::paintWindow(EffectWindow* w, int mask, QRegion region, WindowPa
                 }
             }
             data.quads = new_quads;
-            if (shader) {
+            if (shader || facePainting) {
                 data.setXTranslation(rect.width());
             }
         }
@@ -1309,7 +1530,12 @@ void CubeEffect::paintWindow(EffectWindow* w, int mask, QRegion region, WindowPa
             opacity = 0.99f;
         if (opacityDesktopOnly && !w->isDesktop())
             opacity = 0.99f;
-        data.multiplyOpacity(opacity);
+        if (!facePainting) {
+            data.multiplyOpacity(opacity);
+        } else if (opacityDesktopOnly && w->isDesktop()) {
+            // the face texture is painted opaque, so the desktop gets the cube opacity here
+            data.multiplyOpacity(qMin(cubeOpacity, 0.99f));
+        }
 
         if (w->isOnDesktop(painting_desktop) && w->x() < rect.x()) {
             WindowQuadList new_quads;
@@ -1438,7 +1664,9 @@ void CubeEffect::paintWindow(EffectWindow* w, int mask, QRegion region, WindowPa
                     ShaderManager::instance()->pushShader(m_capShader);
                     m_capShader->setUniform("u_mirror", 0);
                     m_capShader->setUniform("u_untextured", 1);
-                    if (reflectionPainting) {
+                    if (facePainting) {
+                        m_capShader->setUniform(GLShader::ScreenTransformation, QMatrix4x4());
+                    } else if (reflectionPainting) {
                         m_capShader->setUniform(GLShader::ScreenTransformation, m_reflectionMatrix * m_rotationMatrix * origMatrix);
                     } else {
                         m_capShader->setUniform(GLShader::ScreenTransformation, m_rotationMatrix * origMatrix);
@@ -1769,6 +1997,7 @@ void CubeEffect::setActive(bool active)
         inside->setActive(true);
     }
     if (active) {
+        loadCapAndReflectionShaders();
         QString capPath = CubeConfig::capPath();
         if (texturedCaps && !capTexture && !capPath.isEmpty()) {
             QFutureWatcher<QImage> *watcher = new QFutureWatcher<QImage>(this);
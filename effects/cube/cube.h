@@ -27,6 +27,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QQueue>
 #include <QMatrix4x4>
 #include <QTimeLine>
+#include <QVector>
 #include "cube_inside.h"
 #include "cube_proxy.h"
 
@@ -141,6 +142,9 @@ private Q_SLOTS:
     void slotCubeCapLoaded();
     void slotWallPaperLoaded();
     void slotResetShaders();
+    void slotWindowDamaged(KWin::EffectWindow *w);
+    void slotInvalidateFaceTextures();
+    void slotDeleteFaceTextures();
 private:
     enum RotationDirection {
         Left,
@@ -164,7 +168,13 @@ private:
     void paintCubeCap();
     void paintCylinderCap();
     void paintSphereCap();
+    bool useFaceTextures() const;
+    bool updateFaceTextures(int mask, QRegion region);
+    void paintFaceTextures(const ScreenPaintData &data);
+    void invalidateFaceTexture(int desktop);
+    void deleteFaceTextures();
     bool loadShader();
+    void loadCapAndReflectionShaders();
     void rotateCube();
     void rotateToDesktop(int desktop);
     void setActive(bool active);
@@ -207,6 +217,7 @@ private:
     bool start;
     bool stop;
     bool reflectionPainting;
+    bool facePainting;
     int rotationDuration;
     int activeScreen;
     bool bottomCap;
@@ -238,6 +249,10 @@ private:
     QMatrix4x4 m_reflectionMatrix;
     QMatrix4x4 m_textureMirrorMatrix;
     GLVertexBuffer *m_cubeCapBuffer;
+    // flat renderings of the desktops used to paint the reflection
+    QVector<GLTexture*> m_faceTextures;
+    QVector<GLRenderTarget*> m_faceTargets;
+    QVector<bool> m_faceDirty;
 
     // Shortcuts - needed to toggle the effect
     QList<QKeySequence> cubeShortcut;
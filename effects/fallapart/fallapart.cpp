@@ -59,7 +59,7 @@ void FallApartEffect::prePaintWindow(EffectWindow* w, WindowPrePaintData& data,
             data.setTransformed();
             w->enablePainting(EffectWindow::PAINT_DISABLED_BY_DELETE);
             // Request the window to be divided into cells
-            data.quads = data.quads.makeGrid(blockSize);
+            data.quads = w->cachedGrid(data.quads, blockSize);
         } else {
             windows.remove(w);
             w->unrefWindow();
@@ -152,7 +152,7 @@ void FallApartEffect::slotWindowClosed(EffectWindow* c)
         return;
     if (!c->isVisible())
         return;
-    const void* e = c->data(WindowClosedGrabRole).value<void*>();
+    const void* e = c->dataPointer(WindowClosedGrabRole);
     if (e && e != this)
         return;
     windows[ c ] = 0;
@@ -165,7 +165,7 @@ void GlideEffect::slotWindowAdded(EffectWindow* w)
     if (!isGlideWindow(w))
         return;
     w->setData(IsGlideWindow, true);
-    const void *addGrab = w->data(WindowAddedGrabRole).value<void*>();
+    const void *addGrab = w->dataPointer(WindowAddedGrabRole);
     if (addGrab && addGrab != this)
         return;
     w->setData(WindowAddedGrabRole, QVariant::fromValue(static_cast<void*>(this)));
@@ -185,7 +185,7 @@ void GlideEffect::slotWindowClosed(EffectWindow* w)
 {
     if (!isGlideWindow(w))
         return;
-    const void *closeGrab = w->data(WindowClosedGrabRole).value<void*>();
+    const void *closeGrab = w->dataPointer(WindowClosedGrabRole);
     if (closeGrab && closeGrab != this)
         return;
     w->refWindow();
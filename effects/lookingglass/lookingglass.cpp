@@ -48,6 +48,7 @@ LookingGlassEffect::LookingGlassEffect()
     , m_shader(NULL)
     , m_enabled(false)
     , m_valid(false)
+    , m_dataLoaded(false)
 {
     QAction* a;
     a = KStandardAction::zoomIn(this, SLOT(zoomIn()), this);
@@ -72,10 +73,7 @@ LookingGlassEffect::LookingGlassEffect()
 
 LookingGlassEffect::~LookingGlassEffect()
 {
-    delete m_texture;
-    delete m_fbo;
-    delete m_shader;
-    delete m_vbo;
+    freeData();
 }
 
 bool LookingGlassEffect::supported()
@@ -89,7 +87,22 @@ void LookingGlassEffect::reconfigure(ReconfigureFlags)
     initialradius = LookingGlassConfig::radius();
     radius = initialradius;
     qCDebug(KWINEFFECTS) << QStringLiteral("Radius from config: %1").arg(radius) << endl;
-    m_valid = loadData();
+    // recreated the next time the looking glass is painted
+    freeData();
+}
+
+void LookingGlassEffect::freeData()
+{
+    delete m_fbo;
+    m_fbo = NULL;
+    delete m_texture;
+    m_texture = NULL;
+    delete m_shader;
+    m_shader = NULL;
+    delete m_vbo;
+    m_vbo = NULL;
+    m_valid = false;
+    m_dataLoaded = false;
 }
 
 bool LookingGlassEffect::loadData()
@@ -218,6 +231,11 @@ void LookingGlassEffect::prePaintScreen(ScreenPrePaintData& data, int time)
 
         effects->addRepaint(cursorPos().x() - radius, cursorPos().y() - radius, 2 * radius, 2 * radius);
     }
+    if (m_enabled && !m_dataLoaded) {
+        // the screen sized texture is not created before the looking glass gets used
+        m_dataLoaded = true;
+        m_valid = loadData();
+    }
     if (m_valid && m_enabled) {
         data.mask |= PAINT_SCREEN_WITH_TRANSFORMED_WINDOWS;
         // Start rendering to texture
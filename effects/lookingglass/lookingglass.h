@@ -65,6 +65,7 @@ public Q_SLOTS:
 
 private:
     bool loadData();
+    void freeData();
     double zoom;
     double target_zoom;
     bool polling; // Mouse polling
@@ -76,6 +77,7 @@ private:
     GLShader *m_shader;
     bool m_enabled;
     bool m_valid;
+    bool m_dataLoaded;
 };
 
 } // namespace
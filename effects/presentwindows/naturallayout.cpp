@@ -0,0 +1,340 @@
+/********************************************************************
+ KWin - the KDE window manager
+ This file is part of the KDE project.
+
+Copyright (C) 2008 Lucas Murray <lmurray@undefinedfire.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+
+#include "naturallayout.h"
+
+#include <algorithm>
+
+namespace KWin
+{
+
+// windows closer than twice this margin are considered to be overlapping
+static const int s_margin = 5;
+
+static inline int floorDiv(int value, int divisor)
+{
+    return value >= 0 ? value / divisor : -((-value + divisor - 1) / divisor);
+}
+
+static inline int heightForWidth(const QRect &geometry, int width)
+{
+    return int((width / double(geometry.width())) * geometry.height());
+}
+
+static inline bool isOverlapping(const QRect &r1, const QRect &r2)
+{
+    return r1.adjusted(-s_margin, -s_margin, s_margin, s_margin).intersects(
+               r2.adjusted(-s_margin, -s_margin, s_margin, s_margin));
+}
+
+/*****************************************************************
+ * NaturalLayout::SpatialHash
+ ****************************************************************/
+
+NaturalLayout::SpatialHash::SpatialHash(int cellSize)
+    : m_cellSize(qMax(cellSize, 1))
+{
+}
+
+QRect NaturalLayout::SpatialHash::cells(const QRect &rect) const
+{
+    // overlapping is tested with a margin on both rects, so a rect needs to be
+    // present in every cell its padded geometry touches
+    const QRect padded = rect.adjusted(-2 * s_margin, -2 * s_margin, 2 * s_margin, 2 * s_margin);
+    return QRect(QPoint(floorDiv(padded.left(), m_cellSize), floorDiv(padded.top(), m_cellSize)),
+                 QPoint(floorDiv(padded.right(), m_cellSize), floorDiv(padded.bottom(), m_cellSize)));
+}
+
+quint64 NaturalLayout::SpatialHash::key(int x, int y)
+{
+    return (quint64(quint32(x)) << 32) | quint64(quint32(y));
+}
+
+void NaturalLayout::SpatialHash::insert(int index, const QRect &rect)
+{
+    const QRect c = cells(rect);
+    for (int x = c.left(); x <= c.right(); ++x) {
+        for (int y = c.top(); y <= c.bottom(); ++y) {
+            m_cells[key(x, y)].append(index);
+        }
+    }
+}
+
+void NaturalLayout::SpatialHash::remove(int index, const QRect &rect)
+{
+    const QRect c = cells(rect);
+    for (int x = c.left(); x <= c.right(); ++x) {
+        for (int y = c.top(); y <= c.bottom(); ++y) {
+            auto it = m_cells.find(key(x, y));
+            if (it == m_cells.end()) {
+                continue;
+            }
+            it->removeOne(index);
+            if (it->isEmpty()) {
+                m_cells.erase(it);
+            }
+        }
+    }
+}
+
+void NaturalLayout::SpatialHash::update(int index, const QRect &oldRect, const QRect &newRect)
+{
+    if (cells(oldRect) == cells(newRect)) {
+        return;
+    }
+    remove(index, oldRect);
+    insert(index, newRect);
+}
+
+void NaturalLayout::SpatialHash::query(const QRect &rect, QVector<int> *result) const
+{
+    result->clear();
+    const QRect c = cells(rect);
+    for (int x = c.left(); x <= c.right(); ++x) {
+        for (int y = c.top(); y <= c.bottom(); ++y) {
+            auto it = m_cells.constFind(key(x, y));
+            if (it != m_cells.constEnd()) {
+                *result << *it;
+            }
+        }
+    }
+    // keep the order of the window list so that the layout is deterministic
+    std::sort(result->begin(), result->end());
+    result->erase(std::unique(result->begin(), result->end()), result->end());
+}
+
+/*****************************************************************
+ * NaturalLayout
+ ****************************************************************/
+
+NaturalLayout::NaturalLayout(const QRect &area, int accuracy, bool fillGaps)
+    : m_area(area)
+    , m_accuracy(accuracy)
+    , m_fillGaps(fillGaps)
+{
+}
+
+bool NaturalLayout::isOverlappingAny(int index, const QVector<QRect> &targets, const SpatialHash &hash,
+                                     const QRegion &border, QVector<int> *candidates) const
+{
+    const QRect &target = targets.at(index);
+    if (border.intersects(target))
+        return true;
+    hash.query(target, candidates);
+    for (int other : *candidates) {
+        if (other == index)
+            continue;
+        if (isOverlapping(target, targets.at(other)))
+            return true;
+    }
+    return false;
+}
+
+QVector<QRect> NaturalLayout::layout(const QVector<QRect> &geometries) const
+{
+    QVector<QRect> targets = geometries;
+    if (geometries.isEmpty())
+        return targets;
+
+    const int count = geometries.count();
+    QRect bounds = m_area;
+    QVector<int> directions(count);
+    qint64 sizeSum = 0;
+    for (int i = 0; i < count; ++i) {
+        bounds = bounds.united(geometries.at(i));
+        sizeSum += qMax(geometries.at(i).width(), geometries.at(i).height());
+        // Reuse the unused "slot" as a preferred direction attribute. This is used when the window
+        // is on the edge of the screen to try to use as much screen real estate as possible.
+        directions[i] = i % 4;
+    }
+    // cells of about the size of an average window keep the number of candidates per query small
+    const int cellSize = qMax(64, int(sizeSum / count));
+
+    SpatialHash hash(cellSize);
+    for (int i = 0; i < count; ++i)
+        hash.insert(i, targets.at(i));
+
+    // Iterate over all windows, if two overlap push them apart _slightly_ as we try to
+    // brute-force the most optimal positions over many iterations.
+    QVector<int> candidates;
+    bool overlap;
+    int iteration = 0;
+    do {
+        overlap = false;
+        for (int w = 0; w < count; ++w) {
+            hash.query(targets.at(w), &candidates);
+            for (int e : candidates) {
+                if (w == e)
+                    continue;
+                QRect *target_w = &targets[w];
+                QRect *target_e = &targets[e];
+                if (!isOverlapping(*target_w, *target_e))
+                    continue;
+                overlap = true;
+                const QRect oldTarget_w = *target_w;
+                const QRect oldTarget_e = *target_e;
+
+                // Determine pushing direction
+                QPoint diff(target_e->center() - target_w->center());
+                // Prevent dividing by zero and non-movement
+                if (diff.x() == 0 && diff.y() == 0)
+                    diff.setX(1);
+                // Approximate a vector of between 10px and 20px in magnitude in the same direction
+                diff *= m_accuracy / double(diff.manhattanLength());
+                // Move both windows apart
+                target_w->translate(-diff);
+                target_e->translate(diff);
+
+                // Try to keep the bounding rect the same aspect as the screen so that more
+                // screen real estate is utilised. We do this by splitting the screen into nine
+                // equal sections, if the window center is in any of the corner sections pull the
+                // window towards the outer corner. If it is in any of the other edge sections
+                // alternate between each corner on that edge. We don't want to determine it
+                // randomly as it will not produce consistant locations when using the filter.
+                // Only move one window so we don't cause large amounts of unnecessary zooming
+                // in some situations. We need to do this even when expanding later just in case
+                // all windows are the same size.
+                // (We are using an old bounding rect for this, hopefully it doesn't matter)
+                int xSection = (target_w->x() - bounds.x()) / (bounds.width() / 3);
+                int ySection = (target_w->y() - bounds.y()) / (bounds.height() / 3);
+                diff = QPoint(0, 0);
+                if (xSection != 1 || ySection != 1) { // Remove this if you want the center to pull as well
+                    if (xSection == 1)
+                        xSection = (directions[w] / 2 ? 2 : 0);
+                    if (ySection == 1)
+                        ySection = (directions[w] % 2 ? 2 : 0);
+                }
+                if (xSection == 0 && ySection == 0)
+                    diff = QPoint(bounds.topLeft() - target_w->center());
+                if (xSection == 2 && ySection == 0)
+                    diff = QPoint(bounds.topRight() - target_w->center());
+                if (xSection == 2 && ySection == 2)
+                    diff = QPoint(bounds.bottomRight() - target_w->center());
+                if (xSection == 0 && ySection == 2)
+                    diff = QPoint(bounds.bottomLeft() - target_w->center());
+                if (diff.x() != 0 || diff.y() != 0) {
+                    diff *= m_accuracy / double(diff.manhattanLength());
+                    target_w->translate(diff);
+                }
+
+                // Update bounding rect
+                bounds = bounds.united(*target_w);
+                bounds = bounds.united(*target_e);
+
+                hash.update(w, oldTarget_w, *target_w);
+                hash.update(e, oldTarget_e, *target_e);
+            }
+        }
+    } while (overlap && ++iteration < maxIterations);
+
+    // Work out scaling by getting the most top-left and most bottom-right window coords.
+    // The 20's and 10's are so that the windows don't touch the edge of the screen.
+    double scale;
+    if (bounds == m_area)
+        scale = 1.0; // Don't add borders to the screen
+    else if (m_area.width() / double(bounds.width()) < m_area.height() / double(bounds.height()))
+        scale = (m_area.width() - 20) / double(bounds.width());
+    else
+        scale = (m_area.height() - 20) / double(bounds.height());
+    // Make bounding rect fill the screen size for later steps
+    bounds = QRect(
+                 bounds.x() - (m_area.width() - 20 - bounds.width() * scale) / 2 - 10 / scale,
+                 bounds.y() - (m_area.height() - 20 - bounds.height() * scale) / 2 - 10 / scale,
+                 m_area.width() / scale,
+                 m_area.height() / scale
+             );
+
+    // Move all windows back onto the screen and set their scale
+    for (QRect &target : targets) {
+        target.setRect((target.x() - bounds.x()) * scale + m_area.x(),
+                       (target.y() - bounds.y()) * scale + m_area.y(),
+                       target.width() * scale,
+                       target.height() * scale
+                       );
+    }
+
+    if (!m_fillGaps)
+        return targets;
+
+    // Try to fill the gaps by enlarging windows if they have the space
+    // Don't expand onto or over the border
+    QRegion borderRegion(m_area.adjusted(-200, -200, 200, 200));
+    borderRegion ^= m_area.adjusted(10 / scale, 10 / scale, -10 / scale, -10 / scale);
+
+    SpatialHash scaledHash(qMax(64, int(cellSize * scale)));
+    for (int i = 0; i < count; ++i)
+        scaledHash.insert(i, targets.at(i));
+
+    bool moved;
+    iteration = 0;
+    do {
+        moved = false;
+        for (int w = 0; w < count; ++w) {
+            QRect *target = &targets[w];
+            const QRect initial = *target;
+            // This may cause some slight distortion if the windows are enlarged a large amount
+            int widthDiff = m_accuracy;
+            int heightDiff = heightForWidth(geometries.at(w), target->width() + widthDiff) - target->height();
+            int xDiff = widthDiff / 2;  // Also move a bit in the direction of the enlarge, allows the
+            int yDiff = heightDiff / 2; // center windows to be enlarged if there is gaps on the side.
+
+            // Attempt enlarging to the top-right, bottom-right, bottom-left and top-left
+            const QPoint offsets[4] = {
+                QPoint(xDiff, -yDiff - heightDiff),
+                QPoint(xDiff, yDiff),
+                QPoint(-xDiff - widthDiff, yDiff),
+                QPoint(-xDiff - widthDiff, -yDiff - heightDiff)
+            };
+            for (const QPoint &offset : offsets) {
+                const QRect oldRect = *target;
+                target->setRect(target->x() + offset.x(),
+                                target->y() + offset.y(),
+                                target->width() + widthDiff,
+                                target->height() + heightDiff
+                                );
+                if (isOverlappingAny(w, targets, scaledHash, borderRegion, &candidates))
+                    *target = oldRect;
+                else
+                    moved = true;
+            }
+            scaledHash.update(w, initial, *target);
+        }
+    } while (moved && ++iteration < maxIterations);
+
+    // The expanding code above can actually enlarge windows over 1.0/2.0 scale, we don't like this
+    // We can't add this to the loop above as it would cause a never-ending loop so we have to make
+    // do with the less-than-optimal space usage with using this method.
+    for (int w = 0; w < count; ++w) {
+        const QRect &geometry = geometries.at(w);
+        QRect *target = &targets[w];
+        double scale = target->width() / double(geometry.width());
+        if (scale > 2.0 || (scale > 1.0 && (geometry.width() > 300 || geometry.height() > 300))) {
+            scale = (geometry.width() > 300 || geometry.height() > 300) ? 1.0 : 2.0;
+            target->setRect(
+                             target->center().x() - int(geometry.width() * scale) / 2,
+                             target->center().y() - int(geometry.height() * scale) / 2,
+                             geometry.width() * scale,
+                             geometry.height() * scale);
+        }
+    }
+    return targets;
+}
+
+} // namespace
@@ -0,0 +1,97 @@
+/********************************************************************
+ KWin - the KDE window manager
+ This file is part of the KDE project.
+
+Copyright (C) 2008 Lucas Murray <lmurray@undefinedfire.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+
+#ifndef KWIN_PRESENTWINDOWS_NATURALLAYOUT_H
+#define KWIN_PRESENTWINDOWS_NATURALLAYOUT_H
+
+#include <QHash>
+#include <QRect>
+#include <QRegion>
+#include <QVector>
+
+namespace KWin
+{
+
+/**
+ * @short Solver for the "natural" layout mode of the Present Windows effect.
+ *
+ * The solver only operates on plain geometries so that it does not depend on
+ * EffectWindow and can be benchmarked standalone. The input geometries are expected
+ * to be sorted in a stable way by the caller, the returned targets are in the same order.
+ *
+ * Overlap detection goes through a spatial hash instead of testing every pair of
+ * windows, which keeps an iteration close to linear in the number of windows. The
+ * number of iterations is bounded by @link maxIterations.
+ **/
+class NaturalLayout
+{
+public:
+    /**
+     * @param area The area the windows have to be laid out in
+     * @param accuracy Distance in pixels windows are moved apart in each step
+     * @param fillGaps Whether windows should be enlarged to fill free space
+     **/
+    NaturalLayout(const QRect &area, int accuracy, bool fillGaps);
+
+    /**
+     * Calculates the target geometries for the windows with the given @p geometries.
+     **/
+    QVector<QRect> layout(const QVector<QRect> &geometries) const;
+
+    /**
+     * Upper bound on the push-apart and gap filling iterations. If the bound is hit
+     * the remaining overlaps are accepted.
+     **/
+    static const int maxIterations = 1000;
+
+private:
+    /**
+     * Buckets target rects by the cells they touch. Each cell is @c m_cellSize pixels
+     * wide and high. Rects have to be updated whenever the target is modified.
+     **/
+    class SpatialHash
+    {
+    public:
+        explicit SpatialHash(int cellSize);
+        void insert(int index, const QRect &rect);
+        void remove(int index, const QRect &rect);
+        void update(int index, const QRect &oldRect, const QRect &newRect);
+        /**
+         * Fills @p result with the sorted, unique indices of rects which might intersect @p rect.
+         **/
+        void query(const QRect &rect, QVector<int> *result) const;
+    private:
+        QRect cells(const QRect &rect) const;
+        static quint64 key(int x, int y);
+        int m_cellSize;
+        QHash<quint64, QVector<int> > m_cells;
+    };
+
+    bool isOverlappingAny(int index, const QVector<QRect> &targets, const SpatialHash &hash,
+                          const QRegion &border, QVector<int> *candidates) const;
+
+    QRect m_area;
+    int m_accuracy;
+    bool m_fillGaps;
+};
+
+} // namespace
+
+#endif
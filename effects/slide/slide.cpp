@@ -280,7 +280,7 @@ bool SlideEffect::shouldForceBackgroundContrast(const EffectWindow *w) const
     // have the background contrast explicitely disabled should be forced on
     // during the slide animation
     const bool bgWindow = (w->hasAlpha() && w->isOnAllDesktops() && (w->isDock() || w->keepAbove()));
-    return bgWindow && (!w->data(WindowForceBackgroundContrastRole).isValid());
+    return bgWindow && (!w->hasData(WindowForceBackgroundContrastRole));
 }
 
 bool SlideEffect::isActive() const
@@ -86,7 +86,7 @@ void SlidingPopupsEffect::prePaintWindow(EffectWindow* w, WindowPrePaintData& da
             delete mAppearingWindows.take(w);
             w->setData(WindowForceBlurRole, false);
             if (m_backgroundContrastForced.contains(w) && w->hasAlpha() &&
-                    w->data(WindowForceBackgroundContrastRole).toBool()) {
+                    w->dataFlag(WindowForceBackgroundContrastRole)) {
                 w->setData(WindowForceBackgroundContrastRole, QVariant());
                 m_backgroundContrastForced.removeAll(w);
             }
@@ -260,7 +260,7 @@ void SlidingPopupsEffect::slotWindowAdded(EffectWindow *w)
 {
     slotPropertyNotify(w, mAtom);
     if (w->isOnCurrentDesktop() && mWindowsData.contains(w)) {
-        if (!w->data(WindowForceBackgroundContrastRole).isValid() && w->hasAlpha()) {
+        if (!w->hasData(WindowForceBackgroundContrastRole) && w->hasAlpha()) {
             w->setData(WindowForceBackgroundContrastRole, QVariant(true));
             m_backgroundContrastForced.append(w);
         }
@@ -287,7 +287,7 @@ void SlidingPopupsEffect::slotWindowClosed(EffectWindow* w)
         // Tell other windowClosed() effects to ignore this window
         w->setData(WindowClosedGrabRole, QVariant::fromValue(static_cast<void*>(this)));
         w->setData(WindowForceBlurRole, true);
-        if (!w->data(WindowForceBackgroundContrastRole).isValid() && w->hasAlpha()) {
+        if (!w->hasData(WindowForceBackgroundContrastRole) && w->hasAlpha()) {
             w->setData(WindowForceBackgroundContrastRole, QVariant(true));
         }
 
@@ -0,0 +1,369 @@
+/*****************************************************************
+ KWin - the KDE window manager
+ This file is part of the KDE project.
+
+Copyright (C) 2008 Cédric Borgese <cedric.borgese@gmail.com>
+
+You can Freely distribute this program under the GNU General Public
+License. See the file "COPYING" for the exact licensing terms.
+******************************************************************/
+
+#include "wobblymesh.h"
+
+#include <math.h>
+#include <string.h>
+
+#if defined(__GNUC__) || defined(__INTEL_COMPILER)
+#  if defined(__SSE2__)
+#    define HAVE_SSE2
+#  endif
+#endif
+
+#ifdef HAVE_SSE2
+#  include <emmintrin.h>
+#endif
+
+namespace KWin
+{
+
+void WobblyMesh::init(const QRectF &geometry)
+{
+    setOrigin(geometry);
+    memcpy(positionX, originX, sizeof(positionX));
+    memcpy(positionY, originY, sizeof(positionY));
+    memset(velocityX, 0, sizeof(velocityX));
+    memset(velocityY, 0, sizeof(velocityY));
+    memset(constraint, 0, sizeof(constraint));
+    canWobbleTop = canWobbleLeft = canWobbleRight = canWobbleBottom = true;
+}
+
+void WobblyMesh::setOrigin(const QRectF &geometry)
+{
+    const qreal xLength = geometry.width() / (Width - 1.0);
+    const qreal yLength = geometry.height() / (Height - 1.0);
+    for (int j = 0; j < Height; ++j) {
+        // the last point is placed on the edge to not accumulate rounding errors
+        const float y = j == Height - 1 ? geometry.y() + geometry.height() : geometry.y() + j * yLength;
+        for (int i = 0; i < Width; ++i) {
+            originX[j * Width + i] = i == Width - 1 ? geometry.x() + geometry.width() : geometry.x() + i * xLength;
+            originY[j * Width + i] = y;
+        }
+    }
+}
+
+namespace
+{
+
+#ifdef HAVE_SSE2
+
+// lane i gets the value of lane i-1, lane 0 keeps its own value
+static inline __m128 leftNeighbour(__m128 v)
+{
+    return _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 1, 0, 0));
+}
+
+// lane i gets the value of lane i+1, lane 3 keeps its own value
+static inline __m128 rightNeighbour(__m128 v)
+{
+    return _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 2, 1));
+}
+
+static inline __m128 select(__m128 mask, __m128 a, __m128 b)
+{
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+static inline __m128 absolute(__m128 v)
+{
+    return _mm_andnot_ps(_mm_set1_ps(-0.0f), v);
+}
+
+static inline float horizontalSum(__m128 v)
+{
+    float lanes[4];
+    _mm_storeu_ps(lanes, v);
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3];
+}
+
+// mirrors fixVectorBounds: values below min snap to 0, values above max are clamped
+static inline __m128 bound(__m128 v, __m128 min, __m128 max)
+{
+    v = _mm_andnot_ps(_mm_cmplt_ps(absolute(v), min), v);
+    return _mm_min_ps(_mm_max_ps(v, _mm_sub_ps(_mm_setzero_ps(), max)), max);
+}
+
+static void computeAcceleration(const WobblyMesh &mesh, float xLength, float yLength, float stiffness,
+                                float *accelerationX, float *accelerationY)
+{
+    const __m128 hasLeft = _mm_setr_ps(0.0f, 1.0f, 1.0f, 1.0f);
+    const __m128 hasRight = _mm_setr_ps(1.0f, 1.0f, 1.0f, 0.0f);
+    const __m128 horizontalCount = _mm_add_ps(hasLeft, hasRight);
+    const __m128 xl = _mm_set1_ps(xLength);
+    const __m128 yl = _mm_set1_ps(yLength);
+    const __m128 k = _mm_set1_ps(stiffness);
+    const __m128 one = _mm_set1_ps(1.0f);
+
+    for (int j = 0; j < WobblyMesh::Height; ++j) {
+        const int row = j * WobblyMesh::Width;
+        const __m128 x = _mm_loadu_ps(mesh.positionX + row);
+        const __m128 y = _mm_loadu_ps(mesh.positionY + row);
+
+        // springs to the left and right neighbour, their rest length is xLength
+        __m128 dx = _mm_add_ps(_mm_sub_ps(leftNeighbour(x), x), _mm_sub_ps(rightNeighbour(x), x));
+        dx = _mm_add_ps(dx, _mm_mul_ps(_mm_sub_ps(hasLeft, hasRight), xl));
+        __m128 dy = _mm_add_ps(_mm_sub_ps(leftNeighbour(y), y), _mm_sub_ps(rightNeighbour(y), y));
+        __m128 count = horizontalCount;
+
+        // springs to the neighbour above and below, their rest length is yLength
+        if (j > 0) {
+            dx = _mm_add_ps(dx, _mm_sub_ps(_mm_loadu_ps(mesh.positionX + row - WobblyMesh::Width), x));
+            dy = _mm_add_ps(dy, _mm_add_ps(_mm_sub_ps(_mm_loadu_ps(mesh.positionY + row - WobblyMesh::Width), y), yl));
+            count = _mm_add_ps(count, one);
+        }
+        if (j < WobblyMesh::Height - 1) {
+            dx = _mm_add_ps(dx, _mm_sub_ps(_mm_loadu_ps(mesh.positionX + row + WobblyMesh::Width), x));
+            dy = _mm_sub_ps(_mm_add_ps(dy, _mm_sub_ps(_mm_loadu_ps(mesh.positionY + row + WobblyMesh::Width), y)), yl);
+            count = _mm_add_ps(count, one);
+        }
+        const __m128 ax = _mm_div_ps(_mm_mul_ps(dx, k), count);
+        const __m128 ay = _mm_div_ps(_mm_mul_ps(dy, k), count);
+
+        // constrained points are only pulled to their origin
+        const __m128 constrained = _mm_cmpneq_ps(_mm_loadu_ps(mesh.constraint + row), _mm_setzero_ps());
+        const __m128 cx = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(mesh.originX + row), x), k);
+        const __m128 cy = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(mesh.originY + row), y), k);
+
+        _mm_storeu_ps(accelerationX + row, select(constrained, cx, ax));
+        _mm_storeu_ps(accelerationY + row, select(constrained, cy, ay));
+    }
+}
+
+// weighted mean of each point with its (up to eight) neighbours, the point itself has the
+// same weight as all neighbours together
+static void heightRingLinearMean(const float *data, float *result)
+{
+    const __m128 hasLeft = _mm_setr_ps(0.0f, 1.0f, 1.0f, 1.0f);
+    const __m128 hasRight = _mm_setr_ps(1.0f, 1.0f, 1.0f, 0.0f);
+    const __m128 horizontalCells = _mm_setr_ps(2.0f, 3.0f, 3.0f, 2.0f);
+
+    __m128 rowSums[WobblyMesh::Height];
+    for (int j = 0; j < WobblyMesh::Height; ++j) {
+        const __m128 v = _mm_loadu_ps(data + j * WobblyMesh::Width);
+        rowSums[j] = _mm_add_ps(v, _mm_add_ps(_mm_mul_ps(leftNeighbour(v), hasLeft),
+                                              _mm_mul_ps(rightNeighbour(v), hasRight)));
+    }
+    for (int j = 0; j < WobblyMesh::Height; ++j) {
+        __m128 box = rowSums[j];
+        float verticalCells = 1.0f;
+        if (j > 0) {
+            box = _mm_add_ps(box, rowSums[j - 1]);
+            verticalCells += 1.0f;
+        }
+        if (j < WobblyMesh::Height - 1) {
+            box = _mm_add_ps(box, rowSums[j + 1]);
+            verticalCells += 1.0f;
+        }
+        const __m128 v = _mm_loadu_ps(data + j * WobblyMesh::Width);
+        const __m128 neighbours = _mm_sub_ps(_mm_mul_ps(horizontalCells, _mm_set1_ps(verticalCells)), _mm_set1_ps(1.0f));
+        // (box - v + neighbours * v) / (2 * neighbours)
+        const __m128 sum = _mm_add_ps(box, _mm_mul_ps(_mm_sub_ps(neighbours, _mm_set1_ps(1.0f)), v));
+        _mm_storeu_ps(result + j * WobblyMesh::Width, _mm_div_ps(sum, _mm_add_ps(neighbours, neighbours)));
+    }
+}
+
+static WobblyMeshEnergy integrate(WobblyMesh &mesh, const float *accelerationX, const float *accelerationY,
+                                  float time, const WobblyMeshParameters &p)
+{
+    const __m128 minAcceleration = _mm_set1_ps(p.minAcceleration);
+    const __m128 maxAcceleration = _mm_set1_ps(p.maxAcceleration);
+    const __m128 minVelocity = _mm_set1_ps(p.minVelocity);
+    const __m128 maxVelocity = _mm_set1_ps(p.maxVelocity);
+    const __m128 t = _mm_set1_ps(time);
+    const __m128 drag = _mm_set1_ps(p.drag);
+    const __m128 move = _mm_set1_ps(time * p.moveFactor);
+
+    // compute the new velocity of each vertex.
+    float velocityX[WobblyMesh::Count];
+    float velocityY[WobblyMesh::Count];
+    __m128 accelerationSum = _mm_setzero_ps();
+    for (int i = 0; i < WobblyMesh::Count; i += 4) {
+        const __m128 ax = bound(_mm_loadu_ps(accelerationX + i), minAcceleration, maxAcceleration);
+        const __m128 ay = bound(_mm_loadu_ps(accelerationY + i), minAcceleration, maxAcceleration);
+        accelerationSum = _mm_add_ps(accelerationSum, _mm_add_ps(absolute(ax), absolute(ay)));
+        _mm_storeu_ps(velocityX + i, _mm_add_ps(_mm_mul_ps(ax, t), _mm_mul_ps(_mm_loadu_ps(mesh.velocityX + i), drag)));
+        _mm_storeu_ps(velocityY + i, _mm_add_ps(_mm_mul_ps(ay, t), _mm_mul_ps(_mm_loadu_ps(mesh.velocityY + i), drag)));
+    }
+
+    heightRingLinearMean(velocityX, mesh.velocityX);
+    heightRingLinearMean(velocityY, mesh.velocityY);
+
+    // compute the new pos of each vertex.
+    __m128 velocitySum = _mm_setzero_ps();
+    for (int i = 0; i < WobblyMesh::Count; i += 4) {
+        const __m128 vx = bound(_mm_loadu_ps(mesh.velocityX + i), minVelocity, maxVelocity);
+        const __m128 vy = bound(_mm_loadu_ps(mesh.velocityY + i), minVelocity, maxVelocity);
+        _mm_storeu_ps(mesh.velocityX + i, vx);
+        _mm_storeu_ps(mesh.velocityY + i, vy);
+        _mm_storeu_ps(mesh.positionX + i, _mm_add_ps(_mm_loadu_ps(mesh.positionX + i), _mm_mul_ps(vx, move)));
+        _mm_storeu_ps(mesh.positionY + i, _mm_add_ps(_mm_loadu_ps(mesh.positionY + i), _mm_mul_ps(vy, move)));
+        velocitySum = _mm_add_ps(velocitySum, _mm_add_ps(absolute(vx), absolute(vy)));
+    }
+
+    const WobblyMeshEnergy energy = { horizontalSum(accelerationSum), horizontalSum(velocitySum) };
+    return energy;
+}
+
+#else
+
+static inline float bound(float v, float min, float max)
+{
+    if (fabs(v) < min) {
+        return 0.0f;
+    } else if (fabs(v) > max) {
+        return v > 0.0f ? max : -max;
+    }
+    return v;
+}
+
+static void computeAcceleration(const WobblyMesh &mesh, float xLength, float yLength, float stiffness,
+                                float *accelerationX, float *accelerationY)
+{
+    for (int j = 0; j < WobblyMesh::Height; ++j) {
+        for (int i = 0; i < WobblyMesh::Width; ++i) {
+            const int index = j * WobblyMesh::Width + i;
+            const float x = mesh.positionX[index];
+            const float y = mesh.positionY[index];
+            if (mesh.constraint[index] != 0.0f) {
+                accelerationX[index] = (mesh.originX[index] - x) * stiffness;
+                accelerationY[index] = (mesh.originY[index] - y) * stiffness;
+                continue;
+            }
+            float dx = 0.0f;
+            float dy = 0.0f;
+            int count = 0;
+            if (i > 0) {
+                dx += mesh.positionX[index - 1] - x + xLength;
+                dy += mesh.positionY[index - 1] - y;
+                ++count;
+            }
+            if (i < WobblyMesh::Width - 1) {
+                dx += mesh.positionX[index + 1] - x - xLength;
+                dy += mesh.positionY[index + 1] - y;
+                ++count;
+            }
+            if (j > 0) {
+                dx += mesh.positionX[index - WobblyMesh::Width] - x;
+                dy += mesh.positionY[index - WobblyMesh::Width] - y + yLength;
+                ++count;
+            }
+            if (j < WobblyMesh::Height - 1) {
+                dx += mesh.positionX[index + WobblyMesh::Width] - x;
+                dy += mesh.positionY[index + WobblyMesh::Width] - y - yLength;
+                ++count;
+            }
+            accelerationX[index] = dx * stiffness / count;
+            accelerationY[index] = dy * stiffness / count;
+        }
+    }
+}
+
+// weighted mean of each point with its (up to eight) neighbours, the point itself has the
+// same weight as all neighbours together
+static void heightRingLinearMean(const float *data, float *result)
+{
+    for (int j = 0; j < WobblyMesh::Height; ++j) {
+        for (int i = 0; i < WobblyMesh::Width; ++i) {
+            float sum = 0.0f;
+            int count = 0;
+            for (int y = qMax(j - 1, 0); y <= qMin(j + 1, int(WobblyMesh::Height) - 1); ++y) {
+                for (int x = qMax(i - 1, 0); x <= qMin(i + 1, int(WobblyMesh::Width) - 1); ++x) {
+                    if (x == i && y == j) {
+                        continue;
+                    }
+                    sum += data[y * WobblyMesh::Width + x];
+                    ++count;
+                }
+            }
+            const float v = data[j * WobblyMesh::Width + i];
+            result[j * WobblyMesh::Width + i] = (sum + count * v) / (2.0f * count);
+        }
+    }
+}
+
+static WobblyMeshEnergy integrate(WobblyMesh &mesh, const float *accelerationX, const float *accelerationY,
+                                  float time, const WobblyMeshParameters &p)
+{
+    // compute the new velocity of each vertex.
+    float velocityX[WobblyMesh::Count];
+    float velocityY[WobblyMesh::Count];
+    WobblyMeshEnergy energy = { 0.0f, 0.0f };
+    for (int i = 0; i < WobblyMesh::Count; ++i) {
+        const float ax = bound(accelerationX[i], p.minAcceleration, p.maxAcceleration);
+        const float ay = bound(accelerationY[i], p.minAcceleration, p.maxAcceleration);
+        energy.acceleration += fabs(ax) + fabs(ay);
+        velocityX[i] = ax * time + mesh.velocityX[i] * p.drag;
+        velocityY[i] = ay * time + mesh.velocityY[i] * p.drag;
+    }
+
+    heightRingLinearMean(velocityX, mesh.velocityX);
+    heightRingLinearMean(velocityY, mesh.velocityY);
+
+    // compute the new pos of each vertex.
+    for (int i = 0; i < WobblyMesh::Count; ++i) {
+        const float vx = bound(mesh.velocityX[i], p.minVelocity, p.maxVelocity);
+        const float vy = bound(mesh.velocityY[i], p.minVelocity, p.maxVelocity);
+        mesh.velocityX[i] = vx;
+        mesh.velocityY[i] = vy;
+        mesh.positionX[i] += vx * time * p.moveFactor;
+        mesh.positionY[i] += vy * time * p.moveFactor;
+        energy.velocity += fabs(vx) + fabs(vy);
+    }
+    return energy;
+}
+
+#endif
+
+static void applyWobbleRestrictions(WobblyMesh &mesh)
+{
+    for (int j = 0; j < WobblyMesh::Height; ++j) {
+        for (int i = 0; i < WobblyMesh::Width; ++i) {
+            const int index = j * WobblyMesh::Width + i;
+            if ((!mesh.canWobbleTop && j < WobblyMesh::Height - 1) ||
+                    (!mesh.canWobbleBottom && j > 0)) {
+                mesh.positionY[index] = mesh.originY[index];
+            }
+            if ((!mesh.canWobbleLeft && i < WobblyMesh::Width - 1) ||
+                    (!mesh.canWobbleRight && i > 0)) {
+                mesh.positionX[index] = mesh.originX[index];
+            }
+        }
+    }
+}
+
+} // namespace
+
+void WobblyMesh::step(WobblyMesh *meshes, const QRectF *geometries, int count, float time,
+                      const WobblyMeshParameters &parameters, WobblyMeshEnergy *energies)
+{
+    float accelerationX[Count];
+    float accelerationY[Count];
+    float smoothedX[Count];
+    float smoothedY[Count];
+    for (int i = 0; i < count; ++i) {
+        WobblyMesh &mesh = meshes[i];
+        const QRectF &geometry = geometries[i];
+        mesh.setOrigin(geometry);
+
+        computeAcceleration(mesh, geometry.width() / (Width - 1.0), geometry.height() / (Height - 1.0),
+                            parameters.stiffness, accelerationX, accelerationY);
+        heightRingLinearMean(accelerationX, smoothedX);
+        heightRingLinearMean(accelerationY, smoothedY);
+        energies[i] = integrate(mesh, smoothedX, smoothedY, time, parameters);
+
+        if (!mesh.canWobbleTop || !mesh.canWobbleBottom || !mesh.canWobbleLeft || !mesh.canWobbleRight) {
+            applyWobbleRestrictions(mesh);
+        }
+    }
+}
+
+} // namespace KWin
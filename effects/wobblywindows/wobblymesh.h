@@ -0,0 +1,91 @@
+/*****************************************************************
+ KWin - the KDE window manager
+ This file is part of the KDE project.
+
+Copyright (C) 2008 Cédric Borgese <cedric.borgese@gmail.com>
+
+You can Freely distribute this program under the GNU General Public
+License. See the file "COPYING" for the exact licensing terms.
+******************************************************************/
+
+#ifndef KWIN_WOBBLYMESH_H
+#define KWIN_WOBBLYMESH_H
+
+#include <QRectF>
+
+namespace KWin
+{
+
+/**
+ * Parameters of the spring model, see WobblyWindowsEffect for their meaning.
+ **/
+struct WobblyMeshParameters {
+    float stiffness;
+    float drag;
+    float moveFactor;
+    float minVelocity;
+    float maxVelocity;
+    float minAcceleration;
+    float maxAcceleration;
+};
+
+/**
+ * Sum of the absolute acceleration and velocity of all points of a mesh after a step.
+ * A mesh with both values below the stop thresholds came to rest.
+ **/
+struct WobblyMeshEnergy {
+    float acceleration;
+    float velocity;
+};
+
+/**
+ * @short The 4x4 spring mesh of one wobbly window.
+ *
+ * The mesh is stored as structure of arrays, one float array per component. Each group of
+ * four consecutive floats is one row of the mesh, which allows the solver to process a
+ * whole row in one SSE register.
+ **/
+struct WobblyMesh {
+    enum {
+        Width = 4,
+        Height = 4,
+        Count = Width * Height
+    };
+
+    float originX[Count];
+    float originY[Count];
+    float positionX[Count];
+    float positionY[Count];
+    float velocityX[Count];
+    float velocityY[Count];
+    // if non zero, the physics system moves this point based only on it "normal" destination
+    // given by the window position, ignoring neighbour points.
+    float constraint[Count];
+
+    // for resizing. Only sides that have moved will wobble
+    bool canWobbleTop;
+    bool canWobbleLeft;
+    bool canWobbleRight;
+    bool canWobbleBottom;
+
+    /**
+     * Puts the mesh at rest on @p geometry and removes all constraints.
+     **/
+    void init(const QRectF &geometry);
+    /**
+     * Updates the rest position of all points to @p geometry.
+     **/
+    void setOrigin(const QRectF &geometry);
+
+    /**
+     * Advances @p count meshes by @p time milliseconds in one batch. The rest position of
+     * mesh @c i is taken from @p geometries[i] and its energy after the step is written to
+     * @p energies[i].
+     **/
+    static void step(WobblyMesh *meshes, const QRectF *geometries, int count, float time,
+                     const WobblyMeshParameters &parameters, WobblyMeshEnergy *energies);
+};
+
+} // namespace KWin
+
+#endif
@@ -21,19 +21,11 @@ License. See the file "COPYING" for the exact licensing terms.
 #define ASSERT1
 #endif
 
-//#define COMPUTE_STATS
-
 // if you enable it and run kwin in a terminal from the session it manages,
 // be sure to redirect the output of kwin in a file or
 // you'll propably get deadlocks.
 //#define VERBOSE_MODE
 
-#if defined COMPUTE_STATS && !defined VERBOSE_MODE
-#   ifdef __GNUC__
-#       warning "You enable COMPUTE_STATS without VERBOSE_MODE, computed stats will not be printed."
-#   endif
-#endif
-
 namespace KWin
 {
 
@@ -145,6 +137,9 @@ static const ParameterSet set_4 = {
 static const ParameterSet pset[5] = { set_0, set_1, set_2, set_3, set_4 };
 
 WobblyWindowsEffect::WobblyWindowsEffect()
+    : m_visitedMeshes(0)
+    , m_meshesStepped(true)
+    , m_stepTime(0)
 {
     reconfigure(ReconfigureAll);
     connect(effects, SIGNAL(windowAdded(KWin::EffectWindow*)), this, SLOT(slotWindowAdded(KWin::EffectWindow*)));
@@ -161,10 +156,9 @@ WobblyWindowsEffect::~WobblyWindowsEffect()
         // we should be empty at this point...
         // emit a warning and clean the list.
         qCDebug(KWINEFFECTS) << "Windows list not empty. Left items : " << windows.count();
-        QHash< const EffectWindow*,  WindowWobblyInfos >::iterator i;
-        for (i = windows.begin(); i != windows.end(); ++i) {
-            freeWobblyInfo(i.value());
-        }
+        windows.clear();
+        m_meshes.clear();
+        m_meshWindows.clear();
     }
 }
 
@@ -275,26 +269,24 @@ void WobblyWindowsEffect::prePaintScreen(ScreenPrePaintData& data, int time)
         m_updateRegion = QRegion();
     }
 
+    // the meshes are advanced once the visited windows are known, see paintWindow
+    m_stepTime = time;
+    m_visitedMeshes = 0;
+    m_meshesStepped = false;
+
     effects->prePaintScreen(data, time);
 }
-const qreal maxTime = 10.0;
+
 void WobblyWindowsEffect::prePaintWindow(EffectWindow* w, WindowPrePaintData& data, int time)
 {
-    if (windows.contains(w)) {
+    auto it = windows.constFind(w);
+    if (it != windows.constEnd()) {
         data.setTransformed();
-        data.quads = data.quads.makeRegularGrid(m_xTesselation, m_yTesselation);
-        bool stop = false;
-        qreal updateTime = time;
-
-        while (!stop && (updateTime > maxTime)) {
-#if defined VERBOSE_MODE
-            qCDebug(KWINEFFECTS) << "loop time " << updateTime << " / " << time;
-#endif
-            stop = !updateWindowWobblyDatas(w, maxTime);
-            updateTime -= maxTime;
-        }
-        if (!stop && updateTime > 0) {
-            updateWindowWobblyDatas(w, updateTime);
+        data.quads = w->cachedRegularGrid(data.quads, m_xTesselation, m_yTesselation);
+        // gather the meshes of the painted windows at the front so they can be stepped in one batch
+        if (it->mesh >= m_visitedMeshes) {
+            swapMeshes(it->mesh, m_visitedMeshes);
+            ++m_visitedMeshes;
         }
     }
 
@@ -303,8 +295,22 @@ void WobblyWindowsEffect::prePaintWindow(EffectWindow* w, WindowPrePaintData& da
 
 void WobblyWindowsEffect::paintWindow(EffectWindow* w, int mask, QRegion region, WindowPaintData& data)
 {
+    if (!m_meshesStepped) {
+        m_meshesStepped = true;
+        const qreal maxTime = 10.0;
+        qreal updateTime = m_stepTime;
+        while (m_visitedMeshes > 0 && updateTime > 0) {
+#if defined VERBOSE_MODE
+            qCDebug(KWINEFFECTS) << "loop time " << updateTime << " / " << m_stepTime;
+#endif
+            const qreal stepTime = qMin(updateTime, maxTime);
+            stepWindows(stepTime);
+            updateTime -= stepTime;
+        }
+    }
+
     if (windows.contains(w)) {
-        WindowWobblyInfos& wwi = windows[w];
+        const WobblyMesh& mesh = m_meshes.at(windows[w].mesh);
         int tx = w->geometry().x();
         int ty = w->geometry().y();
         double left = 0.0;
@@ -315,7 +321,7 @@ void WobblyWindowsEffect::paintWindow(EffectWindow* w, int mask, QRegion region,
             for (int j = 0; j < 4; ++j) {
                 WindowVertex& v = data.quads[i][j];
                 Pair oldPos = {tx + v.x(), ty + v.y()};
-                Pair newPos = computeBezierPoint(wwi, oldPos);
+                Pair newPos = computeBezierPoint(mesh, oldPos);
                 v.move(newPos.x - tx, newPos.y - ty);
             }
             left   = qMin(left,   data.quads[i].left());
@@ -354,26 +360,14 @@ void WobblyWindowsEffect::slotWindowStartUserMovedResized(EffectWindow *w)
 void WobblyWindowsEffect::slotWindowStepUserMovedResized(EffectWindow *w, const QRect &geometry)
 {
     Q_UNUSED(geometry)
-    if (windows.contains(w)) {
-        WindowWobblyInfos& wwi = windows[w];
-        QRect rect = w->geometry();
-        if (rect.y() != wwi.resize_original_rect.y()) wwi.can_wobble_top = true;
-        if (rect.x() != wwi.resize_original_rect.x()) wwi.can_wobble_left = true;
-        if (rect.right() != wwi.resize_original_rect.right()) wwi.can_wobble_right = true;
-        if (rect.bottom() != wwi.resize_original_rect.bottom()) wwi.can_wobble_bottom = true;
-    }
+    updateCanWobble(w);
 }
 
 void WobblyWindowsEffect::slotWindowFinishUserMovedResized(EffectWindow *w)
 {
     if (windows.contains(w)) {
-        WindowWobblyInfos& wwi = windows[w];
-        wwi.status = Free;
-        QRect rect = w->geometry();
-        if (rect.y() != wwi.resize_original_rect.y()) wwi.can_wobble_top = true;
-        if (rect.x() != wwi.resize_original_rect.x()) wwi.can_wobble_left = true;
-        if (rect.right() != wwi.resize_original_rect.right()) wwi.can_wobble_right = true;
-        if (rect.bottom() != wwi.resize_original_rect.bottom()) wwi.can_wobble_bottom = true;
+        windows[w].status = Free;
+        updateCanWobble(w);
     }
 }
 
@@ -388,54 +382,60 @@ void WobblyWindowsEffect::slotWindowMaximizeStateChanged(EffectWindow *w, bool h
         stepMovedResized(w);
     }
 
-    if (windows.contains(w)) {
-        WindowWobblyInfos& wwi = windows[w];
-        QRect rect = w->geometry();
-        if (rect.y() != wwi.resize_original_rect.y()) wwi.can_wobble_top = true;
-        if (rect.x() != wwi.resize_original_rect.x()) wwi.can_wobble_left = true;
-        if (rect.right() != wwi.resize_original_rect.right()) wwi.can_wobble_right = true;
-        if (rect.bottom() != wwi.resize_original_rect.bottom()) wwi.can_wobble_bottom = true;
+    updateCanWobble(w);
+}
+
+void WobblyWindowsEffect::updateCanWobble(EffectWindow* w)
+{
+    if (!windows.contains(w)) {
+        return;
     }
+    const WindowWobblyInfos& wwi = windows[w];
+    WobblyMesh& mesh = m_meshes[wwi.mesh];
+    QRect rect = w->geometry();
+    if (rect.y() != wwi.resize_original_rect.y()) mesh.canWobbleTop = true;
+    if (rect.x() != wwi.resize_original_rect.x()) mesh.canWobbleLeft = true;
+    if (rect.right() != wwi.resize_original_rect.right()) mesh.canWobbleRight = true;
+    if (rect.bottom() != wwi.resize_original_rect.bottom()) mesh.canWobbleBottom = true;
 }
 
 void WobblyWindowsEffect::startMovedResized(EffectWindow* w)
 {
     if (!windows.contains(w)) {
-        WindowWobblyInfos new_wwi;
-        initWobblyInfo(new_wwi, w->geometry());
-        windows[w] = new_wwi;
+        addWindow(w, w->geometry());
     }
 
     WindowWobblyInfos& wwi = windows[w];
+    WobblyMesh& mesh = m_meshes[wwi.mesh];
     wwi.status = Moving;
     const QRectF& rect = w->geometry();
 
-    qreal x_increment = rect.width() / (wwi.width - 1.0);
-    qreal y_increment = rect.height() / (wwi.height - 1.0);
+    qreal x_increment = rect.width() / (WobblyMesh::Width - 1.0);
+    qreal y_increment = rect.height() / (WobblyMesh::Height - 1.0);
 
     Pair picked = {static_cast<qreal>(cursorPos().x()), static_cast<qreal>(cursorPos().y())};
     int indx = (picked.x - rect.x()) / x_increment + 0.5;
     int indy = (picked.y - rect.y()) / y_increment + 0.5;
-    int pickedPointIndex = indy * wwi.width + indx;
+    int pickedPointIndex = indy * WobblyMesh::Width + indx;
     if (pickedPointIndex < 0) {
         qCDebug(KWINEFFECTS) << "Picked index == " << pickedPointIndex << " with (" << cursorPos().x() << "," << cursorPos().y() << ")";
         pickedPointIndex = 0;
-    } else if (static_cast<unsigned int>(pickedPointIndex) > wwi.count - 1) {
+    } else if (pickedPointIndex > WobblyMesh::Count - 1) {
         qCDebug(KWINEFFECTS) << "Picked index == " << pickedPointIndex << " with (" << cursorPos().x() << "," << cursorPos().y() << ")";
-        pickedPointIndex = wwi.count - 1;
+        pickedPointIndex = WobblyMesh::Count - 1;
     }
 #if defined VERBOSE_MODE
     qCDebug(KWINEFFECTS) << "Original Picked point -- x : " << picked.x << " - y : " << picked.y;
 #endif
-    wwi.constraint[pickedPointIndex] = true;
+    mesh.constraint[pickedPointIndex] = 1.0f;
 
     if (w->isUserResize()) {
         // on a resize, do not allow any edges to wobble until it has been moved from
         // its original location
-        wwi.can_wobble_top = wwi.can_wobble_left = wwi.can_wobble_right = wwi.can_wobble_bottom = false;
+        mesh.canWobbleTop = mesh.canWobbleLeft = mesh.canWobbleRight = mesh.canWobbleBottom = false;
         wwi.resize_original_rect = w->geometry();
     } else {
-        wwi.can_wobble_top = wwi.can_wobble_left = wwi.can_wobble_right = wwi.can_wobble_bottom = true;
+        mesh.canWobbleTop = mesh.canWobbleLeft = mesh.canWobbleRight = mesh.canWobbleBottom = true;
     }
 }
 
@@ -443,45 +443,41 @@ void WobblyWindowsEffect::stepMovedResized(EffectWindow* w)
 {
     QRect new_geometry = w->geometry();
     if (!windows.contains(w)) {
-        WindowWobblyInfos new_wwi;
-        initWobblyInfo(new_wwi, new_geometry);
-        windows[w] = new_wwi;
+        addWindow(w, new_geometry);
     }
 
     WindowWobblyInfos& wwi = windows[w];
+    WobblyMesh& mesh = m_meshes[wwi.mesh];
     wwi.status = Free;
 
     QRect maximized_area = effects->clientArea(MaximizeArea, w);
     bool throb_direction_out = (new_geometry.top() == maximized_area.top() && new_geometry.bottom() == maximized_area.bottom()) ||
                                (new_geometry.left() == maximized_area.left() && new_geometry.right() == maximized_area.right());
     qreal magnitude = throb_direction_out ? 10 : -30; // a small throb out when maximized, a larger throb inwards when restored
-    for (unsigned int j = 0; j < wwi.height; ++j) {
-        for (unsigned int i = 0; i < wwi.width; ++i) {
-            Pair v = { magnitude*(i / qreal(wwi.width - 1) - 0.5), magnitude*(j / qreal(wwi.height - 1) - 0.5) };
-            wwi.velocity[j*wwi.width+i] = v;
+    for (int j = 0; j < WobblyMesh::Height; ++j) {
+        for (int i = 0; i < WobblyMesh::Width; ++i) {
+            mesh.velocityX[j*WobblyMesh::Width+i] = magnitude*(i / qreal(WobblyMesh::Width - 1) - 0.5);
+            mesh.velocityY[j*WobblyMesh::Width+i] = magnitude*(j / qreal(WobblyMesh::Height - 1) - 0.5);
         }
     }
 
     // constrain the middle of the window, so that any asymetry wont cause it to drift off-center
-    for (unsigned int j = 1; j < wwi.height - 1; ++j) {
-        for (unsigned int i = 1; i < wwi.width - 1; ++i) {
-            wwi.constraint[j*wwi.width+i] = true;
+    for (int j = 1; j < WobblyMesh::Height - 1; ++j) {
+        for (int i = 1; i < WobblyMesh::Width - 1; ++i) {
+            mesh.constraint[j*WobblyMesh::Width+i] = 1.0f;
         }
     }
 }
 
 void WobblyWindowsEffect::slotWindowAdded(EffectWindow* w)
 {
-    if (m_openEffectEnabled && w->data(WindowAddedGrabRole).value<void*>() != this) {
+    if (m_openEffectEnabled && w->dataPointer(WindowAddedGrabRole) != this) {
         if (windows.contains(w)) {
             // could this happen ??
             WindowWobblyInfos& wwi = windows[w];
             wobblyOpenInit(wwi);
         } else {
-            WindowWobblyInfos new_wwi;
-            initWobblyInfo(new_wwi, w->geometry());
-            wobblyOpenInit(new_wwi);
-            windows[w] = new_wwi;
+            wobblyOpenInit(addWindow(w, w->geometry()));
         }
     }
 }
@@ -494,37 +490,29 @@ void WobblyWindowsEffect::slotWindowClosed(EffectWindow* w)
             wobblyCloseInit(wwi, w);
             w->refWindow();
         } else {
-            freeWobblyInfo(wwi);
-            windows.remove(w);
-            if (windows.isEmpty())
-                effects->addRepaintFull();
+            removeWindow(w);
         }
-    } else if (m_closeEffectEnabled  && w->data(WindowAddedGrabRole).value<void*>() != this) {
-        WindowWobblyInfos new_wwi;
-        initWobblyInfo(new_wwi, w->geometry());
-        wobblyCloseInit(new_wwi, w);
-        windows[w] = new_wwi;
+    } else if (m_closeEffectEnabled  && w->dataPointer(WindowAddedGrabRole) != this) {
+        wobblyCloseInit(addWindow(w, w->geometry()), w);
         w->refWindow();
     }
 }
 
-void WobblyWindowsEffect::wobblyOpenInit(WindowWobblyInfos& wwi) const
+void WobblyWindowsEffect::wobblyOpenInit(WindowWobblyInfos& wwi)
 {
-    Pair middle = { (wwi.origin[0].x + wwi.origin[15].x) / 2, (wwi.origin[0].y + wwi.origin[15].y) / 2 };
+    WobblyMesh& mesh = m_meshes[wwi.mesh];
+    Pair middle = { (mesh.originX[0] + mesh.originX[15]) / 2, (mesh.originY[0] + mesh.originY[15]) / 2 };
 
-    for (unsigned int j = 0; j < 4; ++j) {
-        for (unsigned int i = 0; i < 4; ++i) {
-            unsigned int idx = j * 4 + i;
-            wwi.constraint[idx] = false;
-            wwi.position[idx].x = (wwi.position[idx].x + 3 * middle.x) / 4;
-            wwi.position[idx].y = (wwi.position[idx].y + 3 * middle.y) / 4;
-        }
+    for (int idx = 0; idx < WobblyMesh::Count; ++idx) {
+        mesh.constraint[idx] = 0.0f;
+        mesh.positionX[idx] = (mesh.positionX[idx] + 3 * middle.x) / 4;
+        mesh.positionY[idx] = (mesh.positionY[idx] + 3 * middle.y) / 4;
     }
     wwi.status = Openning;
-    wwi.can_wobble_top = wwi.can_wobble_left = wwi.can_wobble_right = wwi.can_wobble_bottom = true;
+    mesh.canWobbleTop = mesh.canWobbleLeft = mesh.canWobbleRight = mesh.canWobbleBottom = true;
 }
 
-void WobblyWindowsEffect::wobblyCloseInit(WindowWobblyInfos& wwi, EffectWindow* w) const
+void WobblyWindowsEffect::wobblyCloseInit(WindowWobblyInfos& wwi, EffectWindow* w)
 {
     const QRectF& rect = w->geometry();
     QPointF center = rect.center();
@@ -535,101 +523,80 @@ void WobblyWindowsEffect::wobblyCloseInit(WindowWobblyInfos& wwi, EffectWindow*
     wwi.closeRect.setCoords(x1, y1, x2, y2);
 
     // for closing, not yet used...
-    for (unsigned int j = 0; j < 4; ++j) {
-        for (unsigned int i = 0; i < 4; ++i) {
-            unsigned int idx = j * 4 + i;
-            wwi.constraint[idx] = false;
-        }
+    WobblyMesh& mesh = m_meshes[wwi.mesh];
+    for (int idx = 0; idx < WobblyMesh::Count; ++idx) {
+        mesh.constraint[idx] = 0.0f;
     }
     wwi.status = Closing;
 }
 
-void WobblyWindowsEffect::initWobblyInfo(WindowWobblyInfos& wwi, QRect geometry) const
+WobblyWindowsEffect::WindowWobblyInfos& WobblyWindowsEffect::addWindow(EffectWindow* w, const QRect& geometry)
 {
-    wwi.count = 4 * 4;
-    wwi.width = 4;
-    wwi.height = 4;
-
-    wwi.bezierWidth = m_xTesselation;
-    wwi.bezierHeight = m_yTesselation;
-    wwi.bezierCount = m_xTesselation * m_yTesselation;
-
-    wwi.origin = new Pair[wwi.count];
-    wwi.position = new Pair[wwi.count];
-    wwi.velocity = new Pair[wwi.count];
-    wwi.acceleration = new Pair[wwi.count];
-    wwi.buffer = new Pair[wwi.count];
-    wwi.constraint = new bool[wwi.count];
-
-    wwi.bezierSurface = new Pair[wwi.bezierCount];
+    WobblyMesh mesh;
+    mesh.init(geometry);
+    m_meshes.append(mesh);
+    m_meshWindows.append(w);
 
+    WindowWobblyInfos& wwi = windows[w];
+    wwi.mesh = m_meshes.count() - 1;
     wwi.status = Moving;
+    return wwi;
+}
 
-    qreal x = geometry.x(), y = geometry.y();
-    qreal width = geometry.width(), height = geometry.height();
+void WobblyWindowsEffect::removeWindow(const EffectWindow* w)
+{
+    auto it = windows.find(w);
+    if (it == windows.end()) {
+        return;
+    }
+    int index = it->mesh;
+    windows.erase(it);
 
-    Pair initValue = {x, y};
-    static const Pair nullPair = {0.0, 0.0};
+    // keep the meshes visited in this frame in front of the others
+    if (index < m_visitedMeshes) {
+        --m_visitedMeshes;
+        moveMesh(m_visitedMeshes, index);
+        index = m_visitedMeshes;
+    }
+    // keep the meshes packed by moving the last one into the free slot
+    moveMesh(m_meshes.count() - 1, index);
+    m_meshes.removeLast();
+    m_meshWindows.removeLast();
 
-    qreal x_increment = width / (wwi.width - 1.0);
-    qreal y_increment = height / (wwi.height - 1.0);
+    if (windows.isEmpty())
+        effects->addRepaintFull();
+}
 
-    for (unsigned int j = 0; j < 4; ++j) {
-        for (unsigned int i = 0; i < 4; ++i) {
-            unsigned int idx = j * 4 + i;
-            wwi.origin[idx] = initValue;
-            wwi.position[idx] = initValue;
-            wwi.velocity[idx] = nullPair;
-            wwi.constraint[idx] = false;
-            if (i != 4 - 2) { // x grid count - 2, i.e. not the last point
-                initValue.x += x_increment;
-            } else {
-                initValue.x = width + x;
-            }
-            initValue.x = initValue.x;
-        }
-        initValue.x = x;
-        initValue.x = initValue.x;
-        if (j != 4 - 2) { // y grid count - 2, i.e. not the last point
-            initValue.y += y_increment;
-        } else {
-            initValue.y = height + y;
-        }
-        initValue.y = initValue.y;
+void WobblyWindowsEffect::moveMesh(int from, int to)
+{
+    if (from == to) {
+        return;
     }
+    m_meshes[to] = m_meshes.at(from);
+    m_meshWindows[to] = m_meshWindows.at(from);
+    windows[m_meshWindows.at(to)].mesh = to;
 }
 
-void WobblyWindowsEffect::freeWobblyInfo(WindowWobblyInfos& wwi) const
+void WobblyWindowsEffect::swapMeshes(int a, int b)
 {
-    delete[] wwi.origin;
-    delete[] wwi.position;
-    delete[] wwi.velocity;
-    delete[] wwi.acceleration;
-    delete[] wwi.buffer;
-    delete[] wwi.constraint;
-
-    delete[] wwi.bezierSurface;
+    if (a == b) {
+        return;
+    }
+    qSwap(m_meshes[a], m_meshes[b]);
+    qSwap(m_meshWindows[a], m_meshWindows[b]);
+    windows[m_meshWindows.at(a)].mesh = a;
+    windows[m_meshWindows.at(b)].mesh = b;
 }
 
-WobblyWindowsEffect::Pair WobblyWindowsEffect::computeBezierPoint(const WindowWobblyInfos& wwi, Pair point) const
+WobblyWindowsEffect::Pair WobblyWindowsEffect::computeBezierPoint(const WobblyMesh& mesh, Pair point) const
 {
     // compute the input value
-    Pair topleft = wwi.origin[0];
-    Pair bottomright = wwi.origin[wwi.count-1];
-
-//    ASSERT1(point.x >= topleft.x);
-//    ASSERT1(point.y >= topleft.y);
-//    ASSERT1(point.x <= bottomright.x);
-//    ASSERT1(point.y <= bottomright.y);
+    Pair topleft = { mesh.originX[0], mesh.originY[0] };
+    Pair bottomright = { mesh.originX[WobblyMesh::Count-1], mesh.originY[WobblyMesh::Count-1] };
 
     qreal tx = (point.x - topleft.x) / (bottomright.x - topleft.x);
     qreal ty = (point.y - topleft.y) / (bottomright.y - topleft.y);
 
-//    ASSERT1(tx >= 0);
-//    ASSERT1(tx <= 1);
-//    ASSERT1(ty >= 0);
-//    ASSERT1(ty <= 1);
-
     // compute polynomial coeff
 
     qreal px[4];
@@ -649,555 +616,51 @@ WobblyWindowsEffect::Pair WobblyWindowsEffect::computeBezierPoint(const WindowWo
     for (unsigned int j = 0; j < 4; ++j) {
         for (unsigned int i = 0; i < 4; ++i) {
             // this assume the grid is 4*4
-            res.x += px[i] * py[j] * wwi.position[i + j * wwi.width].x;
-            res.y += px[i] * py[j] * wwi.position[i + j * wwi.width].y;
+            res.x += px[i] * py[j] * mesh.positionX[i + j * WobblyMesh::Width];
+            res.y += px[i] * py[j] * mesh.positionY[i + j * WobblyMesh::Width];
         }
     }
 
     return res;
 }
 
-namespace
-{
-
-static inline void fixVectorBounds(WobblyWindowsEffect::Pair& vec, qreal min, qreal max)
-{
-    if (fabs(vec.x) < min) {
-        vec.x = 0.0;
-    } else if (fabs(vec.x) > max) {
-        if (vec.x > 0.0) {
-            vec.x = max;
-        } else {
-            vec.x = -max;
-        }
-    }
-
-    if (fabs(vec.y) < min) {
-        vec.y = 0.0;
-    } else if (fabs(vec.y) > max) {
-        if (vec.y > 0.0) {
-            vec.y = max;
-        } else {
-            vec.y = -max;
-        }
-    }
-}
-
-static inline void computeVectorBounds(WobblyWindowsEffect::Pair& vec, WobblyWindowsEffect::Pair& bound)
-{
-    if (fabs(vec.x) < bound.x) {
-        bound.x = fabs(vec.x);
-    } else if (fabs(vec.x) > bound.y) {
-        bound.y = fabs(vec.x);
-    }
-    if (fabs(vec.y) < bound.x) {
-        bound.x = fabs(vec.y);
-    } else if (fabs(vec.y) > bound.y) {
-        bound.y = fabs(vec.y);
-    }
-}
-
-} // close the anonymous namespace
-
-bool WobblyWindowsEffect::updateWindowWobblyDatas(EffectWindow* w, qreal time)
-{
-    QRectF rect = w->geometry();
-    WindowWobblyInfos& wwi = windows[w];
-
-    if (wwi.status == Closing) {
-        rect = wwi.closeRect;
-    }
-
-    qreal x_length = rect.width() / (wwi.width - 1.0);
-    qreal y_length = rect.height() / (wwi.height - 1.0);
-
+void WobblyWindowsEffect::stepWindows(qreal time)
+{
+    // only the meshes of the windows painted in this frame are advanced
+    const int count = m_visitedMeshes;
+    QVector<QRectF> geometries;
+    geometries.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        const WindowWobblyInfos& wwi = windows[m_meshWindows.at(i)];
+        geometries << (wwi.status == Closing ? wwi.closeRect : QRectF(m_meshWindows.at(i)->geometry()));
+    }
+
+    const WobblyMeshParameters parameters = {
+        float(m_stiffness),
+        float(m_drag),
+        float(m_move_factor),
+        float(m_minVelocity),
+        float(m_maxVelocity),
+        float(m_minAcceleration),
+        float(m_maxAcceleration)
+    };
+    QVector<WobblyMeshEnergy> energies(count);
+    WobblyMesh::step(m_meshes.data(), geometries.constData(), count, time, parameters, energies.data());
+
+    // going backwards as removing a window moves the last visited mesh into its slot
+    for (int i = count - 1; i >= 0; --i) {
+        EffectWindow* w = m_meshWindows.at(i);
+        const WindowStatus status = windows[w].status;
 #if defined VERBOSE_MODE
-    qCDebug(KWINEFFECTS) << "time " << time;
-    qCDebug(KWINEFFECTS) << "increment x " << x_length << " // y" <<  y_length;
+        qCDebug(KWINEFFECTS) << "sum_acc : " << energies.at(i).acceleration << "  ***  sum_vel :" << energies.at(i).velocity;
 #endif
-
-    Pair origine = {rect.x(), rect.y()};
-
-    for (unsigned int j = 0; j < wwi.height; ++j) {
-        for (unsigned int i = 0; i < wwi.width; ++i) {
-            wwi.origin[wwi.width*j + i] = origine;
-            if (i != wwi.width - 2) {
-                origine.x += x_length;
-            } else {
-                origine.x = rect.width() + rect.x();
-            }
-        }
-        origine.x = rect.x();
-        if (j != wwi.height - 2) {
-            origine.y += y_length;
-        } else {
-            origine.y = rect.height() + rect.y();
-        }
-    }
-
-    Pair neibourgs[4];
-    Pair acceleration;
-
-    qreal acc_sum = 0.0;
-    qreal vel_sum = 0.0;
-
-    // compute acceleration, velocity and position for each point
-
-    // for corners
-
-    // top-left
-
-    if (wwi.constraint[0]) {
-        Pair window_pos = wwi.origin[0];
-        Pair current_pos = wwi.position[0];
-        Pair move = {window_pos.x - current_pos.x, window_pos.y - current_pos.y};
-        Pair accel = {move.x*m_stiffness, move.y*m_stiffness};
-        wwi.acceleration[0] = accel;
-    } else {
-        Pair& pos = wwi.position[0];
-        neibourgs[0] = wwi.position[1];
-        neibourgs[1] = wwi.position[wwi.width];
-
-        acceleration.x = ((neibourgs[0].x - pos.x) - x_length) * m_stiffness + (neibourgs[1].x - pos.x) * m_stiffness;
-        acceleration.y = ((neibourgs[1].y - pos.y) - y_length) * m_stiffness + (neibourgs[0].y - pos.y) * m_stiffness;
-
-        acceleration.x /= 2;
-        acceleration.y /= 2;
-
-        wwi.acceleration[0] = acceleration;
-    }
-
-    // top-right
-
-    if (wwi.constraint[wwi.width-1]) {
-        Pair window_pos = wwi.origin[wwi.width-1];
-        Pair current_pos = wwi.position[wwi.width-1];
-        Pair move = {window_pos.x - current_pos.x, window_pos.y - current_pos.y};
-        Pair accel = {move.x*m_stiffness, move.y*m_stiffness};
-        wwi.acceleration[wwi.width-1] = accel;
-    } else {
-        Pair& pos = wwi.position[wwi.width-1];
-        neibourgs[0] = wwi.position[wwi.width-2];
-        neibourgs[1] = wwi.position[2*wwi.width-1];
-
-        acceleration.x = (x_length - (pos.x - neibourgs[0].x)) * m_stiffness + (neibourgs[1].x - pos.x) * m_stiffness;
-        acceleration.y = ((neibourgs[1].y - pos.y) - y_length) * m_stiffness + (neibourgs[0].y - pos.y) * m_stiffness;
-
-        acceleration.x /= 2;
-        acceleration.y /= 2;
-
-        wwi.acceleration[wwi.width-1] = acceleration;
-    }
-
-    // bottom-left
-
-    if (wwi.constraint[wwi.width*(wwi.height-1)]) {
-        Pair window_pos = wwi.origin[wwi.width*(wwi.height-1)];
-        Pair current_pos = wwi.position[wwi.width*(wwi.height-1)];
-        Pair move = {window_pos.x - current_pos.x, window_pos.y - current_pos.y};
-        Pair accel = {move.x*m_stiffness, move.y*m_stiffness};
-        wwi.acceleration[wwi.width*(wwi.height-1)] = accel;
-    } else {
-        Pair& pos = wwi.position[wwi.width*(wwi.height-1)];
-        neibourgs[0] = wwi.position[wwi.width*(wwi.height-1)+1];
-        neibourgs[1] = wwi.position[wwi.width*(wwi.height-2)];
-
-        acceleration.x = ((neibourgs[0].x - pos.x) - x_length) * m_stiffness + (neibourgs[1].x - pos.x) * m_stiffness;
-        acceleration.y = (y_length - (pos.y - neibourgs[1].y)) * m_stiffness + (neibourgs[0].y - pos.y) * m_stiffness;
-
-        acceleration.x /= 2;
-        acceleration.y /= 2;
-
-        wwi.acceleration[wwi.width*(wwi.height-1)] = acceleration;
-    }
-
-    // bottom-right
-
-    if (wwi.constraint[wwi.count-1]) {
-        Pair window_pos = wwi.origin[wwi.count-1];
-        Pair current_pos = wwi.position[wwi.count-1];
-        Pair move = {window_pos.x - current_pos.x, window_pos.y - current_pos.y};
-        Pair accel = {move.x*m_stiffness, move.y*m_stiffness};
-        wwi.acceleration[wwi.count-1] = accel;
-    } else {
-        Pair& pos = wwi.position[wwi.count-1];
-        neibourgs[0] = wwi.position[wwi.count-2];
-        neibourgs[1] = wwi.position[wwi.width*(wwi.height-1)-1];
-
-        acceleration.x = (x_length - (pos.x - neibourgs[0].x)) * m_stiffness + (neibourgs[1].x - pos.x) * m_stiffness;
-        acceleration.y = (y_length - (pos.y - neibourgs[1].y)) * m_stiffness + (neibourgs[0].y - pos.y) * m_stiffness;
-
-        acceleration.x /= 2;
-        acceleration.y /= 2;
-
-        wwi.acceleration[wwi.count-1] = acceleration;
-    }
-
-
-    // for borders
-
-    // top border
-    for (unsigned int i = 1; i < wwi.width - 1; ++i) {
-        if (wwi.constraint[i]) {
-            Pair window_pos = wwi.origin[i];
-            Pair current_pos = wwi.position[i];
-            Pair move = {window_pos.x - current_pos.x, window_pos.y - current_pos.y};
-            Pair accel = {move.x*m_stiffness, move.y*m_stiffness};
-            wwi.acceleration[i] = accel;
-        } else {
-            Pair& pos = wwi.position[i];
-            neibourgs[0] = wwi.position[i-1];
-            neibourgs[1] = wwi.position[i+1];
-            neibourgs[2] = wwi.position[i+wwi.width];
-
-            acceleration.x = (x_length - (pos.x - neibourgs[0].x)) * m_stiffness + ((neibourgs[1].x - pos.x) - x_length) * m_stiffness + (neibourgs[2].x - pos.x) * m_stiffness;
-            acceleration.y = ((neibourgs[2].y - pos.y) - y_length) * m_stiffness + (neibourgs[0].y - pos.y) * m_stiffness + (neibourgs[1].y - pos.y) * m_stiffness;
-
-            acceleration.x /= 3;
-            acceleration.y /= 3;
-
-            wwi.acceleration[i] = acceleration;
-        }
-    }
-
-    // bottom border
-    for (unsigned int i = wwi.width * (wwi.height - 1) + 1; i < wwi.count - 1; ++i) {
-        if (wwi.constraint[i]) {
-            Pair window_pos = wwi.origin[i];
-            Pair current_pos = wwi.position[i];
-            Pair move = {window_pos.x - current_pos.x, window_pos.y - current_pos.y};
-            Pair accel = {move.x*m_stiffness, move.y*m_stiffness};
-            wwi.acceleration[i] = accel;
-        } else {
-            Pair& pos = wwi.position[i];
-            neibourgs[0] = wwi.position[i-1];
-            neibourgs[1] = wwi.position[i+1];
-            neibourgs[2] = wwi.position[i-wwi.width];
-
-            acceleration.x = (x_length - (pos.x - neibourgs[0].x)) * m_stiffness + ((neibourgs[1].x - pos.x) - x_length) * m_stiffness + (neibourgs[2].x - pos.x) * m_stiffness;
-            acceleration.y = (y_length - (pos.y - neibourgs[2].y)) * m_stiffness + (neibourgs[0].y - pos.y) * m_stiffness + (neibourgs[1].y - pos.y) * m_stiffness;
-
-            acceleration.x /= 3;
-            acceleration.y /= 3;
-
-            wwi.acceleration[i] = acceleration;
-        }
-    }
-
-    // left border
-    for (unsigned int i = wwi.width; i < wwi.width*(wwi.height - 1); i += wwi.width) {
-        if (wwi.constraint[i]) {
-            Pair window_pos = wwi.origin[i];
-            Pair current_pos = wwi.position[i];
-            Pair move = {window_pos.x - current_pos.x, window_pos.y - current_pos.y};
-            Pair accel = {move.x*m_stiffness, move.y*m_stiffness};
-            wwi.acceleration[i] = accel;
-        } else {
-            Pair& pos = wwi.position[i];
-            neibourgs[0] = wwi.position[i+1];
-            neibourgs[1] = wwi.position[i-wwi.width];
-            neibourgs[2] = wwi.position[i+wwi.width];
-
-            acceleration.x = ((neibourgs[0].x - pos.x) - x_length) * m_stiffness + (neibourgs[1].x - pos.x) * m_stiffness + (neibourgs[2].x - pos.x) * m_stiffness;
-            acceleration.y = (y_length - (pos.y - neibourgs[1].y)) * m_stiffness + ((neibourgs[2].y - pos.y) - y_length) * m_stiffness + (neibourgs[0].y - pos.y) * m_stiffness;
-
-            acceleration.x /= 3;
-            acceleration.y /= 3;
-
-            wwi.acceleration[i] = acceleration;
-        }
-    }
-
-    // right border
-    for (unsigned int i = 2 * wwi.width - 1; i < wwi.count - 1; i += wwi.width) {
-        if (wwi.constraint[i]) {
-            Pair window_pos = wwi.origin[i];
-            Pair current_pos = wwi.position[i];
-            Pair move = {window_pos.x - current_pos.x, window_pos.y - current_pos.y};
-            Pair accel = {move.x*m_stiffness, move.y*m_stiffness};
-            wwi.acceleration[i] = accel;
-        } else {
-            Pair& pos = wwi.position[i];
-            neibourgs[0] = wwi.position[i-1];
-            neibourgs[1] = wwi.position[i-wwi.width];
-            neibourgs[2] = wwi.position[i+wwi.width];
-
-            acceleration.x = (x_length - (pos.x - neibourgs[0].x)) * m_stiffness + (neibourgs[1].x - pos.x) * m_stiffness + (neibourgs[2].x - pos.x) * m_stiffness;
-            acceleration.y = (y_length - (pos.y - neibourgs[1].y)) * m_stiffness + ((neibourgs[2].y - pos.y) - y_length) * m_stiffness + (neibourgs[0].y - pos.y) * m_stiffness;
-
-            acceleration.x /= 3;
-            acceleration.y /= 3;
-
-            wwi.acceleration[i] = acceleration;
-        }
-    }
-
-    // for the inner points
-    for (unsigned int j = 1; j < wwi.height - 1; ++j) {
-        for (unsigned int i = 1; i < wwi.width - 1; ++i) {
-            unsigned int index = i + j * wwi.width;
-
-            if (wwi.constraint[index]) {
-                Pair window_pos = wwi.origin[index];
-                Pair current_pos = wwi.position[index];
-                Pair move = {window_pos.x - current_pos.x, window_pos.y - current_pos.y};
-                Pair accel = {move.x*m_stiffness, move.y*m_stiffness};
-                wwi.acceleration[index] = accel;
-            } else {
-                Pair& pos = wwi.position[index];
-                neibourgs[0] = wwi.position[index-1];
-                neibourgs[1] = wwi.position[index+1];
-                neibourgs[2] = wwi.position[index-wwi.width];
-                neibourgs[3] = wwi.position[index+wwi.width];
-
-                acceleration.x = ((neibourgs[0].x - pos.x) - x_length) * m_stiffness +
-                                 (x_length - (pos.x - neibourgs[1].x)) * m_stiffness +
-                                 (neibourgs[2].x - pos.x) * m_stiffness +
-                                 (neibourgs[3].x - pos.x) * m_stiffness;
-                acceleration.y = (y_length - (pos.y - neibourgs[2].y)) * m_stiffness +
-                                 ((neibourgs[3].y - pos.y) - y_length) * m_stiffness +
-                                 (neibourgs[0].y - pos.y) * m_stiffness +
-                                 (neibourgs[1].y - pos.y) * m_stiffness;
-
-                acceleration.x /= 4;
-                acceleration.y /= 4;
-
-                wwi.acceleration[index] = acceleration;
+        if (status != Moving && energies.at(i).acceleration < m_stopAcceleration && energies.at(i).velocity < m_stopVelocity) {
+            if (status == Closing) {
+                w->unrefWindow();
             }
+            removeWindow(w);
         }
     }
-
-    heightRingLinearMean(&wwi.acceleration, wwi);
-
-#if defined COMPUTE_STATS
-    Pair accBound = {m_maxAcceleration, m_minAcceleration};
-    Pair velBound = {m_maxVelocity, m_minVelocity};
-#endif
-
-    // compute the new velocity of each vertex.
-    for (unsigned int i = 0; i < wwi.count; ++i) {
-        Pair acc = wwi.acceleration[i];
-        fixVectorBounds(acc, m_minAcceleration, m_maxAcceleration);
-
-#if defined COMPUTE_STATS
-        computeVectorBounds(acc, accBound);
-#endif
-
-        Pair& vel = wwi.velocity[i];
-        vel.x = acc.x * time + vel.x * m_drag;
-        vel.y = acc.y * time + vel.y * m_drag;
-
-        acc_sum += fabs(acc.x) + fabs(acc.y);
-    }
-
-    heightRingLinearMean(&wwi.velocity, wwi);
-
-    // compute the new pos of each vertex.
-    for (unsigned int i = 0; i < wwi.count; ++i) {
-        Pair& pos = wwi.position[i];
-        Pair& vel = wwi.velocity[i];
-
-        fixVectorBounds(vel, m_minVelocity, m_maxVelocity);
-#if defined COMPUTE_STATS
-        computeVectorBounds(vel, velBound);
-#endif
-
-        pos.x += vel.x * time * m_move_factor;
-        pos.y += vel.y * time * m_move_factor;
-
-        vel_sum += fabs(vel.x) + fabs(vel.y);
-
-#if defined VERBOSE_MODE
-        if (wwi.constraint[i]) {
-            qCDebug(KWINEFFECTS) << "Constraint point ** vel : " << vel.x << "," << vel.y << " ** move : " << vel.x*time << "," << vel.y*time;
-        }
-#endif
-    }
-
-    if (!wwi.can_wobble_top) {
-        for (unsigned int i = 0; i < wwi.width; ++i)
-            for (unsigned j = 0; j < wwi.width - 1; ++j)
-                wwi.position[i+wwi.width*j].y = wwi.origin[i+wwi.width*j].y;
-    }
-    if (!wwi.can_wobble_bottom) {
-        for (unsigned int i = wwi.width * (wwi.height - 1); i < wwi.count; ++i)
-            for (unsigned j = 0; j < wwi.width - 1; ++j)
-                wwi.position[i-wwi.width*j].y = wwi.origin[i-wwi.width*j].y;
-    }
-    if (!wwi.can_wobble_left) {
-        for (unsigned int i = 0; i < wwi.count; i += wwi.width)
-            for (unsigned j = 0; j < wwi.width - 1; ++j)
-                wwi.position[i+j].x = wwi.origin[i+j].x;
-    }
-    if (!wwi.can_wobble_right) {
-        for (unsigned int i = wwi.width - 1; i < wwi.count; i += wwi.width)
-            for (unsigned j = 0; j < wwi.width - 1; ++j)
-                wwi.position[i-j].x = wwi.origin[i-j].x;
-    }
-
-#if defined VERBOSE_MODE
-#   if defined COMPUTE_STATS
-    qCDebug(KWINEFFECTS) << "Acceleration bounds (" << accBound.x << ", " << accBound.y << ")";
-    qCDebug(KWINEFFECTS) << "Velocity bounds (" << velBound.x << ", " << velBound.y << ")";
-#   endif
-    qCDebug(KWINEFFECTS) << "sum_acc : " << acc_sum << "  ***  sum_vel :" << vel_sum;
-#endif
-
-    if (wwi.status != Moving && acc_sum < m_stopAcceleration && vel_sum < m_stopVelocity) {
-        if (wwi.status == Closing) {
-            w->unrefWindow();
-        }
-        freeWobblyInfo(wwi);
-        windows.remove(w);
-        if (windows.isEmpty())
-            effects->addRepaintFull();
-        return false;
-    }
-
-    return true;
-}
-
-void WobblyWindowsEffect::heightRingLinearMean(Pair** data_pointer, WindowWobblyInfos& wwi)
-{
-    Pair* data = *data_pointer;
-    Pair neibourgs[8];
-
-    // for corners
-
-    // top-left
-    {
-        Pair& res = wwi.buffer[0];
-        Pair vit = data[0];
-        neibourgs[0] = data[1];
-        neibourgs[1] = data[wwi.width];
-        neibourgs[2] = data[wwi.width+1];
-
-        res.x = (neibourgs[0].x + neibourgs[1].x + neibourgs[2].x + 3.0 * vit.x) / 6.0;
-        res.y = (neibourgs[0].y + neibourgs[1].y + neibourgs[2].y + 3.0 * vit.y) / 6.0;
-    }
-
-
-    // top-right
-    {
-        Pair& res = wwi.buffer[wwi.width-1];
-        Pair vit = data[wwi.width-1];
-        neibourgs[0] = data[wwi.width-2];
-        neibourgs[1] = data[2*wwi.width-1];
-        neibourgs[2] = data[2*wwi.width-2];
-
-        res.x = (neibourgs[0].x + neibourgs[1].x + neibourgs[2].x + 3.0 * vit.x) / 6.0;
-        res.y = (neibourgs[0].y + neibourgs[1].y + neibourgs[2].y + 3.0 * vit.y) / 6.0;
-    }
-
-
-    // bottom-left
-    {
-        Pair& res = wwi.buffer[wwi.width*(wwi.height-1)];
-        Pair vit = data[wwi.width*(wwi.height-1)];
-        neibourgs[0] = data[wwi.width*(wwi.height-1)+1];
-        neibourgs[1] = data[wwi.width*(wwi.height-2)];
-        neibourgs[2] = data[wwi.width*(wwi.height-2)+1];
-
-        res.x = (neibourgs[0].x + neibourgs[1].x + neibourgs[2].x + 3.0 * vit.x) / 6.0;
-        res.y = (neibourgs[0].y + neibourgs[1].y + neibourgs[2].y + 3.0 * vit.y) / 6.0;
-    }
-
-
-    // bottom-right
-    {
-        Pair& res = wwi.buffer[wwi.count-1];
-        Pair vit = data[wwi.count-1];
-        neibourgs[0] = data[wwi.count-2];
-        neibourgs[1] = data[wwi.width*(wwi.height-1)-1];
-        neibourgs[2] = data[wwi.width*(wwi.height-1)-2];
-
-        res.x = (neibourgs[0].x + neibourgs[1].x + neibourgs[2].x + 3.0 * vit.x) / 6.0;
-        res.y = (neibourgs[0].y + neibourgs[1].y + neibourgs[2].y + 3.0 * vit.y) / 6.0;
-    }
-
-
-    // for borders
-
-    // top border
-    for (unsigned int i = 1; i < wwi.width - 1; ++i) {
-        Pair& res = wwi.buffer[i];
-        Pair vit = data[i];
-        neibourgs[0] = data[i-1];
-        neibourgs[1] = data[i+1];
-        neibourgs[2] = data[i+wwi.width];
-        neibourgs[3] = data[i+wwi.width-1];
-        neibourgs[4] = data[i+wwi.width+1];
-
-        res.x = (neibourgs[0].x + neibourgs[1].x + neibourgs[2].x + neibourgs[3].x + neibourgs[4].x + 5.0 * vit.x) / 10.0;
-        res.y = (neibourgs[0].y + neibourgs[1].y + neibourgs[2].y + neibourgs[3].y + neibourgs[4].y + 5.0 * vit.y) / 10.0;
-    }
-
-    // bottom border
-    for (unsigned int i = wwi.width * (wwi.height - 1) + 1; i < wwi.count - 1; ++i) {
-        Pair& res = wwi.buffer[i];
-        Pair vit = data[i];
-        neibourgs[0] = data[i-1];
-        neibourgs[1] = data[i+1];
-        neibourgs[2] = data[i-wwi.width];
-        neibourgs[3] = data[i-wwi.width-1];
-        neibourgs[4] = data[i-wwi.width+1];
-
-        res.x = (neibourgs[0].x + neibourgs[1].x + neibourgs[2].x + neibourgs[3].x + neibourgs[4].x + 5.0 * vit.x) / 10.0;
-        res.y = (neibourgs[0].y + neibourgs[1].y + neibourgs[2].y + neibourgs[3].y + neibourgs[4].y + 5.0 * vit.y) / 10.0;
-    }
-
-    // left border
-    for (unsigned int i = wwi.width; i < wwi.width*(wwi.height - 1); i += wwi.width) {
-        Pair& res = wwi.buffer[i];
-        Pair vit = data[i];
-        neibourgs[0] = data[i+1];
-        neibourgs[1] = data[i-wwi.width];
-        neibourgs[2] = data[i+wwi.width];
-        neibourgs[3] = data[i-wwi.width+1];
-        neibourgs[4] = data[i+wwi.width+1];
-
-        res.x = (neibourgs[0].x + neibourgs[1].x + neibourgs[2].x + neibourgs[3].x + neibourgs[4].x + 5.0 * vit.x) / 10.0;
-        res.y = (neibourgs[0].y + neibourgs[1].y + neibourgs[2].y + neibourgs[3].y + neibourgs[4].y + 5.0 * vit.y) / 10.0;
-    }
-
-    // right border
-    for (unsigned int i = 2 * wwi.width - 1; i < wwi.count - 1; i += wwi.width) {
-        Pair& res = wwi.buffer[i];
-        Pair vit = data[i];
-        neibourgs[0] = data[i-1];
-        neibourgs[1] = data[i-wwi.width];
-        neibourgs[2] = data[i+wwi.width];
-        neibourgs[3] = data[i-wwi.width-1];
-        neibourgs[4] = data[i+wwi.width-1];
-
-        res.x = (neibourgs[0].x + neibourgs[1].x + neibourgs[2].x + neibourgs[3].x + neibourgs[4].x + 5.0 * vit.x) / 10.0;
-        res.y = (neibourgs[0].y + neibourgs[1].y + neibourgs[2].y + neibourgs[3].y + neibourgs[4].y + 5.0 * vit.y) / 10.0;
-    }
-
-    // for the inner points
-    for (unsigned int j = 1; j < wwi.height - 1; ++j) {
-        for (unsigned int i = 1; i < wwi.width - 1; ++i) {
-            unsigned int index = i + j * wwi.width;
-
-            Pair& res = wwi.buffer[index];
-            Pair& vit = data[index];
-            neibourgs[0] = data[index-1];
-            neibourgs[1] = data[index+1];
-            neibourgs[2] = data[index-wwi.width];
-            neibourgs[3] = data[index+wwi.width];
-            neibourgs[4] = data[index-wwi.width-1];
-            neibourgs[5] = data[index-wwi.width+1];
-            neibourgs[6] = data[index+wwi.width-1];
-            neibourgs[7] = data[index+wwi.width+1];
-
-            res.x = (neibourgs[0].x + neibourgs[1].x + neibourgs[2].x + neibourgs[3].x + neibourgs[4].x + neibourgs[5].x + neibourgs[6].x + neibourgs[7].x + 8.0 * vit.x) / 16.0;
-            res.y = (neibourgs[0].y + neibourgs[1].y + neibourgs[2].y + neibourgs[3].y + neibourgs[4].y + neibourgs[5].y + neibourgs[6].y + neibourgs[7].y + 8.0 * vit.y) / 16.0;
-        }
-    }
-
-    Pair* tmp = data;
-    *data_pointer = wwi.buffer;
-    wwi.buffer = tmp;
 }
 
 bool WobblyWindowsEffect::isActive() const
@@ -14,6 +14,8 @@ License. See the file "COPYING" for the exact licensing terms.
 // Include with base class for effects.
 #include <kwineffects.h>
 
+#include "wobblymesh.h"
+
 namespace KWin
 {
 
@@ -138,27 +140,13 @@ private:
 
     void startMovedResized(EffectWindow* w);
     void stepMovedResized(EffectWindow* w);
-    bool updateWindowWobblyDatas(EffectWindow* w, qreal time);
+    void stepWindows(qreal time);
+    void moveMesh(int from, int to);
+    void swapMeshes(int a, int b);
 
     struct WindowWobblyInfos {
-        Pair* origin;
-        Pair* position;
-        Pair* velocity;
-        Pair* acceleration;
-        Pair* buffer;
-
-        // if true, the physics system moves this point based only on it "normal" destination
-        // given by the window position, ignoring neighbour points.
-        bool* constraint;
-
-        unsigned int width;
-        unsigned int height;
-        unsigned int count;
-
-        Pair* bezierSurface;
-        unsigned int bezierWidth;
-        unsigned int bezierHeight;
-        unsigned int bezierCount;
+        // index of the window's mesh in m_meshes
+        int mesh;
 
         WindowStatus status;
 
@@ -166,11 +154,17 @@ private:
         QRectF closeRect;
 
         // for resizing. Only sides that have moved will wobble
-        bool can_wobble_top, can_wobble_left, can_wobble_right, can_wobble_bottom;
         QRect resize_original_rect;
     };
 
     QHash< const EffectWindow*,  WindowWobblyInfos > windows;
+    // the meshes of all wobbling windows are kept together so that they can be stepped in one batch
+    QVector<WobblyMesh> m_meshes;
+    QVector<EffectWindow*> m_meshWindows;
+    // the first m_visitedMeshes meshes belong to windows painted in the current frame
+    int m_visitedMeshes;
+    bool m_meshesStepped;
+    int m_stepTime;
 
     QRegion m_updateRegion;
 
@@ -198,14 +192,13 @@ private:
     bool m_moveWobble; // Expands m_moveEffectEnabled
     bool m_resizeWobble;
 
-    void initWobblyInfo(WindowWobblyInfos& wwi, QRect geometry) const;
-    void freeWobblyInfo(WindowWobblyInfos& wwi) const;
-    void wobblyOpenInit(WindowWobblyInfos& wwi) const;
-    void wobblyCloseInit(WindowWobblyInfos& wwi, EffectWindow* w) const;
-
-    WobblyWindowsEffect::Pair computeBezierPoint(const WindowWobblyInfos& wwi, Pair point) const;
+    WindowWobblyInfos& addWindow(EffectWindow* w, const QRect& geometry);
+    void removeWindow(const EffectWindow* w);
+    void updateCanWobble(EffectWindow* w);
+    void wobblyOpenInit(WindowWobblyInfos& wwi);
+    void wobblyCloseInit(WindowWobblyInfos& wwi, EffectWindow* w);
 
-    static void heightRingLinearMean(Pair** data_pointer, WindowWobblyInfos& wwi);
+    WobblyWindowsEffect::Pair computeBezierPoint(const WobblyMesh& mesh, Pair point) const;
 
     void setParameterSet(const ParameterSet& pset);
 };
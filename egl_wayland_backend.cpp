@@ -22,6 +22,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 // kwin
 #include "composite.h"
 #include "options.h"
+#include "timingstatistics.h"
 #include "wayland_backend.h"
 #include "xcbutils.h"
 // kwin libs
@@ -250,20 +251,27 @@ bool EglWaylandBackend::initBufferConfigs()
 
 void EglWaylandBackend::present()
 {
+    TimingStatistics::Measurement measurement(TimingStatistics::Present);
     // need to dispatch pending events as eglSwapBuffers can block
     m_wayland->dispatchEvents();
 
     m_lastFrameRendered = false;
     wl_callback *callback = wl_surface_frame(m_wayland->surface());
     wl_callback_add_listener(callback, &s_surfaceFrameListener, this);
+    // there is no sub buffer posting, without buffer age each frame is a full swap
+    // the swap might block for the retrace, it is not part of the measured cost
     if (supportsBufferAge()) {
         eglSwapBuffers(m_display, m_surface);
         eglQuerySurface(m_display, m_surface, EGL_BUFFER_AGE_EXT, &m_bufferAge);
         setLastDamage(QRegion());
+        presentFinished(PartialUpdateEngine::BufferAge, 0);
         return;
     } else {
+        // only a swap of a complete repaint is a full swap's cost
+        const bool fullRepaint = lastDamage() == QRegion(QRect(QPoint(0, 0), partialUpdate().screenSize()));
         eglSwapBuffers(m_display, m_surface);
         setLastDamage(QRegion());
+        presentFinished(PartialUpdateEngine::FullSwap, fullRepaint ? 0 : -1);
     }
 }
 
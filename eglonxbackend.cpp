@@ -21,6 +21,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 // kwin
 #include "options.h"
 #include "overlaywindow.h"
+#include "timingstatistics.h"
 #include "xcbutils.h"
 // kwin libs
 #include <kwinglplatform.h>
@@ -285,10 +286,24 @@ void EglOnXBackend::present()
     if (lastDamage().isEmpty())
         return;
 
+    TimingStatistics::Measurement measurement(TimingStatistics::Present);
+
     const QRegion displayRegion(0, 0, displayWidth(), displayHeight());
     const bool fullRepaint = supportsBufferAge() || (lastDamage() == displayRegion);
+    PartialUpdateEngine::Strategy strategy = PartialUpdateEngine::CopySubBuffer;
+    // the swap might block for the retrace, it is not part of the measured cost
+    qint64 presentTime = 0;
 
     if (fullRepaint || !surfaceHasSubPost) {
+        if (supportsBufferAge()) {
+            strategy = PartialUpdateEngine::BufferAge;
+        } else {
+            strategy = PartialUpdateEngine::FullSwap;
+            if (!fullRepaint) {
+                // the preserved surface gets swapped for a partial repaint, which is no full swap's cost
+                presentTime = -1;
+            }
+        }
         if (gs_tripleBufferNeedsDetection) {
             eglWaitGL();
             m_swapProfiler.begin();
@@ -319,12 +334,15 @@ void EglOnXBackend::present()
         }
     } else {
         // a part of the screen changed, and we can use eglPostSubBufferNV to copy the updated area
+        startPresentTimer();
         foreach (const QRect & r, lastDamage().rects()) {
             eglPostSubBufferNV(dpy, surface, r.left(), displayHeight() - r.bottom() - 1, r.width(), r.height());
         }
+        presentTime = this->presentTime();
     }
 
     setLastDamage(QRegion());
+    presentFinished(strategy, presentTime);
     if (!supportsBufferAge()) {
         eglWaitGL();
         xcb_flush(connection());
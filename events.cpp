@@ -511,6 +511,8 @@ bool Workspace::workspaceEvent(xcb_generic_event_t *e)
                 screen->width_in_millimeters = event->mwidth;
                 screen->height_in_millimeters = event->mheight;
             }
+            // a new mode with the same resolution does not change the screen geometry
+            screens()->invalidateRefreshRates();
             if (compositing()) {
                 // desktopResized() should take care of when the size or
                 // shape of the desktop has changed, but we also want to
@@ -1365,6 +1367,33 @@ bool Client::motionNotifyEvent(xcb_window_t w, int state, int x, int y, int x_ro
         y = this->y();
     }
 
+    // only the latest position matters, it gets applied at most once per frame
+    m_pendingMotion.x = x;
+    m_pendingMotion.y = y;
+    m_pendingMotion.xRoot = x_root;
+    m_pendingMotion.yRoot = y_root;
+    m_pendingMotion.isPending = true;
+    if (!m_moveResizeFrameTimer || !m_moveResizeFrameTimer->isActive()) {
+        applyPendingMotion();
+    }
+    return true;
+}
+
+void Client::applyPendingMotion()
+{
+    if (!m_pendingMotion.isPending)
+        return;
+    if (syncRequest.isPending && isResize()) {
+        // the client is still busy with the last resize, try again in the next frame
+        startMoveResizeFrameTimer();
+        return;
+    }
+    m_pendingMotion.isPending = false;
+    const int x = m_pendingMotion.x;
+    const int y = m_pendingMotion.y;
+    const int x_root = m_pendingMotion.xRoot;
+    const int y_root = m_pendingMotion.yRoot;
+
     const QRect oldGeo = geometry();
     handleMoveResize(x, y, x_root, y_root);
     if (!isFullScreen() && isMove()) {
@@ -1379,7 +1408,8 @@ bool Client::motionNotifyEvent(xcb_window_t w, int state, int x, int y, int x_ro
             checkQuickTilingMaximizationZones(x_root, y_root);
         }
     }
-    return true;
+    if (moveResizeMode)
+        startMoveResizeFrameTimer();
 }
 
 void Client::focusInEvent(xcb_focus_in_event_t *e)
@@ -1542,6 +1572,9 @@ void Client::syncEvent(xcb_sync_alarm_notify_event_t* e)
             if (syncRequest.timeout)
                 syncRequest.timeout->stop();
             performMoveResize();
+            // the client caught up, don't let a queued pointer position wait for the next frame
+            if (!m_moveResizeFrameTimer || !m_moveResizeFrameTimer->isActive())
+                applyPendingMotion();
         } else // setReadyForPainting does as well, but there's a small chance for resize syncs after the resize ended
             addRepaintFull();
     }
@@ -21,6 +21,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define KWIN_FOCUS_CHAIN_H
 // KWin
 #include <kwinglobals.h>
+#include "focuschainlist.h"
 // Qt
 #include <QObject>
 #include <QHash>
@@ -37,8 +38,9 @@ class Client;
  *
  * Internally this FocusChain holds multiple independent chains. There is one chain of most recently
  * used Clients which is primarily used by TabBox to build up the list of Clients for navigation.
- * The chains are organized as a normal QList of Clients with the most recently used Client being the
- * last item of the list, that is a LIFO like structure.
+ * The chains are organized as a FocusChainList of Clients with the most recently used Client being
+ * the last item of the list, that is a LIFO like structure. Finding, removing and moving a Client
+ * next to another one does not depend on the length of the chain.
  *
  * In addition there is one chain for each virtual desktop which is used to determine which Client
  * should get activated when the user switches to another virtual desktop.
@@ -199,7 +201,7 @@ private:
      * @param chain The focus chain to operate on
      * @return void
      **/
-    void makeFirstInChain(Client *client, QList<Client*> &chain);
+    void makeFirstInChain(Client *client, FocusChainList &chain);
     /**
      * @brief Makes @p client the last Client in the given focus @p chain.
      *
@@ -210,12 +212,12 @@ private:
      * @param chain The focus chain to operate on
      * @return void
      **/
-    void makeLastInChain(Client *client, QList<Client*> &chain);
-    void moveAfterClientInChain(Client *client, Client *reference, QList<Client*> &chain);
-    void updateClientInChain(Client *client, Change change, QList<Client*> &chain);
-    void insertClientIntoChain(Client *client, QList<Client*> &chain);
-    typedef QHash<uint, QList<Client*> > DesktopChains;
-    QList<Client*> m_mostRecentlyUsed;
+    void makeLastInChain(Client *client, FocusChainList &chain);
+    void moveAfterClientInChain(Client *client, Client *reference, FocusChainList &chain);
+    void updateClientInChain(Client *client, Change change, FocusChainList &chain);
+    void insertClientIntoChain(Client *client, FocusChainList &chain);
+    typedef QHash<uint, FocusChainList> DesktopChains;
+    FocusChainList m_mostRecentlyUsed;
     DesktopChains m_desktopFocusChains;
     bool m_separateScreenFocus;
     Client *m_activeClient;
@@ -0,0 +1,134 @@
+/********************************************************************
+ KWin - the KDE window manager
+ This file is part of the KDE project.
+
+Copyright (C) 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#include "focuschainlist.h"
+
+namespace KWin
+{
+
+FocusChainList::FocusChainList()
+    : m_first(nullptr)
+    , m_last(nullptr)
+{
+}
+
+Client *FocusChainList::previous(Client *client) const
+{
+    QHash<Client*, Links>::const_iterator it = m_links.constFind(client);
+    if (it == m_links.constEnd()) {
+        return nullptr;
+    }
+    return it->previous;
+}
+
+Client *FocusChainList::next(Client *client) const
+{
+    QHash<Client*, Links>::const_iterator it = m_links.constFind(client);
+    if (it == m_links.constEnd()) {
+        return nullptr;
+    }
+    return it->next;
+}
+
+void FocusChainList::link(Client *client, Client *previous, Client *next)
+{
+    Links links;
+    links.previous = previous;
+    links.next = next;
+    m_links.insert(client, links);
+    if (previous) {
+        m_links[previous].next = client;
+    } else {
+        m_first = client;
+    }
+    if (next) {
+        m_links[next].previous = client;
+    } else {
+        m_last = client;
+    }
+}
+
+void FocusChainList::append(Client *client)
+{
+    remove(client);
+    link(client, m_last, nullptr);
+}
+
+void FocusChainList::prepend(Client *client)
+{
+    remove(client);
+    link(client, nullptr, m_first);
+}
+
+void FocusChainList::insertBefore(Client *client, Client *reference)
+{
+    if (client == reference) {
+        return;
+    }
+    remove(client);
+    QHash<Client*, Links>::const_iterator it = m_links.constFind(reference);
+    if (it == m_links.constEnd()) {
+        link(client, m_last, nullptr);
+        return;
+    }
+    link(client, it->previous, reference);
+}
+
+void FocusChainList::insertAfter(Client *client, Client *reference)
+{
+    if (client == reference) {
+        return;
+    }
+    remove(client);
+    QHash<Client*, Links>::const_iterator it = m_links.constFind(reference);
+    if (it == m_links.constEnd()) {
+        link(client, m_last, nullptr);
+        return;
+    }
+    link(client, reference, it->next);
+}
+
+void FocusChainList::remove(Client *client)
+{
+    QHash<Client*, Links>::iterator it = m_links.find(client);
+    if (it == m_links.end()) {
+        return;
+    }
+    const Links links = it.value();
+    m_links.erase(it);
+    if (links.previous) {
+        m_links[links.previous].next = links.next;
+    } else {
+        m_first = links.next;
+    }
+    if (links.next) {
+        m_links[links.next].previous = links.previous;
+    } else {
+        m_last = links.previous;
+    }
+}
+
+void FocusChainList::clear()
+{
+    m_links.clear();
+    m_first = nullptr;
+    m_last = nullptr;
+}
+
+} // namespace
@@ -0,0 +1,135 @@
+/********************************************************************
+ KWin - the KDE window manager
+ This file is part of the KDE project.
+
+Copyright (C) 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+
+#ifndef KWIN_FOCUSCHAINLIST_H
+#define KWIN_FOCUSCHAINLIST_H
+
+#include <QHash>
+
+namespace KWin
+{
+class Client;
+
+/**
+ * @short Ordered list of Clients used for one focus chain.
+ *
+ * The list keeps the order of the QList it replaces: the most recently used Client is the last
+ * item. It is a doubly linked list whose links are stored in a hash indexed by the Client, so
+ * looking up, removing and inserting a Client next to another one take constant time instead
+ * of searching the list.
+ *
+ * Iterating from the most recently used Client is done through last() and previous():
+ * @code
+ * for (Client *c = list.last(); c; c = list.previous(c)) {
+ * }
+ * @endcode
+ *
+ * The list never dereferences the Clients.
+ **/
+class FocusChainList
+{
+public:
+    FocusChainList();
+
+    bool isEmpty() const;
+    int count() const;
+    bool contains(Client *client) const;
+    /**
+     * @returns The least recently used Client, @c null if the list is empty.
+     **/
+    Client *first() const;
+    /**
+     * @returns The most recently used Client, @c null if the list is empty.
+     **/
+    Client *last() const;
+    /**
+     * @returns The Client before @p client, @c null if @p client is the first one or not in the list.
+     **/
+    Client *previous(Client *client) const;
+    /**
+     * @returns The Client after @p client, @c null if @p client is the last one or not in the list.
+     **/
+    Client *next(Client *client) const;
+
+    /**
+     * Moves @p client to the end of the list, it becomes the last item.
+     **/
+    void append(Client *client);
+    /**
+     * Moves @p client to the start of the list, it becomes the first item.
+     **/
+    void prepend(Client *client);
+    /**
+     * Moves @p client directly before @p reference. Appends @p client if @p reference is not
+     * in the list.
+     **/
+    void insertBefore(Client *client, Client *reference);
+    /**
+     * Moves @p client directly after @p reference. Appends @p client if @p reference is not
+     * in the list.
+     **/
+    void insertAfter(Client *client, Client *reference);
+    void remove(Client *client);
+    void clear();
+
+private:
+    struct Links {
+        Client *previous;
+        Client *next;
+    };
+    void link(Client *client, Client *previous, Client *next);
+    QHash<Client*, Links> m_links;
+    Client *m_first;
+    Client *m_last;
+};
+
+inline
+bool FocusChainList::isEmpty() const
+{
+    return m_first == nullptr;
+}
+
+inline
+int FocusChainList::count() const
+{
+    return m_links.count();
+}
+
+inline
+bool FocusChainList::contains(Client *client) const
+{
+    return m_links.contains(client);
+}
+
+inline
+Client *FocusChainList::first() const
+{
+    return m_first;
+}
+
+inline
+Client *FocusChainList::last() const
+{
+    return m_last;
+}
+
+} // namespace
+
+#endif
@@ -461,8 +461,10 @@ QPoint Workspace::adjustClientPosition(Client* c, QPoint pos, bool unrestricted,
         // windows snap
         int snap = options->windowSnapZone() * snapAdjust;
         if (snap) {
+            // only clients with an edge within the snap zone can change the position
+            const QList<Client *> candidates = m_snapEdges.candidates(QRect(cx, cy, cw, ch), snap);
             QList<Client *>::ConstIterator l;
-            for (l = clients.constBegin(); l != clients.constEnd(); ++l) {
+            for (l = candidates.constBegin(); l != candidates.constEnd(); ++l) {
                 if ((*l) == c)
                     continue;
                 if ((*l)->isMinimized())
@@ -2066,7 +2068,7 @@ void Client::move(int x, int y, ForceGeometry_t force)
     workspace()->updateStackingOrder();
     if (Compositor::isCreated()) {
         // TODO: move out of geometry.cpp, is this really needed here?
-        Compositor::self()->checkUnredirect();
+        Compositor::self()->checkUnredirect(this);
     }
     // client itself is not damaged
     const QRect deco_rect = visibleRect();
@@ -2605,6 +2607,10 @@ bool Client::startMoveResize()
 
 void Client::finishMoveResize(bool cancel)
 {
+    if (!cancel) {
+        // the last pointer position might still be waiting for the next frame
+        applyPendingMotion();
+    }
     const bool wasResize = isResize(); // store across leaveMoveResize
     leaveMoveResize();
 
@@ -2674,6 +2680,9 @@ void Client::leaveMoveResize()
         syncRequest.isPending = false;
     delete syncRequest.timeout;
     syncRequest.timeout = NULL;
+    m_pendingMotion.isPending = false;
+    if (m_moveResizeFrameTimer)
+        m_moveResizeFrameTimer->stop();
 #ifdef KWIN_BUILD_SCREENEDGES
     if (ScreenEdges::self()->isDesktopSwitchingMovingClients())
         ScreenEdges::self()->reserveDesktopSwitching(false, Qt::Vertical|Qt::Horizontal);
@@ -3044,6 +3053,17 @@ void Client::handleMoveResize(int x, int y, int x_root, int y_root)
 #endif
 }
 
+void Client::startMoveResizeFrameTimer()
+{
+    if (!m_moveResizeFrameTimer) {
+        m_moveResizeFrameTimer = new QTimer(this);
+        m_moveResizeFrameTimer->setSingleShot(true);
+        connect(m_moveResizeFrameTimer, &QTimer::timeout, this, &Client::applyPendingMotion);
+    }
+    // without compositing pace to a 60 Hz screen
+    m_moveResizeFrameTimer->start(Compositor::compositing() ? Compositor::self()->frameInterval() : 16);
+}
+
 void Client::performMoveResize()
 {
     if (isMove() || (isResize() && !s_haveResizeEffect)) {
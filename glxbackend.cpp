@@ -30,6 +30,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "options.h"
 #include "utils.h"
 #include "overlaywindow.h"
+#include "timingstatistics.h"
 // kwin libs
 #include <kwinglplatform.h>
 // Qt
@@ -444,10 +445,16 @@ void GlxBackend::present()
     if (lastDamage().isEmpty())
         return;
 
+    TimingStatistics::Measurement measurement(TimingStatistics::Present);
+
     const QRegion displayRegion(0, 0, displayWidth(), displayHeight());
     const bool fullRepaint = supportsBufferAge() || (lastDamage() == displayRegion);
+    PartialUpdateEngine::Strategy strategy = PartialUpdateEngine::CopySubBuffer;
+    // the swap might block for the retrace, it is not part of the measured cost
+    qint64 presentTime = 0;
 
     if (fullRepaint) {
+        strategy = supportsBufferAge() ? PartialUpdateEngine::BufferAge : PartialUpdateEngine::FullSwap;
         if (haveSwapInterval) {
             if (gs_tripleBufferNeedsDetection) {
                 glXWaitGL();
@@ -481,18 +488,23 @@ void GlxBackend::present()
             glXQueryDrawable(display(), glxWindow, GLX_BACK_BUFFER_AGE_EXT, (GLuint *) &m_bufferAge);
         }
     } else if (glXCopySubBuffer) {
+        startPresentTimer();
         foreach (const QRect & r, lastDamage().rects()) {
             // convert to OpenGL coordinates
             int y = displayHeight() - r.y() - r.height();
             glXCopySubBuffer(display(), glxWindow, r.x(), y, r.width(), r.height());
         }
+        presentTime = this->presentTime();
     } else { // Copy Pixels (horribly slow on Mesa)
         glDrawBuffer(GL_FRONT);
         SceneOpenGL::copyPixels(lastDamage());
         glDrawBuffer(GL_BACK);
+        // not comparable to a sub buffer copy, don't let it decide between the strategies
+        presentTime = -1;
     }
 
     setLastDamage(QRegion());
+    presentFinished(strategy, presentTime);
     if (!supportsBufferAge()) {
         glXWaitGL();
         XFlush(display());
@@ -37,6 +37,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <kstartupinfo.h>
 #include <KWindowSystem>
 #include <QDebug>
+#include <QHash>
+#include <QPair>
 #include <QX11Info>
 
 
@@ -191,6 +193,24 @@ void checkNonExistentClients()
 
 #endif
 
+/*
+ Cached results of Client::hasTransient() with indirect transiency, Client::mainClients() and
+ Client::allMainClients(). Computing them walks the transients of the whole group, but they are
+ queried all the time while restacking and activating. The relations only change when windows
+ are added to or removed from a group, change WM_TRANSIENT_FOR or get their transients list
+ adjusted, all of which happens in this file and drops the whole cache.
+*/
+static QHash<QPair<const Client*, const Client*>, bool> s_indirectTransients;
+static QHash<const Client*, ClientList> s_mainClients;
+static QHash<const Client*, ClientList> s_allMainClients;
+
+static void invalidateTransiencyCache()
+{
+    s_indirectTransients.clear();
+    s_mainClients.clear();
+    s_allMainClients.clear();
+}
+
 //********************************************
 // Group
 //********************************************
@@ -243,6 +263,7 @@ void Group::addMember(Client* member_P)
 {
     TRANSIENCY_CHECK(member_P);
     _members.append(member_P);
+    invalidateTransiencyCache();
 //    qDebug() << "GROUPADD:" << this << ":" << member_P;
 //    qDebug() << kBacktrace();
 }
@@ -254,6 +275,7 @@ void Group::removeMember(Client* member_P)
 //    qDebug() << kBacktrace();
     Q_ASSERT(_members.contains(member_P));
     _members.removeAll(member_P);
+    invalidateTransiencyCache();
 // there are cases when automatic deleting of groups must be delayed,
 // e.g. when removing a member and doing some operation on the possibly
 // other members of the group (which would be however deleted already
@@ -572,6 +594,7 @@ void Client::setTransient(xcb_window_t new_transient_for_id)
         removeFromMainClients();
         transient_for = NULL;
         m_transientForId = new_transient_for_id;
+        invalidateTransiencyCache();
         if (m_transientForId != XCB_WINDOW_NONE && !groupTransient()) {
             transient_for = workspace()->findClient(Predicate::WindowMatch, m_transientForId);
             assert(transient_for != NULL);   // verifyTransient() had to check this
@@ -687,7 +710,7 @@ void Client::checkGroupTransients()
                     cl = cl->transientFor()) {
                 if (cl == *it1) {
                     // don't use removeTransient(), that would modify *it2 too
-                    (*it2)->transients_list.removeAll(*it1);
+                    (*it2)->removeFromTransientsList(*it1);
                     continue;
                 }
             }
@@ -696,22 +719,25 @@ void Client::checkGroupTransients()
             // and should be therefore on top of *it1
             // TODO This could possibly be optimized, it also requires hasTransient() to check for loops.
             if ((*it2)->groupTransient() && (*it1)->hasTransient(*it2, true) && (*it2)->hasTransient(*it1, true))
-                (*it2)->transients_list.removeAll(*it1);
+                (*it2)->removeFromTransientsList(*it1);
             // if there are already windows W1 and W2, W2 being transient for W1, and group transient W3
             // is added, make it transient only for W2, not for W1, because it's already indirectly
             // transient for it - the indirect transiency actually shouldn't break anything,
             // but it can lead to exponentially expensive operations (#95231)
-            // TODO this is pretty slow as well
             for (ClientList::ConstIterator it3 = group()->members().constBegin();
                     it3 != group()->members().constEnd();
                     ++it3) {
+                // only relevant as long as *it1 is directly transient for *it2, which cannot
+                // become true again once removed, so stop right away
+                if (!(*it2)->hasTransient(*it1, false))
+                    break;
                 if (*it1 == *it2 || *it2 == *it3 || *it1 == *it3)
                     continue;
-                if ((*it2)->hasTransient(*it1, false) && (*it3)->hasTransient(*it1, false)) {
+                if ((*it3)->hasTransient(*it1, false)) {
                     if ((*it2)->hasTransient(*it3, true))
-                        (*it2)->transients_list.removeAll(*it1);
+                        (*it2)->removeFromTransientsList(*it1);
                     if ((*it3)->hasTransient(*it2, true))
-                        (*it3)->transients_list.removeAll(*it1);
+                        (*it3)->removeFromTransientsList(*it1);
                 }
             }
         }
@@ -792,6 +818,7 @@ void Client::addTransient(Client* cl)
 //    assert( !cl->hasTransient( this, true )); will be fixed in checkGroupTransients()
     assert(cl != this);
     transients_list.append(cl);
+    invalidateTransiencyCache();
     if (workspace()->mostRecentlyActivatedClient() == this && cl->isModal())
         check_active_modal = true;
 //    qDebug() << "ADDTRANS:" << this << ":" << cl;
@@ -808,16 +835,24 @@ void Client::removeTransient(Client* cl)
 //    qDebug() << "REMOVETRANS:" << this << ":" << cl;
 //    qDebug() << kBacktrace();
     transients_list.removeAll(cl);
+    invalidateTransiencyCache();
     // cl is transient for this, but this is going away
     // make cl group transient
     if (cl->transientFor() == this) {
         cl->m_transientForId = XCB_WINDOW_NONE;
         cl->transient_for = NULL; // SELI
+        invalidateTransiencyCache();
 // SELI       cl->setTransient( rootWindow());
         cl->setTransient(XCB_WINDOW_NONE);
     }
 }
 
+void Client::removeFromTransientsList(Client* cl)
+{
+    if (transients_list.removeAll(cl) > 0)
+        invalidateTransiencyCache();
+}
+
 // A new window has been mapped. Check if it's not a mainwindow for this already existing window.
 void Client::checkTransient(xcb_window_t w)
 {
@@ -834,7 +869,15 @@ bool Client::hasTransient(const Client* cl, bool indirect) const
 {
     // checkGroupTransients() uses this to break loops, so hasTransient() must detect them
     ConstClientList set;
-    return hasTransientInternal(cl, indirect, set);
+    if (!indirect)
+        return hasTransientInternal(cl, indirect, set);
+    const QPair<const Client*, const Client*> key(this, cl);
+    QHash<QPair<const Client*, const Client*>, bool>::const_iterator cached = s_indirectTransients.constFind(key);
+    if (cached != s_indirectTransients.constEnd())
+        return cached.value();
+    const bool result = hasTransientInternal(cl, indirect, set);
+    s_indirectTransients.insert(key, result);
+    return result;
 }
 
 bool Client::hasTransientInternal(const Client* cl, bool indirect, ConstClientList& set) const
@@ -875,20 +918,28 @@ ClientList Client::mainClients() const
         return ClientList();
     if (transientFor() != NULL)
         return ClientList() << const_cast< Client* >(transientFor());
+    QHash<const Client*, ClientList>::const_iterator cached = s_mainClients.constFind(this);
+    if (cached != s_mainClients.constEnd())
+        return cached.value();
     ClientList result;
     for (ClientList::ConstIterator it = group()->members().constBegin();
             it != group()->members().constEnd();
             ++it)
         if ((*it)->hasTransient(this, false))
             result.append(*it);
+    s_mainClients.insert(this, result);
     return result;
 }
 
 ClientList Client::allMainClients() const
 {
+    QHash<const Client*, ClientList>::const_iterator cached = s_allMainClients.constFind(this);
+    if (cached != s_allMainClients.constEnd())
+        return cached.value();
     ClientList result = mainClients();
     foreach (const Client * cl, result)
     result += cl->allMainClients();
+    s_allMainClients.insert(this, result);
     return result;
 }
 
@@ -980,9 +1031,10 @@ void Client::checkGroup(Group* set_group, bool force)
                 it != transients_list.end();
            ) {
             // group transients in the old group are no longer transient for it
-            if ((*it)->groupTransient() && (*it)->group() != group())
+            if ((*it)->groupTransient() && (*it)->group() != group()) {
                 it = transients_list.erase(it);
-            else
+                invalidateTransiencyCache();
+            } else
                 ++it;
         }
         if (groupTransient()) {
@@ -0,0 +1,55 @@
+/********************************************************************
+ KWin - the KDE window manager
+ This file is part of the KDE project.
+
+Copyright (C) 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#include "hiddenpixmapbudget.h"
+
+#include <algorithm>
+
+namespace KWin
+{
+
+QVector<int> HiddenPixmapBudget::select(const QVector<Pixmap> &pixmaps, quint64 budget, quint64 pass)
+{
+    QVector<int> released;
+    quint64 used = 0;
+    QVector<int> candidates;
+    for (int i = 0; i < pixmaps.count(); ++i) {
+        const Pixmap &pixmap = pixmaps.at(i);
+        used += pixmap.memory;
+        if (pixmap.recreatable && pixmap.lastUse != pass && pixmap.memory > 0) {
+            candidates << i;
+        }
+    }
+    if (used <= budget) {
+        return released;
+    }
+    std::stable_sort(candidates.begin(), candidates.end(), [&pixmaps](int a, int b) {
+        return pixmaps.at(a).lastUse < pixmaps.at(b).lastUse;
+    });
+    foreach (int i, candidates) {
+        if (used <= budget) {
+            break;
+        }
+        used -= pixmaps.at(i).memory;
+        released << i;
+    }
+    return released;
+}
+
+} // namespace
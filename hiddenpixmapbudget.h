@@ -0,0 +1,63 @@
+/********************************************************************
+ KWin - the KDE window manager
+ This file is part of the KDE project.
+
+Copyright (C) 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+
+#ifndef KWIN_HIDDENPIXMAPBUDGET_H
+#define KWIN_HIDDENPIXMAPBUDGET_H
+
+#include <QVector>
+
+namespace KWin
+{
+
+/**
+ * @short Chooses the window pixmaps of hidden windows to release to stay within a memory budget.
+ *
+ * The budget works in passes. A pixmap which was used in the current pass, e.g. for a
+ * thumbnail, is never released. Of the others the least recently used ones are released
+ * first, until the memory of all hidden pixmaps fits into the budget.
+ *
+ * Only pixmaps of windows which are still mapped can be released. XComposite can only name the
+ * pixmap of a viewable window, so the pixmap of an unmapped window, e.g. a minimized one, could
+ * not be recreated for a thumbnail before the window gets shown again.
+ **/
+class HiddenPixmapBudget
+{
+public:
+    struct Pixmap {
+        quint64 memory;
+        /**
+         * The pass in which the pixmap was used the last time.
+         **/
+        quint64 lastUse;
+        /**
+         * Whether the window is mapped, so that the pixmap can be created again.
+         **/
+        bool recreatable;
+    };
+
+    /**
+     * @returns The indices of the @p pixmaps to release in @p pass to get below @p budget bytes.
+     **/
+    static QVector<int> select(const QVector<Pixmap> &pixmaps, quint64 budget, quint64 pass);
+};
+
+} // namespace
+
+#endif
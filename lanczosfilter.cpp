@@ -200,7 +200,7 @@ void LanczosFilter::performPaint(EffectWindowImpl* w, int mask, QRegion region,
             int sw = width;
             int sh = height;
 
-            GLTexture *cachedTexture = static_cast< GLTexture*>(w->data(LanczosCacheRole).value<void*>());
+            GLTexture *cachedTexture = static_cast< GLTexture*>(w->dataPointer(LanczosCacheRole));
             if (cachedTexture) {
                 if (cachedTexture->width() == tw && cachedTexture->height() == th) {
                     cachedTexture->bind();
@@ -396,9 +396,8 @@ void LanczosFilter::timerEvent(QTimerEvent *event)
 
 void LanczosFilter::discardCacheTexture(EffectWindow *w)
 {
-    QVariant cachedTextureVariant = w->data(LanczosCacheRole);
-    if (cachedTextureVariant.isValid()) {
-        delete static_cast< GLTexture*>(cachedTextureVariant.value<void*>());
+    if (GLTexture *cachedTexture = static_cast< GLTexture*>(w->dataPointer(LanczosCacheRole))) {
+        delete cachedTexture;
         w->setData(LanczosCacheRole, QVariant());
     }
 }
@@ -37,6 +37,9 @@ AniData::AniData()
     windowType = (NET::WindowTypeMask)0;
     duration = time = meta = startTime = 0;
     waitAtSource = keepAtTarget = false;
+    id = 0;
+    progress = 0.0;
+    progressTime = -1;
 }
 
 AniData::AniData(AnimationEffect::Attribute a, int meta, int ms, const FPx2 &to,
@@ -52,6 +55,9 @@ AniData::AniData(AnimationEffect::Attribute a, int meta, int ms, const FPx2 &to,
     this->waitAtSource = waitAtSource;
     this->keepAtTarget = keepAtTarget;
     startTime = AnimationEffect::clock() + delay;
+    id = 0;
+    progress = 0.0;
+    progressTime = -1;
 }
 
 AniData::AniData(const AniData &other)
@@ -68,6 +74,9 @@ AniData::AniData(const AniData &other)
     waitAtSource = other.waitAtSource;
     keepAtTarget = other.keepAtTarget;
     startTime = other.startTime;
+    id = other.id;
+    progress = other.progress;
+    progressTime = other.progressTime;
 }
 
 static FPx2 fpx2(const QString &s, AnimationEffect::Attribute a)
@@ -105,6 +114,9 @@ AniData::AniData(const QString &str) // format: WindowMask:Attribute:Meta:Durati
     time = 0;
     duration = 1; // invalidate
     customCurve = 0; // Linear
+    id = 0;
+    progress = 0.0;
+    progressTime = -1;
 
     QStringList animation = str.split(u':');
     if (animation.count() < 5)
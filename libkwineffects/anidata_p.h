@@ -38,6 +38,17 @@ public:
     inline bool isOneDimensional() const {
         return from[0] == from[1] && to[0] == to[1];
     }
+    /**
+     * The eased progress at the current time. The curve is evaluated at most once per
+     * time step, all attributes painted in a frame share the result.
+     **/
+    inline qreal easedProgress() const {
+        if (progressTime != time) {
+            progress = curve.valueForProgress(((float)time)/duration);
+            progressTime = time;
+        }
+        return progress;
+    }
     static QList<AniData> list(const QString &str);
     QString toString() const;
     QString debugInfo() const;
@@ -50,6 +61,10 @@ public:
     qint64 startTime;
     NET::WindowTypeMask windowType;
     bool waitAtSource, keepAtTarget;
+    quint64 id;
+private:
+    mutable qreal progress;
+    mutable int progressTime;
 };
 
 } // namespace
@@ -22,7 +22,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "anidata_p.h"
 
 #include <QDateTime>
+#include <QHash>
 #include <QTimer>
+#include <QVector>
 #include <QtDebug>
 #include <QVector3D>
 
@@ -39,10 +41,61 @@ QElapsedTimer AnimationEffect::s_clock;
 class AnimationEffectPrivate {
 public:
     AnimationEffectPrivate() { m_animated = m_damageDirty = m_animationsTouched = m_isInitialized = false; }
-    AnimationEffect::AniMap m_animations;
+    /**
+     * The animations of one window and the area they need to repaint.
+     **/
+    struct AniEntry {
+        EffectWindow *window;
+        QVector<AniData> animations;
+        QRect layerRect;
+    };
+    AniEntry *find(const EffectWindow *w);
+    AniEntry &findOrInsert(EffectWindow *w);
+    /**
+     * Removes the entry at @p index by moving the last entry into its place.
+     **/
+    void removeAt(int index);
+    // all animated windows in one array, m_index maps a window to its position
+    QVector<AniEntry> m_animations;
+    QHash<const EffectWindow*, int> m_index;
     EffectWindowList m_zombies;
     bool m_animated, m_damageDirty, m_needSceneRepaint, m_animationsTouched, m_isInitialized;
+    static quint64 s_lastAnimationId;
 };
+
+quint64 AnimationEffectPrivate::s_lastAnimationId = 0;
+
+AnimationEffectPrivate::AniEntry *AnimationEffectPrivate::find(const EffectWindow *w)
+{
+    auto it = m_index.constFind(w);
+    if (it == m_index.constEnd())
+        return nullptr;
+    return &m_animations[it.value()];
+}
+
+AnimationEffectPrivate::AniEntry &AnimationEffectPrivate::findOrInsert(EffectWindow *w)
+{
+    auto it = m_index.constFind(w);
+    if (it != m_index.constEnd())
+        return m_animations[it.value()];
+    AniEntry entry;
+    entry.window = w;
+    m_index.insert(w, m_animations.count());
+    m_animations.append(entry);
+    return m_animations.last();
+}
+
+void AnimationEffectPrivate::removeAt(int index)
+{
+    m_index.remove(m_animations.at(index).window);
+    const int last = m_animations.count() - 1;
+    if (index != last) {
+        const AniEntry moved = m_animations.at(last);
+        m_animations[index] = moved;
+        m_index[moved.window] = index;
+    }
+    m_animations.removeLast();
+}
 }
 
 using namespace KWin;
@@ -202,12 +255,11 @@ quint64 AnimationEffect::p_animate( EffectWindow *w, Attribute a, uint meta, int
         connect (effects,   SIGNAL(windowPaddingChanged(KWin::EffectWindow*,QRect)),
                             SLOT(_expandedGeometryChanged(KWin::EffectWindow*,QRect)));
     }
-    AniMap::iterator it = d->m_animations.find(w);
-    if (it == d->m_animations.end())
-        it = d->m_animations.insert(w, QPair<QList<AniData>, QRect>(QList<AniData>(), QRect()));
-    it->first.append(AniData(a, meta, ms, to, curve, delay, from, waitAtSource, keepAtTarget));
-    quint64 ret_id = quint64(&it->first.last());
-    it->second = QRect();
+    AnimationEffectPrivate::AniEntry &entry = d->findOrInsert(w);
+    entry.animations.append(AniData(a, meta, ms, to, curve, delay, from, waitAtSource, keepAtTarget));
+    const quint64 ret_id = ++AnimationEffectPrivate::s_lastAnimationId;
+    entry.animations.last().id = ret_id;
+    entry.layerRect = QRect();
 
     d->m_animationsTouched = true;
 
@@ -225,17 +277,18 @@ quint64 AnimationEffect::p_animate( EffectWindow *w, Attribute a, uint meta, int
 bool AnimationEffect::cancel(quint64 animationId)
 {
     Q_D(AnimationEffect);
-    for (AniMap::iterator entry = d->m_animations.begin(), mapEnd = d->m_animations.end(); entry != mapEnd; ++entry) {
-        for (QList<AniData>::iterator anim = entry->first.begin(), animEnd = entry->first.end(); anim != animEnd; ++anim) {
-            if (quint64(&(*anim)) == animationId) {
-                entry->first.erase(anim); // remove the animation
-                if (entry->first.isEmpty()) { // no other animations on the window, release it.
-                    const int i = d->m_zombies.indexOf(entry.key());
+    for (int e = 0; e < d->m_animations.count(); ++e) {
+        AnimationEffectPrivate::AniEntry &entry = d->m_animations[e];
+        for (int a = 0; a < entry.animations.count(); ++a) {
+            if (entry.animations.at(a).id == animationId) {
+                entry.animations.remove(a); // remove the animation
+                if (entry.animations.isEmpty()) { // no other animations on the window, release it.
+                    const int i = d->m_zombies.indexOf(entry.window);
                     if ( i > -1 ) {
                         d->m_zombies.removeAt( i );
-                        entry.key()->unrefWindow();
+                        entry.window->unrefWindow();
                     }
-                    d->m_animations.erase(entry);
+                    d->removeAt(e);
                 }
                 if (d->m_animations.isEmpty())
                     disconnectGeometryChanges();
@@ -255,18 +308,19 @@ void AnimationEffect::prePaintScreen( ScreenPrePaintData& data, int time )
     }
 
     d->m_animationsTouched = false;
-    AniMap::iterator entry = d->m_animations.begin(), mapEnd = d->m_animations.end();
     d->m_animated = false;
 //     short int transformed = 0;
-    while (entry != mapEnd) {
+    // NOTICE indices instead of iterators: animationEnded is an external call and might call
+    // "::animate", which appends to the arrays and can reallocate them
+    int e = 0;
+    while (e < d->m_animations.count()) {
         bool invalidateLayerRect = false;
-        QList<AniData>::iterator anim = entry->first.begin(), animEnd = entry->first.end();
-        int animCounter = 0;
-        while (anim != animEnd) {
+        int a = 0;
+        while (a < d->m_animations.at(e).animations.count()) {
+            AniData *anim = &d->m_animations[e].animations[a];
             if (anim->startTime > clock()) {
                 if (!anim->waitAtSource) {
-                    ++anim;
-                    ++animCounter;
+                    ++a;
                     continue;
                 }
             } else {
@@ -277,49 +331,38 @@ void AnimationEffect::prePaintScreen( ScreenPrePaintData& data, int time )
 //                 if (anim->attribute != Brightness && anim->attribute != Saturation && anim->attribute != Opacity)
 //                     transformed = true;
                 d->m_animated = true;
-                ++anim;
-                ++animCounter;
+                ++a;
             } else {
-                EffectWindow *oldW = entry.key();
-                AniData *aData = &(*anim);
-                if (aData->attribute == KWin::AnimationEffect::CrossFadePrevious) {
+                EffectWindow *oldW = d->m_animations.at(e).window;
+                if (anim->attribute == KWin::AnimationEffect::CrossFadePrevious) {
                     oldW->unreferencePreviousWindowPixmap();
                     effects->addRepaint(oldW->expandedGeometry());
                 }
                 animationEnded(oldW, anim->attribute, anim->meta);
-                // NOTICE animationEnded is an external call and might have called "::animate"
-                // as a result our iterators could now point random junk on the heap
-                // so we've to restore the former states, ie. find our window list and animation
                 if (d->m_animationsTouched) {
                     d->m_animationsTouched = false;
-                    entry = d->m_animations.begin(), mapEnd = d->m_animations.end();
-                    while (entry.key() != oldW && entry != mapEnd)
-                        ++entry;
-                    Q_ASSERT(entry != mapEnd); // usercode should not delete animations from animationEnded (not even possible atm.)
-                    anim = entry->first.begin(), animEnd = entry->first.end();
-                    Q_ASSERT(animCounter < entry->first.count());
-                    for (int i = 0; i < animCounter; ++i)
-                        ++anim;
+                    // new windows are appended, so the entry keeps its position
+                    Q_ASSERT(e < d->m_animations.count() && d->m_animations.at(e).window == oldW); // usercode should not delete animations from animationEnded (not even possible atm.)
+                    Q_ASSERT(a < d->m_animations.at(e).animations.count());
                 }
-                anim = entry->first.erase(anim);
+                d->m_animations[e].animations.remove(a);
                 invalidateLayerRect = d->m_damageDirty = true;
-                animEnd = entry->first.end();
             }
         }
-        if (entry->first.isEmpty()) {
-            const int i = d->m_zombies.indexOf(entry.key());
+        AnimationEffectPrivate::AniEntry &entry = d->m_animations[e];
+        if (entry.animations.isEmpty()) {
+            const int i = d->m_zombies.indexOf(entry.window);
             if ( i > -1 ) {
                 d->m_zombies.removeAt( i );
-                entry.key()->unrefWindow();
+                entry.window->unrefWindow();
             }
-            data.paint |= entry->second;
+            data.paint |= entry.layerRect;
 //             d->m_damageDirty = true; // TODO likely no longer required
-            entry = d->m_animations.erase(entry);
-            mapEnd = d->m_animations.end();
+            d->removeAt(e); // moves the last entry to e, which still has to be processed
         } else {
             if (invalidateLayerRect)
-                *const_cast<QRect*>(&(entry->second)) = QRect(); // invalidate
-            ++entry;
+                entry.layerRect = QRect(); // invalidate
+            ++e;
         }
     }
 
@@ -433,10 +476,9 @@ void AnimationEffect::prePaintWindow( EffectWindow* w, WindowPrePaintData& data,
 {
     Q_D(AnimationEffect);
     if ( d->m_animated ) {
-        AniMap::const_iterator entry = d->m_animations.constFind( w );
-        if ( entry != d->m_animations.constEnd() ) {
+        if (const AnimationEffectPrivate::AniEntry *entry = d->find(w)) {
             bool isUsed = false;
-            for (QList<AniData>::const_iterator anim = entry->first.constBegin(); anim != entry->first.constEnd(); ++anim) {
+            for (QVector<AniData>::const_iterator anim = entry->animations.constBegin(); anim != entry->animations.constEnd(); ++anim) {
                 if (anim->startTime > clock() && !anim->waitAtSource)
                     continue;
 
@@ -478,9 +520,10 @@ void AnimationEffect::paintWindow( EffectWindow* w, int mask, QRegion region, Wi
 {
     Q_D(AnimationEffect);
     if ( d->m_animated ) {
-        AniMap::const_iterator entry = d->m_animations.constFind( w );
-        if ( entry != d->m_animations.constEnd() ) {
-            for ( QList<AniData>::const_iterator anim = entry->first.constBegin(); anim != entry->first.constEnd(); ++anim ) {
+        if (const AnimationEffectPrivate::AniEntry *entry = d->find(w)) {
+            // genericAnimation might start new animations and reallocate the entries, iterate a (shared) copy
+            const QVector<AniData> animations = entry->animations;
+            for ( QVector<AniData>::const_iterator anim = animations.constBegin(); anim != animations.constEnd(); ++anim ) {
 
                 if (anim->startTime > clock() && !anim->waitAtSource)
                     continue;
@@ -595,11 +638,10 @@ void AnimationEffect::postPaintScreen()
         if (d->m_needSceneRepaint) {
             effects->addRepaintFull();
         } else {
-            AniMap::const_iterator it = d->m_animations.constBegin(), end = d->m_animations.constEnd();
-            for (; it != end; ++it) {
+            foreach (const AnimationEffectPrivate::AniEntry &entry, d->m_animations) {
                 bool addRepaint = false;
-                QList<AniData>::const_iterator anim = it->first.constBegin();
-                for (; anim != it->first.constEnd(); ++anim) {
+                QVector<AniData>::const_iterator anim = entry.animations.constBegin();
+                for (; anim != entry.animations.constEnd(); ++anim) {
                     if (anim->startTime > clock())
                         continue;
                     if (anim->time < anim->duration) {
@@ -608,7 +650,7 @@ void AnimationEffect::postPaintScreen()
                     }
                 }
                 if (addRepaint) {
-                    it.key()->addLayerRepaint(it->second);
+                    entry.window->addLayerRepaint(entry.layerRect);
                 }
             }
         }
@@ -621,7 +663,7 @@ float AnimationEffect::interpolated( const AniData &a, int i ) const
     if (a.startTime > clock())
         return a.from[i];
     if (a.time < a.duration)
-        return a.from[i] + a.curve.valueForProgress( ((float)a.time)/a.duration )*(a.to[i] - a.from[i]);
+        return a.from[i] + a.easedProgress()*(a.to[i] - a.from[i]);
     return a.to[i]; // we're done and "waiting" at the target value
 }
 
@@ -630,7 +672,7 @@ float AnimationEffect::progress( const AniData &a ) const
     if (a.startTime > clock())
         return 0.0;
     if (a.time < a.duration)
-        return a.curve.valueForProgress( ((float)a.time)/a.duration );
+        return a.easedProgress();
     return 1.0; // we're done and "waiting" at the target value
 }
 
@@ -698,15 +740,14 @@ void AnimationEffect::setMetaData( MetaType type, uint value, uint &meta )
 void AnimationEffect::triggerRepaint()
 {
     Q_D(AnimationEffect);
-    for (AniMap::const_iterator entry = d->m_animations.constBegin(), mapEnd = d->m_animations.constEnd(); entry != mapEnd; ++entry)
-        *const_cast<QRect*>(&(entry->second)) = QRect();
+    for (int e = 0; e < d->m_animations.count(); ++e)
+        d->m_animations[e].layerRect = QRect();
     updateLayerRepaints();
     if (d->m_needSceneRepaint) {
         effects->addRepaintFull();
     } else {
-        AniMap::const_iterator it = d->m_animations.constBegin(), end = d->m_animations.constEnd();
-        for (; it != end; ++it) {
-            it.key()->addLayerRepaint(it->second);
+        foreach (const AnimationEffectPrivate::AniEntry &entry, d->m_animations) {
+            entry.window->addLayerRepaint(entry.layerRect);
         }
     }
 }
@@ -733,15 +774,16 @@ void AnimationEffect::updateLayerRepaints()
 {
     Q_D(AnimationEffect);
     d->m_needSceneRepaint = false;
-    for (AniMap::const_iterator entry = d->m_animations.constBegin(), mapEnd = d->m_animations.constEnd(); entry != mapEnd; ++entry) {
-        if (!entry->second.isNull())
+    for (int e = 0; e < d->m_animations.count(); ++e) {
+        AnimationEffectPrivate::AniEntry *entry = &d->m_animations[e];
+        if (!entry->layerRect.isNull())
             continue;
         float f[2] = {1.0, 1.0};
         float t[2] = {0.0, 0.0};
         bool createRegion = false;
         QList<QRect> rects;
-        QRect *layerRect = const_cast<QRect*>(&(entry->second));
-        for (QList<AniData>::const_iterator anim = entry->first.constBegin(), animEnd = entry->first.constEnd(); anim != animEnd; ++anim) {
+        QRect *layerRect = &entry->layerRect;
+        for (QVector<AniData>::const_iterator anim = entry->animations.constBegin(), animEnd = entry->animations.constEnd(); anim != animEnd; ++anim) {
             if (anim->startTime > clock())
                 continue;
             switch (anim->attribute) {
@@ -762,7 +804,7 @@ void AnimationEffect::updateLayerRepaints()
                 case Translation:
                 case Position: {
                     createRegion = true;
-                    QRect r(entry.key()->geometry());
+                    QRect r(entry->window->geometry());
                     int x[2] = {0,0};
                     int y[2] = {0,0};
                     if (anim->attribute == Translation) {
@@ -780,7 +822,7 @@ void AnimationEffect::updateLayerRepaints()
                             y[1] = anim->to[1] - yCoord(r, metaData(TargetAnchor, anim->meta));
                         }
                     }
-                    r = entry.key()->expandedGeometry();
+                    r = entry->window->expandedGeometry();
                     rects << r.translated(x[0], y[0]) << r.translated(x[1], y[1]);
                     break;
                 }
@@ -790,7 +832,7 @@ void AnimationEffect::updateLayerRepaints()
                 case Size:
                 case Scale: {
                     createRegion = true;
-                    const QSize sz = entry.key()->geometry().size();
+                    const QSize sz = entry->window->geometry().size();
                     float fx = qMax(fixOvershoot(anim->from[0], *anim, 1), fixOvershoot(anim->to[0], *anim, 2));
 //                     float fx = qMax(interpolated(*anim,0), anim->to[0]);
                     if (fx >= 0.0) {
@@ -818,7 +860,7 @@ void AnimationEffect::updateLayerRepaints()
         }
 region_creation:
         if (createRegion) {
-            const QRect geo = entry.key()->expandedGeometry();
+            const QRect geo = entry->window->expandedGeometry();
             if (rects.isEmpty())
                 rects << geo;
             QList<QRect>::const_iterator r, rEnd = rects.constEnd();
@@ -844,19 +886,18 @@ void AnimationEffect::_expandedGeometryChanged(KWin::EffectWindow *w, const QRec
 {
     Q_UNUSED(old)
     Q_D(AnimationEffect);
-    AniMap::const_iterator entry = d->m_animations.constFind(w);
-    if (entry != d->m_animations.constEnd()) {
-        *const_cast<QRect*>(&(entry->second)) = QRect();
+    if (AnimationEffectPrivate::AniEntry *entry = d->find(w)) {
+        entry->layerRect = QRect();
         updateLayerRepaints();
-        if (!entry->second.isNull()) // actually got updated, ie. is in use - ensure it get's a repaint
-            w->addLayerRepaint(entry->second);
+        if (!entry->layerRect.isNull()) // actually got updated, ie. is in use - ensure it get's a repaint
+            w->addLayerRepaint(entry->layerRect);
     }
 }
 
 void AnimationEffect::_windowClosed( EffectWindow* w )
 {
     Q_D(AnimationEffect);
-    if (d->m_animations.contains(w) && !d->m_zombies.contains(w)) {
+    if (d->m_index.contains(w) && !d->m_zombies.contains(w)) {
         w->refWindow();
         d->m_zombies << w;
     }
@@ -866,7 +907,9 @@ void AnimationEffect::_windowDeleted( EffectWindow* w )
 {
     Q_D(AnimationEffect);
     d->m_zombies.removeAll( w ); // TODO this line is a workaround for a bug in KWin 4.8.0 & 4.8.1
-    d->m_animations.remove( w );
+    const int index = d->m_index.value(w, -1);
+    if (index != -1)
+        d->removeAt(index);
 }
 
 
@@ -877,13 +920,12 @@ QString AnimationEffect::debug(const QString &/*parameter*/) const
     if (d->m_animations.isEmpty())
         dbg = QStringLiteral("No window is animated");
     else {
-        AniMap::const_iterator entry = d->m_animations.constBegin(), mapEnd = d->m_animations.constEnd();
-        for (; entry != mapEnd; ++entry) {
-            QString caption = entry.key()->isDeleted() ? QStringLiteral("[Deleted]") : entry.key()->caption();
+        foreach (const AnimationEffectPrivate::AniEntry &entry, d->m_animations) {
+            QString caption = entry.window->isDeleted() ? QStringLiteral("[Deleted]") : entry.window->caption();
             if (caption.isEmpty())
                 caption = QStringLiteral("[Untitled]");
             dbg += QStringLiteral("Animating window: ") + caption + QStringLiteral("\n");
-            QList<AniData>::const_iterator anim = entry->first.constBegin(), animEnd = entry->first.constEnd();
+            QVector<AniData>::const_iterator anim = entry.animations.constBegin(), animEnd = entry.animations.constEnd();
             for (; anim != animEnd; ++anim)
                 dbg += anim->debugInfo();
         }
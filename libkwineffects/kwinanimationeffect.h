@@ -207,7 +207,6 @@ private Q_SLOTS:
     void _expandedGeometryChanged(KWin::EffectWindow *w, const QRect &old);
 private:
     static QElapsedTimer s_clock;
-    typedef QMap< EffectWindow*, QPair<QList<AniData>, QRect> > AniMap;
     AnimationEffectPrivate * const d_ptr;
     Q_DECLARE_PRIVATE(AnimationEffect)
 };
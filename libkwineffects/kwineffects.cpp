@@ -689,6 +689,16 @@ EffectWindow::~EffectWindow()
 {
 }
 
+WindowQuadList EffectWindow::cachedGrid(const WindowQuadList &quads, int maxQuadSize) const
+{
+    return quads.makeGrid(maxQuadSize);
+}
+
+WindowQuadList EffectWindow::cachedRegularGrid(const WindowQuadList &quads, int xSubdivisions, int ySubdivisions) const
+{
+    return quads.makeRegularGrid(xSubdivisions, ySubdivisions);
+}
+
 #define WINDOW_HELPER( rettype, prototype, propertyname ) \
     rettype EffectWindow::prototype ( ) const \
     { \
@@ -729,6 +739,21 @@ WINDOW_HELPER(QString, windowRole, "windowRole")
 WINDOW_HELPER(QStringList, activities, "activities")
 WINDOW_HELPER(bool, skipsCloseAnimation, "skipsCloseAnimation")
 
+bool EffectWindow::hasData(int role) const
+{
+    return data(role).isValid();
+}
+
+bool EffectWindow::dataFlag(int role) const
+{
+    return data(role).toBool();
+}
+
+void *EffectWindow::dataPointer(int role) const
+{
+    return data(role).value<void*>();
+}
+
 QString EffectWindow::windowClass() const
 {
     return parent()->property("resourceName").toString() + QStringLiteral(" ") + parent()->property("resourceClass").toString();
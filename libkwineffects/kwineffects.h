@@ -174,7 +174,7 @@ X-KDE-Library=kwin4_effect_cooleffect
 
 #define KWIN_EFFECT_API_MAKE_VERSION( major, minor ) (( major ) << 8 | ( minor ))
 #define KWIN_EFFECT_API_VERSION_MAJOR 0
-#define KWIN_EFFECT_API_VERSION_MINOR 224
+#define KWIN_EFFECT_API_VERSION_MINOR 226
 #define KWIN_EFFECT_API_VERSION KWIN_EFFECT_API_MAKE_VERSION( \
         KWIN_EFFECT_API_VERSION_MAJOR, KWIN_EFFECT_API_VERSION_MINOR )
 
@@ -210,7 +210,8 @@ enum DataRole {
     WindowBlurBehindRole, ///< For single windows to blur behind
     WindowForceBackgroundContrastRole, ///< For fullscreen effects to enforce the background contrast,
     WindowBackgroundContrastRole, ///< For single windows to enable Background contrast
-    LanczosCacheRole
+    LanczosCacheRole,
+    DataRoleCount ///< @internal Number of global roles with a fixed storage slot
 };
 
 /**
@@ -1829,6 +1830,20 @@ public:
      * Returns the unmodified window quad list. Can also be used to force rebuilding.
      */
     virtual WindowQuadList buildQuads(bool force = false) const = 0;
+    /**
+     * Returns @p quads split by WindowQuadList::makeGrid.
+     *
+     * If @p quads are the unmodified quads of the window, the subdivision is cached until the
+     * quads get rebuilt because of a geometry, shape or decoration change. Effects which deform
+     * a window every frame should use this method and only transform the vertices.
+     * @since 5.1
+     **/
+    virtual WindowQuadList cachedGrid(const WindowQuadList &quads, int maxQuadSize) const;
+    /**
+     * Like cachedGrid, but splits @p quads by WindowQuadList::makeRegularGrid.
+     * @since 5.1
+     **/
+    virtual WindowQuadList cachedRegularGrid(const WindowQuadList &quads, int xSubdivisions, int ySubdivisions) const;
 
     void setMinimized(bool minimize);
     void minimize();
@@ -1852,6 +1867,15 @@ public:
      */
     Q_SCRIPTABLE virtual void setData(int role, const QVariant &data) = 0;
     Q_SCRIPTABLE virtual QVariant data(int role) const = 0;
+    /**
+     * Typed access to the data of @p role, for use in paint passes. The results are the same as
+     * @c data(role).isValid(), @c data(role).toBool() and @c data(role).value<void*>(), but the
+     * global @ref DataRole values are read without a hash lookup or QVariant conversion.
+     * @since 5.1
+     **/
+    virtual bool hasData(int role) const;
+    virtual bool dataFlag(int role) const;
+    virtual void *dataPointer(int role) const;
 
     /**
      * @brief References the previous window pixmap to prevent discarding.
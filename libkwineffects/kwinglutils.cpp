@@ -33,7 +33,13 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QPixmap>
 #include <QImage>
 #include <QHash>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
 #include <QFile>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QTimer>
 #include <QVector2D>
 #include <QVector3D>
 #include <QVector4D>
@@ -62,6 +68,7 @@ static QStringList eglExtension;
 
 int glTextureUnitsCount;
 
+static void cleanupProgramBinaryCache();
 
 // Functions
 void initGLX()
@@ -136,6 +143,7 @@ void initGL(OpenGLPlatformInterface platformInterface)
 void cleanupGL()
 {
     ShaderManager::cleanup();
+    cleanupProgramBinaryCache();
     GLTexturePrivate::cleanup();
     GLRenderTarget::cleanup();
     GLVertexBuffer::cleanup();
@@ -214,6 +222,224 @@ int nearestPowerOfTwo(int x)
     return 1 << last;
 }
 
+//****************************************
+// ProgramBinaryCache
+//****************************************
+
+/**
+ * Keeps linked program binaries on disk, so that shaders do not have to be compiled again
+ * on the next start of the compositor. A binary is looked up by a hash over the driver
+ * strings, the prepared sources and the attribute bindings. If the driver rejects a binary,
+ * e.g. after an update which did not change the version string, the program is compiled
+ * and the cache entry replaced.
+ *
+ * Newly linked programs are not written while linking, which usually happens during a frame.
+ * Their binaries are retrieved after the frame through ShaderManager::storeProgramBinaries(),
+ * when the compositing context is known to be current, and written once the event loop gets
+ * idle. The cache lives in a directory per format version and keeps at most s_maximumEntries
+ * binaries, the oldest ones are removed first.
+ *
+ * The cache can be disabled by setting the environment variable KWIN_GL_PROGRAM_CACHE to 0.
+ **/
+class ProgramBinaryCache
+{
+public:
+    static bool isEnabled();
+    static QByteArray key(const QByteArray &vertexSource, const QByteArray &fragmentSource,
+                          const QByteArray &bindings);
+    static bool load(GLuint program, const QByteArray &key);
+    static void scheduleStore(GLuint program, const QByteArray &key);
+    static void cancelStore(GLuint program);
+    static void fetchPending();
+    static void cleanup();
+
+private:
+    struct Binary {
+        GLenum format;
+        QByteArray data;
+    };
+    static void writePending();
+    static void write(const QByteArray &key, const Binary &binary);
+    static void prune();
+    static QString directory();
+    static const quint32 s_magic = 0x4b575042; // KWPB
+    // increase when the file format changes, the directories of other versions get removed
+    static const int s_version = 1;
+    static const int s_maximumEntries = 128;
+    // programs linked since the last fetch by their key
+    static QHash<GLuint, QByteArray> s_pending;
+    // fetched binaries waiting to be written by their key
+    static QHash<QByteArray, Binary> s_binaries;
+    static QTimer *s_timer;
+    static bool s_pruned;
+};
+
+QHash<GLuint, QByteArray> ProgramBinaryCache::s_pending;
+QHash<QByteArray, ProgramBinaryCache::Binary> ProgramBinaryCache::s_binaries;
+QTimer *ProgramBinaryCache::s_timer = nullptr;
+bool ProgramBinaryCache::s_pruned = false;
+
+bool ProgramBinaryCache::isEnabled()
+{
+    static const bool enabled = qgetenv("KWIN_GL_PROGRAM_CACHE") != "0";
+    return enabled && glGetProgramBinary && glProgramBinary;
+}
+
+QString ProgramBinaryCache::directory()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) +
+           QStringLiteral("/kwin/programs/%1/").arg(s_version);
+}
+
+QByteArray ProgramBinaryCache::key(const QByteArray &vertexSource, const QByteArray &fragmentSource,
+                                   const QByteArray &bindings)
+{
+    const GLPlatform *platform = GLPlatform::instance();
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    foreach (const QByteArray &data, QList<QByteArray>() << platform->glVendorString()
+                                                         << platform->glRendererString()
+                                                         << platform->glVersionString()
+                                                         << bindings
+                                                         << vertexSource
+                                                         << fragmentSource) {
+        hash.addData(data);
+        hash.addData("\0", 1);
+    }
+    return hash.result().toHex();
+}
+
+bool ProgramBinaryCache::load(GLuint program, const QByteArray &key)
+{
+    QFile file(directory() + QString::fromLatin1(key));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QDataStream stream(&file);
+    quint32 magic = 0;
+    quint32 format = 0;
+    QByteArray binary;
+    stream >> magic >> format >> binary;
+    if (stream.status() != QDataStream::Ok || magic != s_magic || binary.isEmpty()) {
+        file.remove();
+        return false;
+    }
+    glProgramBinary(program, format, binary.constData(), binary.size());
+    int status = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &status);
+    if (status == 0) {
+        file.remove();
+        return false;
+    }
+    return true;
+}
+
+void ProgramBinaryCache::scheduleStore(GLuint program, const QByteArray &key)
+{
+    s_pending.insert(program, key);
+}
+
+void ProgramBinaryCache::cancelStore(GLuint program)
+{
+    s_pending.remove(program);
+}
+
+void ProgramBinaryCache::cleanup()
+{
+    s_pending.clear();
+    s_binaries.clear();
+    delete s_timer;
+    s_timer = nullptr;
+}
+
+static void cleanupProgramBinaryCache()
+{
+    ProgramBinaryCache::cleanup();
+}
+
+void ProgramBinaryCache::fetchPending()
+{
+    if (s_pending.isEmpty()) {
+        return;
+    }
+    for (auto it = s_pending.constBegin(); it != s_pending.constEnd(); ++it) {
+        int length = 0;
+        glGetProgramiv(it.key(), GL_PROGRAM_BINARY_LENGTH, &length);
+        if (length <= 0) {
+            continue;
+        }
+        Binary binary;
+        binary.format = 0;
+        binary.data = QByteArray(length, 0);
+        GLsizei written = 0;
+        glGetProgramBinary(it.key(), length, &written, &binary.format, binary.data.data());
+        if (written <= 0) {
+            continue;
+        }
+        binary.data.resize(written);
+        s_binaries.insert(it.value(), binary);
+    }
+    s_pending.clear();
+    if (s_binaries.isEmpty()) {
+        return;
+    }
+    // writing the files does not need the context, don't delay the next frame with it
+    if (!s_timer) {
+        s_timer = new QTimer;
+        s_timer->setSingleShot(true);
+        QObject::connect(s_timer, &QTimer::timeout, &ProgramBinaryCache::writePending);
+    }
+    s_timer->start(0);
+}
+
+void ProgramBinaryCache::writePending()
+{
+    for (auto it = s_binaries.constBegin(); it != s_binaries.constEnd(); ++it) {
+        write(it.key(), it.value());
+    }
+    s_binaries.clear();
+    prune();
+}
+
+void ProgramBinaryCache::prune()
+{
+    if (!s_pruned) {
+        // remove the caches written by other versions once
+        s_pruned = true;
+        QDir parent(directory());
+        if (parent.cdUp()) {
+            foreach (const QString &entry, parent.entryList(QDir::Dirs | QDir::NoDotAndDotDot)) {
+                if (entry != QString::number(s_version)) {
+                    QDir(parent.filePath(entry)).removeRecursively();
+                }
+            }
+            // binaries of the unversioned cache
+            foreach (const QString &entry, parent.entryList(QDir::Files)) {
+                parent.remove(entry);
+            }
+        }
+    }
+
+    QDir dir(directory());
+    const QFileInfoList entries = dir.entryInfoList(QDir::Files, QDir::Time);
+    for (int i = s_maximumEntries; i < entries.count(); ++i) {
+        QFile::remove(entries.at(i).absoluteFilePath());
+    }
+}
+
+void ProgramBinaryCache::write(const QByteArray &key, const Binary &binary)
+{
+    if (!QDir().mkpath(directory())) {
+        return;
+    }
+    QSaveFile file(directory() + QString::fromLatin1(key));
+    if (!file.open(QIODevice::WriteOnly)) {
+        return;
+    }
+    QDataStream stream(&file);
+    stream << s_magic << quint32(binary.format) << binary.data;
+    file.commit();
+}
+
 //****************************************
 // GLShader
 //****************************************
@@ -240,6 +466,7 @@ GLShader::GLShader(const QString& vertexfile, const QString& fragmentfile, unsig
 GLShader::~GLShader()
 {
     if (mProgram) {
+        ProgramBinaryCache::cancelStore(mProgram);
         glDeleteProgram(mProgram);
     }
 }
@@ -265,6 +492,45 @@ bool GLShader::loadFromFiles(const QString &vertexFile, const QString &fragmentF
 
 bool GLShader::link()
 {
+    mValid = false;
+
+    const QByteArray vertexSource = mVertexSource;
+    const QByteArray fragmentSource = mFragmentSource;
+    mVertexSource.clear();
+    mFragmentSource.clear();
+
+    QByteArray cacheKey;
+    if (ProgramBinaryCache::isEnabled() && (!vertexSource.isEmpty() || !fragmentSource.isEmpty())) {
+        cacheKey = ProgramBinaryCache::key(prepareSource(GL_VERTEX_SHADER, vertexSource),
+                                           prepareSource(GL_FRAGMENT_SHADER, fragmentSource),
+                                           mBindings);
+        if (ProgramBinaryCache::load(mProgram, cacheKey)) {
+            mValid = true;
+            return mValid;
+        }
+    }
+
+    // Compile the vertex shader
+    if (!vertexSource.isEmpty()) {
+        bool success = compile(mProgram, GL_VERTEX_SHADER, vertexSource);
+
+        if (!success)
+            return false;
+    }
+
+    // Compile the fragment shader
+    if (!fragmentSource.isEmpty()) {
+        bool success = compile(mProgram, GL_FRAGMENT_SHADER, fragmentSource);
+
+        if (!success)
+            return false;
+    }
+
+#ifndef KWIN_HAVE_OPENGLES
+    if (!cacheKey.isEmpty() && glProgramParameteri)
+        glProgramParameteri(mProgram, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+#endif
+
     // Be optimistic
     mValid = true;
 
@@ -288,6 +554,9 @@ bool GLShader::link()
         qDebug() << "Shader link log:" << log;
     }
 
+    if (mValid && !cacheKey.isEmpty())
+        ProgramBinaryCache::scheduleStore(mProgram, cacheKey);
+
     return mValid;
 }
 
@@ -364,21 +633,10 @@ bool GLShader::load(const QByteArray &vertexSource, const QByteArray &fragmentSo
 
     mValid = false;
 
-    // Compile the vertex shader
-    if (!vertexSource.isEmpty()) {
-        bool success = compile(mProgram, GL_VERTEX_SHADER, vertexSource);
-
-        if (!success)
-            return false;
-    }
-
-    // Compile the fragment shader
-    if (!fragmentSource.isEmpty()) {
-        bool success = compile(mProgram, GL_FRAGMENT_SHADER, fragmentSource);
-
-        if (!success)
-            return false;
-    }
+    // The sources are compiled by link(), unless a cached binary of the program exists.
+    // With explicit linking compile errors are therefore only reported by link().
+    mVertexSource = vertexSource;
+    mFragmentSource = fragmentSource;
 
     if (mExplicitLinking)
         return true;
@@ -390,13 +648,16 @@ bool GLShader::load(const QByteArray &vertexSource, const QByteArray &fragmentSo
 void GLShader::bindAttributeLocation(const char *name, int index)
 {
     glBindAttribLocation(mProgram, index, name);
+    mBindings += "attribute " + QByteArray(name) + ' ' + QByteArray::number(index) + '\n';
 }
 
 void GLShader::bindFragDataLocation(const char *name, int index)
 {
 #ifndef KWIN_HAVE_OPENGLES
-    if (glBindFragDataLocation)
+    if (glBindFragDataLocation) {
         glBindFragDataLocation(mProgram, index, name);
+        mBindings += "fragdata " + QByteArray(name) + ' ' + QByteArray::number(index) + '\n';
+    }
 #else
     Q_UNUSED(name)
     Q_UNUSED(index)
@@ -642,6 +903,13 @@ void ShaderManager::cleanup()
     s_shaderManager = nullptr;
 }
 
+void ShaderManager::storeProgramBinaries()
+{
+    if (ProgramBinaryCache::isEnabled()) {
+        ProgramBinaryCache::fetchPending();
+    }
+}
+
 ShaderManager::ShaderManager()
     : m_inited(false)
     , m_valid(false)
@@ -660,6 +928,7 @@ ShaderManager::~ShaderManager()
 
     for (int i = 0; i < 3; i++)
         delete m_shader[i];
+    qDeleteAll(m_shaderVariants);
 }
 
 GLShader *ShaderManager::getBoundShader() const
@@ -700,6 +969,76 @@ GLShader *ShaderManager::pushShader(ShaderType type, bool reset)
     return m_shader[type];
 }
 
+GLShader *ShaderManager::pushShaderVariant(ShaderType type, int traits, bool reset)
+{
+    if (m_inited && !m_valid) {
+        return nullptr;
+    }
+    if (type == ColorShader) {
+        // the color shader does not sample a texture, there is nothing to specialize
+        return pushShader(type, reset);
+    }
+
+    const int key = (traits << 2) | type;
+    auto it = m_shaderVariants.constFind(key);
+    if (it == m_shaderVariants.constEnd()) {
+        it = m_shaderVariants.insert(key, loadShaderVariant(type, traits));
+    }
+    GLShader *shader = it.value();
+    if (!shader) {
+        // the variant failed to compile, the generic shader handles all traits
+        return pushShader(type, reset);
+    }
+
+    pushShader(shader);
+    if (reset) {
+        resetShader(type);
+    }
+
+    return shader;
+}
+
+GLShader *ShaderManager::loadShaderVariant(ShaderType type, int traits)
+{
+    const char *vertexFile[] = {
+        "scene-vertex.glsl",
+        "scene-generic-vertex.glsl"
+    };
+
+    QFile vertexShader(QString::fromUtf8(m_shaderDir + vertexFile[type]));
+    QFile fragmentShader(QString::fromUtf8(m_shaderDir + "scene-fragment.glsl"));
+    if (!vertexShader.open(QIODevice::ReadOnly) || !fragmentShader.open(QIODevice::ReadOnly)) {
+        return nullptr;
+    }
+
+    // the define has to follow the #version directive
+    QByteArray fragmentSource = fragmentShader.readAll();
+    const QByteArray define = QByteArrayLiteral("#define KWIN_SATURATION ") +
+                              ((traits & SaturationTrait) ? '1' : '0') + '\n';
+    int pos = 0;
+    if (fragmentSource.startsWith("#version")) {
+        pos = fragmentSource.indexOf('\n') + 1;
+    }
+    fragmentSource.insert(pos, define);
+
+    GLShader *shader = new GLShader(GLShader::ExplicitLinking);
+    shader->load(vertexShader.readAll(), fragmentSource);
+    bindAttributeLocations(shader);
+    bindFragDataLocations(shader);
+    shader->link();
+
+    if (!shader->isValid()) {
+        delete shader;
+        return nullptr;
+    }
+
+    pushShader(shader);
+    resetShader(type);
+    popShader();
+
+    return shader;
+}
+
 void ShaderManager::resetAllShaders()
 {
     if (!m_inited || !m_valid) {
@@ -710,6 +1049,10 @@ void ShaderManager::resetAllShaders()
         pushShader(ShaderType(i), true);
         popShader();
     }
+
+    for (auto it = m_shaderVariants.constBegin(); it != m_shaderVariants.constEnd(); ++it) {
+        resetShader(it.value(), ShaderType(it.key() & 3));
+    }
 }
 
 void ShaderManager::resetShader(GLShader *shader, ShaderType type)
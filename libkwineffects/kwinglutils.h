@@ -28,6 +28,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "kwingltexture.h"
 
 // Qt
+#include <QByteArray>
+#include <QHash>
 #include <QSize>
 #include <QStack>
 
@@ -39,8 +41,6 @@ class QVector3D;
 class QVector4D;
 class QMatrix4x4;
 
-template< class K, class V > class QHash;
-
 
 namespace KWin
 {
@@ -175,6 +175,12 @@ public:
 protected:
     GLShader(unsigned int flags = NoFlags);
     bool loadFromFiles(const QString& vertexfile, const QString& fragmentfile);
+    /**
+     * Sets the sources of the program and links it unless ExplicitLinking is used.
+     * The sources are only compiled by link(), which first tries a cached binary of the program.
+     * Thus with ExplicitLinking @c true is returned without compiling anything and compile
+     * errors make link() fail instead.
+     **/
     bool load(const QByteArray &vertexSource, const QByteArray &fragmentSource);
     const QByteArray prepareSource(GLenum shaderType, const QByteArray &sourceCode) const;
     bool compile(GLuint program, GLenum shaderType, const QByteArray &sourceCode) const;
@@ -187,6 +193,10 @@ private:
     bool mValid:1;
     bool mLocationsResolved:1;
     bool mExplicitLinking:1;
+    // compiling is deferred to link(), which first tries a cached program binary
+    QByteArray mVertexSource;
+    QByteArray mFragmentSource;
+    QByteArray mBindings;
     int mMatrixLocation[MatrixCount];
     int mVec2Location[Vec2UniformCount];
     int mVec4Location[Vec4UniformCount];
@@ -273,6 +283,22 @@ public:
      **/
     bool isShaderDebug() const;
 
+    /**
+     * Traits a variant of a built-in shader is compiled for.
+     * @see pushShaderVariant
+     * @since 5.1
+     **/
+    enum ShaderTrait {
+        /**
+         * The variant ignores the @c saturation uniform, which has to be @c 1.0.
+         **/
+        NoTraits = 0,
+        /**
+         * The variant always applies the @c saturation uniform.
+         **/
+        SaturationTrait = 1 << 0
+    };
+
     /**
      * Binds the shader of specified @p type.
      * To unbind the shader use @link popShader. A previous bound shader will be rebound.
@@ -282,6 +308,20 @@ public:
      * @see popShader
      **/
     GLShader *pushShader(ShaderType type, bool reset = false);
+    /**
+     * Binds a variant of the built-in shader of specified @p type which is specialized for
+     * @p traits at compile time instead of checking the uniforms for each fragment.
+     * The variants are compiled on first use. Only the SimpleShader and the GenericShader
+     * have variants, for other types the built-in shader is bound.
+     * To unbind the shader use @link popShader. A previous bound shader will be rebound.
+     * @param type The built-in shader to bind a variant of
+     * @param traits The ShaderTrait flags the variant is compiled for
+     * @param reset Whether all uniforms should be reset to their default values
+     * @return The bound shader or @c NULL if shaders are not valid
+     * @see popShader
+     * @since 5.1
+     **/
+    GLShader *pushShaderVariant(ShaderType type, int traits, bool reset = false);
     /**
      * Binds the @p shader.
      * To unbind the shader use @link popShader. A previous bound shader will be rebound.
@@ -345,6 +385,14 @@ public:
      * @internal
      **/
     static void cleanup();
+    /**
+     * Retrieves the binaries of the programs linked since the last call for the on disk
+     * program cache. The compositing OpenGL context has to be current, the scene calls it
+     * after each frame.
+     * @internal
+     * @since 5.1
+     **/
+    static void storeProgramBinaries();
 
 private:
     ShaderManager();
@@ -354,9 +402,12 @@ private:
     void resetShader(ShaderType type);
     void bindFragDataLocations(GLShader *shader);
     void bindAttributeLocations(GLShader *shader) const;
+    GLShader *loadShaderVariant(ShaderType type, int traits);
 
     QStack<GLShader*> m_boundShaders;
     GLShader *m_shader[3];
+    // variants by (traits << 2 | type), null if the variant failed to compile
+    QHash<int, GLShader*> m_shaderVariants;
     bool m_inited;
     bool m_valid;
     bool m_debug;
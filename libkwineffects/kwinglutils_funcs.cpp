@@ -205,6 +205,11 @@ glDrawElementsInstancedBaseVertex_func glDrawElementsInstancedBaseVertex;
 // GL_ARB_copy_buffer
 glCopyBufferSubData_func glCopyBufferSubData;
 
+// GL_ARB_get_program_binary
+glGetProgramBinary_func  glGetProgramBinary;
+glProgramBinary_func     glProgramBinary;
+glProgramParameteri_func glProgramParameteri;
+
 
 static glXFuncPtr getProcAddress(const char* name)
 {
@@ -291,6 +296,10 @@ glEGLImageTargetTexture2DOES_func glEGLImageTargetTexture2DOES;
 glGetGraphicsResetStatus_func glGetGraphicsResetStatus;
 glReadnPixels_func            glReadnPixels;
 glGetnUniformfv_func          glGetnUniformfv;
+
+// GL_OES_get_program_binary
+glGetProgramBinary_func glGetProgramBinary;
+glProgramBinary_func    glProgramBinary;
 #endif
 
 void eglResolveFunctions()
@@ -721,6 +730,17 @@ void glResolveFunctions(OpenGLPlatformInterface platformInterface)
         glCopyBufferSubData = nullptr;
     }
 
+    if (hasGLVersion(4, 1) || hasGLExtension(QStringLiteral("GL_ARB_get_program_binary"))) {
+        // See http://www.opengl.org/registry/specs/ARB/get_program_binary.txt
+        GL_RESOLVE(glGetProgramBinary);
+        GL_RESOLVE(glProgramBinary);
+        GL_RESOLVE(glProgramParameteri);
+    } else {
+        glGetProgramBinary  = nullptr;
+        glProgramBinary     = nullptr;
+        glProgramParameteri = nullptr;
+    }
+
 #else
 
     if (hasGLExtension(QStringLiteral("GL_OES_mapbuffer"))) {
@@ -760,6 +780,15 @@ void glResolveFunctions(OpenGLPlatformInterface platformInterface)
         glGetnUniformfv          = KWin::GetnUniformfv;
     }
 
+    if (hasGLExtension(QStringLiteral("GL_OES_get_program_binary"))) {
+        // See http://www.khronos.org/registry/gles/extensions/OES/OES_get_program_binary.txt
+        glGetProgramBinary = (glGetProgramBinary_func) eglGetProcAddress("glGetProgramBinaryOES");
+        glProgramBinary    = (glProgramBinary_func)    eglGetProcAddress("glProgramBinaryOES");
+    } else {
+        glGetProgramBinary = nullptr;
+        glProgramBinary    = nullptr;
+    }
+
 #endif // KWIN_HAVE_OPENGLES
 
 #ifdef KWIN_HAVE_EGL
@@ -469,6 +469,22 @@ typedef void (*glCopyBufferSubData_func)(GLenum readTarget, GLenum writeTarget,
 
 extern KWINGLUTILS_EXPORT glCopyBufferSubData_func glCopyBufferSubData;
 
+// GL_ARB_get_program_binary
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#endif
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH           0x8741
+#endif
+
+typedef void (*glGetProgramBinary_func)(GLuint program, GLsizei bufSize, GLsizei *length, GLenum *binaryFormat, GLvoid *binary);
+typedef void (*glProgramBinary_func)(GLuint program, GLenum binaryFormat, const GLvoid *binary, GLsizei length);
+typedef void (*glProgramParameteri_func)(GLuint program, GLenum pname, GLint value);
+
+extern KWINGLUTILS_EXPORT glGetProgramBinary_func  glGetProgramBinary;
+extern KWINGLUTILS_EXPORT glProgramBinary_func     glProgramBinary;
+extern KWINGLUTILS_EXPORT glProgramParameteri_func glProgramParameteri;
+
 } // namespace
 
 #endif // not KWIN_HAVE_OPENGLES
@@ -597,6 +613,17 @@ extern KWINGLUTILS_EXPORT glGetGraphicsResetStatus_func glGetGraphicsResetStatus
 extern KWINGLUTILS_EXPORT glReadnPixels_func            glReadnPixels;
 extern KWINGLUTILS_EXPORT glGetnUniformfv_func          glGetnUniformfv;
 
+// GL_OES_get_program_binary
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+
+typedef void (*glGetProgramBinary_func)(GLuint program, GLsizei bufSize, GLsizei *length, GLenum *binaryFormat, GLvoid *binary);
+typedef void (*glProgramBinary_func)(GLuint program, GLenum binaryFormat, const GLvoid *binary, GLint length);
+
+extern KWINGLUTILS_EXPORT glGetProgramBinary_func glGetProgramBinary;
+extern KWINGLUTILS_EXPORT glProgramBinary_func    glProgramBinary;
+
 #endif // KWIN_HAVE_OPENGLES
 
 } // namespace
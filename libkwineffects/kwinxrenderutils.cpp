@@ -21,9 +21,12 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "kwinxrenderutils.h"
 
 #include <QDebug>
+#include <QImage>
 #include <QStack>
 #include <QPixmap>
 
+#include <cstring>
+
 namespace KWin
 {
 
@@ -32,12 +35,64 @@ namespace XRenderUtils
 static xcb_connection_t *s_connection = nullptr;
 static xcb_window_t s_rootWindow = XCB_WINDOW_NONE;
 
+static XRenderImageUploader *s_uploader = nullptr;
+
 void init(xcb_connection_t *connection, xcb_window_t rootWindow)
 {
     s_connection = connection;
     s_rootWindow = rootWindow;
 }
 
+void setImageUploader(XRenderImageUploader *uploader)
+{
+    s_uploader = uploader;
+}
+
+void putImage(xcb_drawable_t drawable, xcb_gcontext_t gc, uint8_t depth,
+              const QImage &image, const QRect &source, const QPoint &target)
+{
+    const QRect rect = source & image.rect();
+    if (rect.isEmpty()) {
+        return;
+    }
+    if (image.depth() < 8) {
+        // bitmaps are only supported as a whole
+        Q_ASSERT(rect == image.rect());
+        xcb_put_image(s_connection, XCB_IMAGE_FORMAT_Z_PIXMAP, drawable, gc, image.width(), image.height(),
+                      target.x(), target.y(), 0, depth, image.byteCount(), image.constBits());
+        return;
+    }
+    const QPoint dest = target + rect.topLeft() - source.topLeft();
+    if (s_uploader && s_uploader->upload(drawable, gc, depth, image, rect, dest)) {
+        return;
+    }
+    xcb_connection_t *c = s_connection;
+    const int bytesPerPixel = image.depth() / 8;
+    // scanlines are padded to 32 bits
+    const int rowBytes = (rect.width() * bytesPerPixel + 3) & ~3;
+    const uint32_t maxBytes = xcb_get_maximum_request_length(c) * 4 - sizeof(xcb_put_image_request_t);
+    const int rowsPerRequest = qMax(1, int(maxBytes / rowBytes));
+    // complete scanlines can be sent directly out of the image
+    const bool contiguous = rect.x() == 0 && rect.width() == image.width() && image.bytesPerLine() == rowBytes;
+    QByteArray buffer;
+    for (int y = 0; y < rect.height(); y += rowsPerRequest) {
+        const int rows = qMin(rowsPerRequest, rect.height() - y);
+        const uchar *data = nullptr;
+        if (contiguous) {
+            data = image.constScanLine(rect.y() + y);
+        } else {
+            buffer.resize(rows * rowBytes);
+            for (int i = 0; i < rows; ++i) {
+                memcpy(buffer.data() + i * rowBytes, image.constScanLine(rect.y() + y + i) + rect.x() * bytesPerPixel,
+                       rect.width() * bytesPerPixel);
+            }
+            data = reinterpret_cast<const uchar*>(buffer.constData());
+        }
+        xcb_put_image(c, XCB_IMAGE_FORMAT_Z_PIXMAP, drawable, gc, rect.width(), rows,
+                      dest.x(), dest.y() + y, 0, depth, rows * rowBytes, data);
+    }
+}
+
 } // namespace
 
 // adapted from Qt, because this really sucks ;)
@@ -77,16 +132,17 @@ XRenderPicture xRenderFill(const QColor &c)
 
 XRenderPicture xRenderBlendPicture(double opacity)
 {
-    static XRenderPicture s_blendPicture(XCB_RENDER_PICTURE_NONE);
-    static xcb_render_color_t s_blendColor = {0, 0, 0, 0};
-    s_blendColor.alpha = uint16_t(opacity * 0xffff);
-    if (s_blendPicture == XCB_RENDER_PICTURE_NONE) {
-        s_blendPicture = xRenderFill(s_blendColor);
-    } else {
-        xcb_rectangle_t rect = {0, 0, 1, 1};
-        xcb_render_fill_rectangles(XRenderUtils::s_connection, XCB_RENDER_PICT_OP_SRC, s_blendPicture, s_blendColor, 1, &rect);
+    // The fill has only eight bits of alpha, so there are at most 256 distinct blend pictures.
+    // Each one is created when it is first needed and then kept, instead of refilling a single
+    // picture on every call.
+    static XRenderPicture s_blendPictures[256];
+    const int alpha = qBound(0, qRound(opacity * 0xff), 0xff);
+    XRenderPicture &picture = s_blendPictures[alpha];
+    if (picture == XCB_RENDER_PICTURE_NONE) {
+        const xcb_render_color_t color = {0, 0, 0, uint16_t(alpha | alpha << 8)};
+        picture = xRenderFill(color);
     }
-    return s_blendPicture;
+    return picture;
 }
 
 static xcb_render_picture_t createPicture(xcb_pixmap_t pix, int depth)
@@ -125,21 +181,55 @@ XRenderPicture::XRenderPicture(const QImage &img)
     fromImage(img);
 }
 
+/**
+ * The X depth of the pixmap holding @p img, QImage::depth() is the bits per pixel.
+ **/
+static int pixmapDepth(const QImage &img)
+{
+    switch (img.format()) {
+    case QImage::Format_RGB32:
+        return 24;
+    case QImage::Format_ARGB32_Premultiplied:
+        return 32;
+    default:
+        return img.depth();
+    }
+}
+
 void XRenderPicture::fromImage(const QImage &img)
 {
     xcb_connection_t *c = XRenderUtils::s_connection;
-    const int depth = img.depth();
+    const int depth = pixmapDepth(img);
     xcb_pixmap_t xpix = xcb_generate_id(c);
     xcb_create_pixmap(c, depth, xpix, XRenderUtils::s_rootWindow, img.width(), img.height());
 
     xcb_gcontext_t cid = xcb_generate_id(c);
     xcb_create_gc(c, cid, xpix, 0, nullptr);
-    xcb_put_image(c, XCB_IMAGE_FORMAT_Z_PIXMAP, xpix, cid, img.width(), img.height(),
-                  0, 0, 0, depth, img.byteCount(), img.constBits());
+    XRenderUtils::putImage(xpix, cid, depth, img, img.rect(), QPoint(0, 0));
     xcb_free_gc(c, cid);
 
     d = new XRenderPictureData(createPicture(xpix, depth));
-    xcb_free_pixmap(c, xpix);
+    d->pixmap = xpix;
+    d->size = img.size();
+    d->depth = depth;
+}
+
+void XRenderPicture::update(const QImage &img)
+{
+    if (d->pixmap == XCB_PIXMAP_NONE || d->ref.load() > 1 ||
+            d->size != img.size() || d->depth != pixmapDepth(img)) {
+        fromImage(img);
+        return;
+    }
+    xcb_connection_t *c = XRenderUtils::s_connection;
+    xcb_gcontext_t cid = xcb_generate_id(c);
+    xcb_create_gc(c, cid, d->pixmap, 0, nullptr);
+    XRenderUtils::putImage(d->pixmap, cid, d->depth, img, img.rect(), QPoint(0, 0));
+    xcb_free_gc(c, cid);
+}
+
+XRenderImageUploader::~XRenderImageUploader()
+{
 }
 
 XRenderPicture::XRenderPicture(xcb_pixmap_t pix, int depth)
@@ -151,6 +241,8 @@ XRenderPictureData::~XRenderPictureData()
 {
     if (picture != XCB_RENDER_PICTURE_NONE)
         xcb_render_free_picture(XRenderUtils::s_connection, picture);
+    if (pixmap != XCB_PIXMAP_NONE)
+        xcb_free_pixmap(XRenderUtils::s_connection, pixmap);
 }
 
 XFixesRegion::XFixesRegion(const QRegion &region)
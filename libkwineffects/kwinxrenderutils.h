@@ -26,11 +26,13 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 // Qt
 #include <QExplicitlySharedDataPointer>
 #include <QRegion>
+#include <QSize>
 #include <QVector>
 // XCB
 #include <xcb/xfixes.h>
 
 class QColor;
+class QImage;
 class QPixmap;
 
 /** @addtogroup kwineffects */
@@ -52,7 +54,12 @@ public:
     ~XRenderPictureData();
     xcb_render_picture_t value();
 private:
+    friend class XRenderPicture;
     xcb_render_picture_t picture;
+    // the pixmap of a picture created from an image, kept to upload new content into it
+    xcb_pixmap_t pixmap;
+    QSize size;
+    int depth;
     Q_DISABLE_COPY(XRenderPictureData)
 };
 
@@ -70,6 +77,11 @@ public:
     explicit XRenderPicture(const QImage &img);
     XRenderPicture(xcb_pixmap_t pix, int depth);
     operator xcb_render_picture_t();
+    /**
+     * Replaces the content of the picture by @p img. If the picture got created from an image
+     * of the same size and depth and is not shared, its pixmap and picture are reused.
+     **/
+    void update(const QImage &img);
 private:
     void fromImage(const QImage &img);
     QExplicitlySharedDataPointer< XRenderPictureData > d;
@@ -89,6 +101,8 @@ private:
 inline
 XRenderPictureData::XRenderPictureData(xcb_render_picture_t pic)
     : picture(pic)
+    , pixmap(XCB_PIXMAP_NONE)
+    , depth(0)
 {
 }
 
@@ -118,7 +132,8 @@ XFixesRegion::operator xcb_xfixes_region_t()
 
 /**
  * Static 1x1 picture used to deliver a black pixel with given opacity (for blending performance)
- * Call and Use, the PixelPicture will stay, but may change it's opacity meanwhile. It's NOT threadsafe either
+ * The opacity is quantized to 8 bit and there is one cached picture per value, so the returned
+ * picture keeps its opacity. It's NOT threadsafe either
  */
 KWINXRENDERUTILS_EXPORT XRenderPicture xRenderBlendPicture(double opacity);
 /**
@@ -163,12 +178,43 @@ KWINXRENDERUTILS_EXPORT void scene_setXRenderOffscreenTarget(xcb_render_picture_
  */
 KWINXRENDERUTILS_EXPORT XRenderPicture *scene_xRenderOffscreenTarget();
 
+/**
+ * @internal
+ * @short Interface for a faster way to upload images installed by the compositor.
+ **/
+class KWINXRENDERUTILS_EXPORT XRenderImageUploader
+{
+public:
+    virtual ~XRenderImageUploader();
+    /**
+     * Uploads the @p source rectangle of @p image to @p target in @p drawable.
+     * @returns @c false if the image cannot be uploaded, PutImage requests are used then.
+     **/
+    virtual bool upload(xcb_drawable_t drawable, xcb_gcontext_t gc, uint8_t depth,
+                        const QImage &image, const QRect &source, const QPoint &target) = 0;
+};
+
 namespace XRenderUtils
 {
 /**
  * @internal
  **/
 KWINXRENDERUTILS_EXPORT void init(xcb_connection_t *connection, xcb_window_t rootWindow);
+/**
+ * @internal
+ * Installs the @p uploader used by putImage, @c nullptr to go back to PutImage requests.
+ **/
+KWINXRENDERUTILS_EXPORT void setImageUploader(XRenderImageUploader *uploader);
+/**
+ * Uploads the @p source rectangle of @p image to @p target in @p drawable of the given
+ * @p depth. Only the sub rectangle is transferred, the image is not copied if it can be
+ * avoided. Uses the uploader installed by the compositor, otherwise the data is split into
+ * PutImage requests not exceeding the maximum request length.
+ *
+ * Images with less than 8 bits per pixel can only be uploaded as a whole.
+ **/
+KWINXRENDERUTILS_EXPORT void putImage(xcb_drawable_t drawable, xcb_gcontext_t gc, uint8_t depth,
+                                      const QImage &image, const QRect &source, const QPoint &target);
 }
 
 } // namespace
@@ -35,6 +35,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "group.h"
 #include "netinfo.h"
 #include "screens.h"
+#include "timingstatistics.h"
 #include "workspace.h"
 #include "xcbutils.h"
 
@@ -50,6 +51,7 @@ namespace KWin
  */
 bool Client::manage(xcb_window_t w, bool isMapped)
 {
+    TimingStatistics::Measurement measurement(TimingStatistics::Manage);
     StackingUpdatesBlocker stacking_blocker(workspace());
 
     grabXServer();
@@ -0,0 +1,147 @@
+/********************************************************************
+ KWin - the KDE window manager
+ This file is part of the KDE project.
+
+Copyright (C) 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#include "occupancymap.h"
+
+#include <algorithm>
+
+namespace KWin
+{
+
+OccupancyMap::OccupancyMap()
+{
+}
+
+void OccupancyMap::addRect(const QRect &rect, int weight)
+{
+    if (rect.isEmpty() || weight == 0) {
+        return;
+    }
+    WeightedRect r;
+    r.rect = rect;
+    r.weight = weight;
+    m_rects << r;
+}
+
+static void sortUnique(QVector<int> &values)
+{
+    std::sort(values.begin(), values.end());
+    values.erase(std::unique(values.begin(), values.end()), values.end());
+}
+
+int OccupancyMap::cell(const QVector<int> &edges, int position)
+{
+    return std::lower_bound(edges.constBegin(), edges.constEnd(), position) - edges.constBegin();
+}
+
+void OccupancyMap::build()
+{
+    m_xEdges.clear();
+    m_yEdges.clear();
+    foreach (const WeightedRect &r, m_rects) {
+        m_xEdges << r.rect.x() << r.rect.x() + r.rect.width();
+        m_yEdges << r.rect.y() << r.rect.y() + r.rect.height();
+    }
+    sortUnique(m_xEdges);
+    sortUnique(m_yEdges);
+    const int columns = m_xEdges.size();
+    const int rows = m_yEdges.size();
+
+    // difference array of the weights, the prefix sum turns it into the density of each cell
+    m_density.fill(0, columns * rows);
+    foreach (const WeightedRect &r, m_rects) {
+        const int left = cell(m_xEdges, r.rect.x());
+        const int right = cell(m_xEdges, r.rect.x() + r.rect.width());
+        const int top = cell(m_yEdges, r.rect.y());
+        const int bottom = cell(m_yEdges, r.rect.y() + r.rect.height());
+        m_density[top * columns + left] += r.weight;
+        m_density[top * columns + right] -= r.weight;
+        m_density[bottom * columns + left] -= r.weight;
+        m_density[bottom * columns + right] += r.weight;
+    }
+    for (int j = 0; j < rows; ++j) {
+        for (int i = 0; i < columns; ++i) {
+            qint64 &d = m_density[j * columns + i];
+            if (i > 0) {
+                d += m_density[j * columns + i - 1];
+            }
+            if (j > 0) {
+                d += m_density[(j - 1) * columns + i];
+            }
+            if (i > 0 && j > 0) {
+                d -= m_density[(j - 1) * columns + i - 1];
+            }
+        }
+    }
+
+    // m_sums at grid point (i, j) is the weighted area left of m_xEdges[i] and above m_yEdges[j]
+    m_sums.fill(0, columns * rows);
+    for (int j = 1; j < rows; ++j) {
+        const qint64 height = m_yEdges[j] - m_yEdges[j - 1];
+        for (int i = 1; i < columns; ++i) {
+            const qint64 width = m_xEdges[i] - m_xEdges[i - 1];
+            m_sums[j * columns + i] = m_sums[j * columns + i - 1]
+                                    + m_sums[(j - 1) * columns + i]
+                                    - m_sums[(j - 1) * columns + i - 1]
+                                    + m_density[(j - 1) * columns + i - 1] * width * height;
+        }
+    }
+}
+
+qint64 OccupancyMap::integral(int x, int y) const
+{
+    if (m_xEdges.isEmpty() || x <= m_xEdges.first() || y <= m_yEdges.first()) {
+        return 0;
+    }
+    x = qMin(x, m_xEdges.last());
+    y = qMin(y, m_yEdges.last());
+    const int columns = m_xEdges.size();
+    // the grid point at or left of x, the cell right of it contains x
+    int i = cell(m_xEdges, x);
+    if (m_xEdges[i] > x) {
+        --i;
+    }
+    int j = cell(m_yEdges, y);
+    if (m_yEdges[j] > y) {
+        --j;
+    }
+    const qint64 dx = x - m_xEdges[i];
+    const qint64 dy = y - m_yEdges[j];
+    qint64 sum = m_sums[j * columns + i];
+    if (dx) {
+        // area of the column left of x and above the grid row j
+        const qint64 width = m_xEdges[i + 1] - m_xEdges[i];
+        sum += (m_sums[j * columns + i + 1] - m_sums[j * columns + i]) / width * dx;
+    }
+    if (dy) {
+        const qint64 height = m_yEdges[j + 1] - m_yEdges[j];
+        sum += (m_sums[(j + 1) * columns + i] - m_sums[j * columns + i]) / height * dy;
+    }
+    if (dx && dy) {
+        sum += m_density[j * columns + i] * dx * dy;
+    }
+    return sum;
+}
+
+qint64 OccupancyMap::overlap(int left, int top, int right, int bottom) const
+{
+    return integral(right, bottom) - integral(left, bottom) - integral(right, top) + integral(left, top);
+}
+
+} // namespace
@@ -0,0 +1,83 @@
+/********************************************************************
+ KWin - the KDE window manager
+ This file is part of the KDE project.
+
+Copyright (C) 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+
+#ifndef KWIN_OCCUPANCYMAP_H
+#define KWIN_OCCUPANCYMAP_H
+
+#include <QRect>
+#include <QVector>
+
+namespace KWin
+{
+
+/**
+ * @short Weighted summed-area table of the windows on a desktop.
+ *
+ * Each added rectangle covers the area with its weight. After build() the map answers how
+ * much weighted area of all rectangles lies inside a query rectangle in constant time plus
+ * two binary searches. Overlapping rectangles are counted individually, i.e. the result is
+ * the sum of the weighted intersections with each rectangle.
+ *
+ * The table is built on the coordinates of the rectangle edges, so its size only depends on
+ * the number of rectangles and not on the size of the screen.
+ **/
+class OccupancyMap
+{
+public:
+    OccupancyMap();
+
+    /**
+     * Adds @p rect with @p weight. Has to be called before build().
+     **/
+    void addRect(const QRect &rect, int weight);
+    /**
+     * Computes the summed-area table of all added rectangles.
+     **/
+    void build();
+
+    /**
+     * @returns The weighted area of all rectangles inside the area from (@p left, @p top)
+     * to (@p right, @p bottom), excluding the right and bottom edge.
+     **/
+    qint64 overlap(int left, int top, int right, int bottom) const;
+
+private:
+    struct WeightedRect {
+        QRect rect;
+        int weight;
+    };
+    /**
+     * Weighted area of all rectangles left of @p x and above @p y.
+     **/
+    qint64 integral(int x, int y) const;
+    static int cell(const QVector<int> &edges, int position);
+
+    QVector<WeightedRect> m_rects;
+    QVector<int> m_xEdges;
+    QVector<int> m_yEdges;
+    // per cell, row major with m_xEdges.size() columns
+    QVector<qint64> m_density;
+    // per grid point, row major with m_xEdges.size() columns
+    QVector<qint64> m_sums;
+};
+
+} // namespace
+
+#endif
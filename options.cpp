@@ -137,6 +137,7 @@ Options::Options(QObject *parent)
     , m_compositingInitialized(Options::defaultCompositingInitialized())
     , m_hiddenPreviews(Options::defaultHiddenPreviews())
     , m_unredirectFullscreen(Options::defaultUnredirectFullscreen())
+    , m_hiddenPixmapBudget(Options::defaultHiddenPixmapBudget())
     , m_glSmoothScale(Options::defaultGlSmoothScale())
     , m_colorCorrected(Options::defaultColorCorrected())
     , m_xrenderSmoothScale(Options::defaultXrenderSmoothScale())
@@ -652,6 +653,15 @@ void Options::setUnredirectFullscreen(bool unredirectFullscreen)
     emit unredirectFullscreenChanged();
 }
 
+void Options::setHiddenPixmapBudget(int hiddenPixmapBudget)
+{
+    if (m_hiddenPixmapBudget == hiddenPixmapBudget) {
+        return;
+    }
+    m_hiddenPixmapBudget = hiddenPixmapBudget;
+    emit hiddenPixmapBudgetChanged();
+}
+
 void Options::setGlSmoothScale(int glSmoothScale)
 {
     if (m_glSmoothScale == glSmoothScale) {
@@ -992,6 +1002,7 @@ void Options::reloadCompositingSettings(bool force)
     setHiddenPreviews(previews);
 
     setUnredirectFullscreen(config.readEntry("UnredirectFullscreen", Options::defaultUnredirectFullscreen()));
+    setHiddenPixmapBudget(qMax(0, config.readEntry("HiddenPixmapBudget", Options::defaultHiddenPixmapBudget())));
     // TOOD: add setter
     animationSpeed = qBound(0, config.readEntry("AnimationSpeed", Options::defaultAnimationSpeed()), 6);
 
@@ -169,6 +169,10 @@ class Options : public KDecorationOptions
     Q_PROPERTY(bool compositingInitialized READ isCompositingInitialized WRITE setCompositingInitialized NOTIFY compositingInitializedChanged)
     Q_PROPERTY(int hiddenPreviews READ hiddenPreviews WRITE setHiddenPreviews NOTIFY hiddenPreviewsChanged)
     Q_PROPERTY(bool unredirectFullscreen READ isUnredirectFullscreen WRITE setUnredirectFullscreen NOTIFY unredirectFullscreenChanged)
+    /**
+     * Memory in MiB the window pixmaps of windows which are not shown may use, 0 = unlimited.
+     **/
+    Q_PROPERTY(int hiddenPixmapBudget READ hiddenPixmapBudget WRITE setHiddenPixmapBudget NOTIFY hiddenPixmapBudgetChanged)
     /**
      * 0 = no, 1 = yes when transformed,
      * 2 = try trilinear when transformed; else 1,
@@ -507,6 +511,9 @@ public:
     bool isUnredirectFullscreen() const {
         return m_unredirectFullscreen && !kwinApp()->requiresCompositing();
     }
+    int hiddenPixmapBudget() const {
+        return m_hiddenPixmapBudget;
+    }
     // OpenGL
     // 0 = no, 1 = yes when transformed,
     // 2 = try trilinear when transformed; else 1,
@@ -600,6 +607,7 @@ public:
     void setCompositingInitialized(bool compositingInitialized);
     void setHiddenPreviews(int hiddenPreviews);
     void setUnredirectFullscreen(bool unredirectFullscreen);
+    void setHiddenPixmapBudget(int hiddenPixmapBudget);
     void setGlSmoothScale(int glSmoothScale);
     void setXrenderSmoothScale(bool xrenderSmoothScale);
     void setMaxFpsInterval(qint64 maxFpsInterval);
@@ -681,6 +689,9 @@ public:
     static bool defaultUnredirectFullscreen() {
         return false;
     }
+    static int defaultHiddenPixmapBudget() {
+        return 256;
+    }
     static int defaultGlSmoothScale() {
         return 2;
     }
@@ -784,6 +795,7 @@ Q_SIGNALS:
     void compositingInitializedChanged();
     void hiddenPreviewsChanged();
     void unredirectFullscreenChanged();
+    void hiddenPixmapBudgetChanged();
     void glSmoothScaleChanged();
     void colorCorrectedChanged();
     void xrenderSmoothScaleChanged();
@@ -832,6 +844,7 @@ private:
     bool m_compositingInitialized;
     HiddenPreviews m_hiddenPreviews;
     bool m_unredirectFullscreen;
+    int m_hiddenPixmapBudget;
     int m_glSmoothScale;
     bool m_colorCorrected;
     bool m_xrenderSmoothScale;
@@ -0,0 +1,93 @@
+/********************************************************************
+ KWin - the KDE window manager
+ This file is part of the KDE project.
+
+Copyright (C) 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#include "outputrepaintscheduler.h"
+
+namespace KWin
+{
+
+OutputRepaintScheduler::OutputRepaintScheduler()
+    : m_frames(0)
+{
+}
+
+void OutputRepaintScheduler::setOutputs(const QVector<QRect> &geometries, const QVector<int> &refreshRates)
+{
+    m_outputs.clear();
+    m_outputs.reserve(geometries.count());
+    for (int i = 0; i < geometries.count(); ++i) {
+        Output output;
+        output.geometry = geometries.at(i);
+        output.refreshRate = qMax(-1, refreshRates.value(i, -1));
+        output.dirtyFrames = 0;
+        m_outputs << output;
+    }
+    m_frames = 0;
+}
+
+qint64 OutputRepaintScheduler::frameInterval(const QRegion &damage) const
+{
+    int rate = 0;
+    foreach (const Output &output, m_outputs) {
+        if (!damage.intersects(output.geometry)) {
+            continue;
+        }
+        if (output.refreshRate < 1) {
+            // can't tell how fast this output is, don't hold back its frames
+            return 0;
+        }
+        rate = qMax(rate, output.refreshRate);
+    }
+    if (rate == 0) {
+        return 0;
+    }
+    return 1000 * 1000 * 1000 / rate;
+}
+
+void OutputRepaintScheduler::addFrame(const QRegion &damage)
+{
+    ++m_frames;
+    for (int i = 0; i < m_outputs.count(); ++i) {
+        if (damage.intersects(m_outputs.at(i).geometry)) {
+            ++m_outputs[i].dirtyFrames;
+        }
+    }
+}
+
+QString OutputRepaintScheduler::supportInformation() const
+{
+    QString support;
+    for (int i = 0; i < m_outputs.count(); ++i) {
+        const Output &output = m_outputs.at(i);
+        support.append(QStringLiteral("Output %1: %2x%3+%4+%5, ").arg(i)
+                                                                 .arg(output.geometry.width())
+                                                                 .arg(output.geometry.height())
+                                                                 .arg(output.geometry.x())
+                                                                 .arg(output.geometry.y()));
+        if (output.refreshRate > 0) {
+            support.append(QStringLiteral("%1 Hz, ").arg(output.refreshRate));
+        } else {
+            support.append(QStringLiteral("unknown refresh rate, "));
+        }
+        support.append(QStringLiteral("damaged in %1 of %2 frames\n").arg(output.dirtyFrames).arg(m_frames));
+    }
+    return support;
+}
+
+} // namespace
@@ -0,0 +1,121 @@
+/********************************************************************
+ KWin - the KDE window manager
+ This file is part of the KDE project.
+
+Copyright (C) 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+
+#ifndef KWIN_OUTPUTREPAINTSCHEDULER_H
+#define KWIN_OUTPUTREPAINTSCHEDULER_H
+
+#include <QRect>
+#include <QRegion>
+#include <QString>
+#include <QVector>
+
+namespace KWin
+{
+
+/**
+ * @short Assigns the damage of a frame to the outputs it is shown on.
+ *
+ * All outputs of the X screen share one back buffer, so a frame is always presented on all of
+ * them at once. What can differ per output is whether it has anything to show: the scheduler
+ * determines which outputs are touched by the pending damage and derives how often frames
+ * have to be produced for them. A frame which only damages a 30 Hz output does not need to be
+ * rendered at the rate of a 60 Hz output next to it.
+ *
+ * In addition it counts per output in how many of the rendered frames it had been damaged.
+ **/
+class OutputRepaintScheduler
+{
+public:
+    OutputRepaintScheduler();
+
+    /**
+     * Sets the outputs to the given @p geometries with the matching @p refreshRates in Hz.
+     * A refresh rate below @c 1 means that the rate of the output is not known.
+     * Resets the statistics.
+     **/
+    void setOutputs(const QVector<QRect> &geometries, const QVector<int> &refreshRates);
+    int count() const;
+    QRect geometry(int output) const;
+    int refreshRate(int output) const;
+
+    /**
+     * @returns The time in nanoseconds between two frames needed to show @p damage, that is
+     * the refresh interval of the fastest output touched by it. @c 0 if there is no limit,
+     * because one of the touched outputs has an unknown refresh rate or no output is touched.
+     **/
+    qint64 frameInterval(const QRegion &damage) const;
+
+    /**
+     * Records a rendered frame which repainted @p damage.
+     **/
+    void addFrame(const QRegion &damage);
+    /**
+     * @returns Number of frames recorded through addFrame.
+     **/
+    quint64 frameCount() const;
+    /**
+     * @returns In how many of the recorded frames @p output had been damaged.
+     **/
+    quint64 dirtyFrameCount(int output) const;
+    QString supportInformation() const;
+
+private:
+    struct Output {
+        QRect geometry;
+        int refreshRate;
+        quint64 dirtyFrames;
+    };
+    QVector<Output> m_outputs;
+    quint64 m_frames;
+};
+
+inline
+int OutputRepaintScheduler::count() const
+{
+    return m_outputs.count();
+}
+
+inline
+QRect OutputRepaintScheduler::geometry(int output) const
+{
+    return m_outputs.at(output).geometry;
+}
+
+inline
+int OutputRepaintScheduler::refreshRate(int output) const
+{
+    return m_outputs.at(output).refreshRate;
+}
+
+inline
+quint64 OutputRepaintScheduler::frameCount() const
+{
+    return m_frames;
+}
+
+inline
+quint64 OutputRepaintScheduler::dirtyFrameCount(int output) const
+{
+    return m_outputs.at(output).dirtyFrames;
+}
+
+} // namespace
+
+#endif
@@ -471,24 +471,18 @@ void RasterXRenderPaintRedirector::resize(PaintRedirector::DecorationPixmap bord
     xcb_render_fill_rectangles(connection(), XCB_RENDER_PICT_OP_SRC, *m_pictures[border], preMultiply(Qt::transparent), 1, &rect);
 }
 
-void RasterXRenderPaintRedirector::preparePaint(const QPixmap &pending)
-{
-    m_tempImage = pending.toImage();
-}
-
 void RasterXRenderPaintRedirector::paint(PaintRedirector::DecorationPixmap border, const QRect &r, const QRect &b, const QRegion &reg)
 {
-    // clip the sub area
-    const QRect bounding = reg.boundingRect();
-    const QPoint offset = bounding.topLeft() - r.topLeft();
     if (m_gc == 0) {
         m_gc = xcb_generate_id(connection());
         xcb_create_gc(connection(), m_gc, m_pixmaps[border], 0, NULL);
     }
 
-    const QImage img(scratchImage().copy(QRect(bounding.topLeft() - b.topLeft(), bounding.size())));
-    xcb_put_image(connection(), XCB_IMAGE_FORMAT_Z_PIXMAP, m_pixmaps[border], m_gc,
-                  img.width(), img.height(), offset.x(), offset.y(), 0, 32, img.byteCount(), img.constBits());
+    // upload only the damaged parts straight out of the scratch image
+    foreach (const QRect &rect, reg.rects()) {
+        XRenderUtils::putImage(m_pixmaps[border], m_gc, 32, scratchImage(),
+                               rect.translated(-b.topLeft()), rect.topLeft() - r.topLeft());
+    }
 }
 
 QImagePaintRedirector::QImagePaintRedirector(Client *c, KDecoration *deco)
@@ -174,13 +174,11 @@ protected:
     virtual xcb_render_picture_t picture(DecorationPixmap border) const;
     virtual void resize(DecorationPixmap border, const QSize &size);
     virtual void paint(DecorationPixmap border, const QRect &r, const QRect &b, const QRegion &reg);
-    virtual void preparePaint(const QPixmap &pending);
 private:
     QSize m_sizes[PixmapCount];
     xcb_pixmap_t m_pixmaps[PixmapCount];
     xcb_gcontext_t m_gc;
     XRenderPicture* m_pictures[PixmapCount];
-    QImage m_tempImage;
 };
 
 class QImagePaintRedirector : public ImageBasedPaintRedirector
@@ -0,0 +1,270 @@
+/********************************************************************
+ KWin - the KDE window manager
+ This file is part of the KDE project.
+
+Copyright (C) 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#include "partialupdateengine.h"
+
+namespace KWin
+{
+
+// weight of a new measurement in the moving average of the costs
+static const qreal s_costSmoothing = 0.1;
+// relative variance below which the measured frames are considered to be all alike
+static const qreal s_minimumVariance = 1e-6;
+
+PartialUpdateEngine::CostModel::CostModel()
+    : pixels(0.0)
+    , rects(0.0)
+    , time(0.0)
+    , pixelsPixels(0.0)
+    , pixelsRects(0.0)
+    , rectsRects(0.0)
+    , pixelsTime(0.0)
+    , rectsTime(0.0)
+    , perPresent(0.0)
+    , perRect(0.0)
+    , perPixel(0.0)
+    , samples(0)
+{
+}
+
+void PartialUpdateEngine::CostModel::add(qreal p, qreal r, qreal t)
+{
+    const qreal weight = samples ? s_costSmoothing : 1.0;
+    pixels += weight * (p - pixels);
+    rects += weight * (r - rects);
+    time += weight * (t - time);
+    pixelsPixels += weight * (p * p - pixelsPixels);
+    pixelsRects += weight * (p * r - pixelsRects);
+    rectsRects += weight * (r * r - rectsRects);
+    pixelsTime += weight * (p * t - pixelsTime);
+    rectsTime += weight * (r * t - rectsTime);
+    if (samples < minimumSamples) {
+        ++samples;
+    }
+    fit();
+}
+
+void PartialUpdateEngine::CostModel::fit()
+{
+    // least squares fit of time = perPresent + perRect * rects + perPixel * pixels
+    const qreal varPixels = pixelsPixels - pixels * pixels;
+    const qreal varRects = rectsRects - rects * rects;
+    const qreal covPixelsRects = pixelsRects - pixels * rects;
+    const qreal covPixelsTime = pixelsTime - pixels * time;
+    const qreal covRectsTime = rectsTime - rects * time;
+    const bool pixelsVary = varPixels > s_minimumVariance * pixels * pixels;
+    const bool rectsVary = varRects > s_minimumVariance * rects * rects;
+    const qreal det = varPixels * varRects - covPixelsRects * covPixelsRects;
+    if (pixelsVary && rectsVary && det > s_minimumVariance * varPixels * varRects) {
+        perPixel = (covPixelsTime * varRects - covRectsTime * covPixelsRects) / det;
+        perRect = (covRectsTime * varPixels - covPixelsTime * covPixelsRects) / det;
+        perPresent = time - perPixel * pixels - perRect * rects;
+        if (perPixel >= 0.0 && perRect >= 0.0 && perPresent >= 0.0) {
+            return;
+        }
+    }
+    // the rects cannot be told apart from the present
+    if (pixelsVary) {
+        perPixel = covPixelsTime / varPixels;
+        perRect = 0.0;
+        perPresent = time - perPixel * pixels;
+        if (perPixel >= 0.0 && perPresent >= 0.0) {
+            return;
+        }
+    }
+    // nothing varies, everything is attributed to the pixels
+    perPixel = pixels > 0.0 ? time / pixels : 0.0;
+    perRect = 0.0;
+    perPresent = 0.0;
+}
+
+qreal PartialUpdateEngine::CostModel::cost(qreal p, qreal r) const
+{
+    return perPresent + perRect * r + perPixel * p;
+}
+
+PartialUpdateEngine::PartialUpdateEngine()
+    : m_bufferAge(false)
+    , m_pendingPixels(0)
+    , m_pendingRects(0)
+    , m_pendingTime(0)
+    , m_hasPendingFrame(false)
+    , m_lastStrategy(FullSwap)
+    , m_frames(0)
+    , m_repaintedPixels(0)
+    , m_totalPixels(0)
+    , m_lastRatio(0.0)
+{
+    for (int i = 0; i < StrategyCount; ++i) {
+        m_presents[i] = 0;
+    }
+}
+
+void PartialUpdateEngine::setScreenSize(const QSize &size)
+{
+    if (m_screenSize == size) {
+        return;
+    }
+    m_screenSize = size;
+    // the cost of a full swap depends on the screen size, old measurements are meaningless
+    for (int i = 0; i < StrategyCount; ++i) {
+        m_cost[i] = CostModel();
+    }
+    m_hasPendingFrame = false;
+}
+
+void PartialUpdateEngine::setSupportsBufferAge(bool supported)
+{
+    m_bufferAge = supported;
+}
+
+quint64 PartialUpdateEngine::pixelCount(const QRegion &region)
+{
+    quint64 pixels = 0;
+    foreach (const QRect &r, region.rects()) {
+        pixels += quint64(r.width()) * r.height();
+    }
+    return pixels;
+}
+
+quint64 PartialUpdateEngine::screenPixels() const
+{
+    return quint64(m_screenSize.width()) * m_screenSize.height();
+}
+
+bool PartialUpdateEngine::prefersFullRepaint(const QRegion &damage, bool opaqueFullscreen) const
+{
+    if (m_bufferAge || damage.isEmpty()) {
+        return false;
+    }
+    const quint64 screen = screenPixels();
+    if (m_cost[CopySubBuffer].samples < minimumSamples || m_cost[FullSwap].samples < minimumSamples) {
+        // Not enough measurements, extend "large" repaints of a single window.
+        // 16:9 is 75% of 4:3 and 2.55:1 is 49.01% of 5:4
+        // (5:4 is the most square format and 2.55:1 is Cinemascope55 - the widest ever shot
+        // movie aspect - two times ;-) It's a Fox format, though, so maybe we want to restrict
+        // to 2.20:1 - Panavision - which has actually been used for interesting movies ...)
+        // would be 57% of 5/4
+        const quint64 fullRepaintLimit = (opaqueFullscreen ? 0.49 : 0.748) * screen;
+        foreach (const QRect &r, damage.rects()) {
+            if (quint64(r.width()) * r.height() > fullRepaintLimit) {
+                return true;
+            }
+        }
+        return false;
+    }
+    return m_cost[FullSwap].cost(screen, 1) < m_cost[CopySubBuffer].cost(pixelCount(damage), damage.rectCount());
+}
+
+PartialUpdateEngine::Strategy PartialUpdateEngine::presentStrategy(const QRegion &region) const
+{
+    if (m_bufferAge) {
+        return BufferAge;
+    }
+    if (region == QRegion(0, 0, m_screenSize.width(), m_screenSize.height())) {
+        return FullSwap;
+    }
+    return CopySubBuffer;
+}
+
+void PartialUpdateEngine::addRenderedFrame(const QRegion &region, qint64 renderTime)
+{
+    const quint64 pixels = pixelCount(region);
+    const quint64 screen = screenPixels();
+    ++m_frames;
+    m_repaintedPixels += pixels;
+    m_totalPixels += screen;
+    m_lastRatio = screen ? qreal(pixels) / screen : 0.0;
+
+    m_pendingPixels = pixels;
+    m_pendingRects = region.rectCount();
+    m_pendingTime = renderTime;
+    m_hasPendingFrame = true;
+}
+
+void PartialUpdateEngine::addPresentedFrame(Strategy strategy, qint64 presentTime)
+{
+    ++m_presents[strategy];
+    m_lastStrategy = strategy;
+    if (!m_hasPendingFrame) {
+        return;
+    }
+    m_hasPendingFrame = false;
+    if (presentTime < 0 || m_pendingPixels == 0) {
+        return;
+    }
+    m_cost[strategy].add(m_pendingPixels, m_pendingRects, m_pendingTime + presentTime);
+}
+
+qreal PartialUpdateEngine::averageRepaintRatio() const
+{
+    return m_totalPixels ? qreal(m_repaintedPixels) / m_totalPixels : 0.0;
+}
+
+qreal PartialUpdateEngine::costPerPixel(Strategy strategy) const
+{
+    return m_cost[strategy].perPixel;
+}
+
+qreal PartialUpdateEngine::costPerPresent(Strategy strategy) const
+{
+    return m_cost[strategy].perPresent;
+}
+
+qreal PartialUpdateEngine::costPerRect(Strategy strategy) const
+{
+    return m_cost[strategy].perRect;
+}
+
+QString PartialUpdateEngine::strategyToString(Strategy strategy)
+{
+    switch (strategy) {
+    case BufferAge:
+        return QStringLiteral("buffer age");
+    case CopySubBuffer:
+        return QStringLiteral("copy sub buffer");
+    case FullSwap:
+        return QStringLiteral("full swap");
+    default:
+        return QStringLiteral("unknown");
+    }
+}
+
+QString PartialUpdateEngine::supportInformation() const
+{
+    QString support;
+    support.append(QStringLiteral("Buffer age: %1\n").arg(m_bufferAge ? QStringLiteral("yes") : QStringLiteral("no")));
+    support.append(QStringLiteral("Rendered frames: %1\n").arg(m_frames));
+    support.append(QStringLiteral("Repainted area in last frame: %1%\n").arg(m_lastRatio * 100.0, 0, 'f', 1));
+    support.append(QStringLiteral("Average repainted area per frame: %1%\n").arg(averageRepaintRatio() * 100.0, 0, 'f', 1));
+    for (int i = 0; i < StrategyCount; ++i) {
+        const Strategy strategy = Strategy(i);
+        support.append(QStringLiteral("Frames presented with %1: %2").arg(strategyToString(strategy)).arg(m_presents[i]));
+        if (m_cost[i].samples) {
+            support.append(QStringLiteral(" (%1 ns per pixel, %2 ns per rect, %3 ns per present)")
+                .arg(m_cost[i].perPixel, 0, 'f', 3)
+                .arg(m_cost[i].perRect, 0, 'f', 0)
+                .arg(m_cost[i].perPresent, 0, 'f', 0));
+        }
+        support.append(QStringLiteral("\n"));
+    }
+    return support;
+}
+
+} // namespace
@@ -0,0 +1,206 @@
+/********************************************************************
+ KWin - the KDE window manager
+ This file is part of the KDE project.
+
+Copyright (C) 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+
+#ifndef KWIN_PARTIALUPDATEENGINE_H
+#define KWIN_PARTIALUPDATEENGINE_H
+
+#include <QRegion>
+#include <QSize>
+#include <QString>
+
+namespace KWin
+{
+
+/**
+ * @short Decides how much of the screen gets repainted and keeps statistics about it.
+ *
+ * There are three ways a frame can reach the screen:
+ * @li @c BufferAge: the damage accumulated since the back buffer was last used is repainted
+ *     and the buffers are swapped. Used whenever the backend supports buffer age.
+ * @li @c CopySubBuffer: only the damaged area is repainted and copied to the front buffer
+ *     (glXCopySubBuffer, eglPostSubBufferNV or copying pixels).
+ * @li @c FullSwap: the whole screen is repainted and the buffers are swapped.
+ *
+ * Without buffer age the engine chooses per frame between the last two. It measures how long
+ * rendering and presenting takes for each strategy and picks the one which is expected to be
+ * cheaper for the current damage. The cost of a frame is modelled as a fixed cost per present,
+ * a cost per presented rect (e.g. one glXCopySubBuffer call each) and a cost per repainted
+ * pixel, fitted to the measured frames. As long as the measured frames do not differ enough to
+ * tell these terms apart the whole cost is attributed to the pixels. Until both strategies
+ * have been measured a static size threshold is used.
+ *
+ * Independently of the strategy the engine records how many pixels got repainted per frame
+ * compared to the size of the screen.
+ **/
+class PartialUpdateEngine
+{
+public:
+    enum Strategy {
+        BufferAge,
+        CopySubBuffer,
+        FullSwap,
+        StrategyCount
+    };
+    PartialUpdateEngine();
+
+    void setScreenSize(const QSize &size);
+    QSize screenSize() const;
+    void setSupportsBufferAge(bool supported);
+    bool supportsBufferAge() const;
+
+    /**
+     * @returns Whether the frame with the given @p damage should be repainted completely.
+     * Always @c false if buffer age is supported, the backend repaints the buffer history then.
+     * @param opaqueFullscreen Whether an opaque fullscreen window is painted in the frame
+     **/
+    bool prefersFullRepaint(const QRegion &damage, bool opaqueFullscreen) const;
+    /**
+     * @returns The strategy a backend uses to present the @p region it rendered.
+     **/
+    Strategy presentStrategy(const QRegion &region) const;
+
+    /**
+     * Records a frame which repainted @p region in @p renderTime nanoseconds.
+     **/
+    void addRenderedFrame(const QRegion &region, qint64 renderTime);
+    /**
+     * Records that the last rendered frame got presented with @p strategy in
+     * @p presentTime nanoseconds. A negative @p presentTime only counts the frame,
+     * e.g. if it got presented in a way the engine does not measure.
+     **/
+    void addPresentedFrame(Strategy strategy, qint64 presentTime);
+
+    /**
+     * @returns Number of frames recorded through addRenderedFrame.
+     **/
+    quint64 frameCount() const;
+    /**
+     * @returns Fraction of the screen repainted in the last frame.
+     **/
+    qreal lastRepaintRatio() const;
+    /**
+     * @returns Fraction of the screen repainted per frame, averaged over all frames.
+     **/
+    qreal averageRepaintRatio() const;
+    /**
+     * @returns How often frames got presented with @p strategy.
+     **/
+    quint64 presentCount(Strategy strategy) const;
+    /**
+     * @returns The measured cost in nanoseconds per repainted pixel of @p strategy, @c 0 if
+     * there is no measurement yet.
+     **/
+    qreal costPerPixel(Strategy strategy) const;
+    /**
+     * @returns The measured fixed cost in nanoseconds of presenting a frame with @p strategy.
+     **/
+    qreal costPerPresent(Strategy strategy) const;
+    /**
+     * @returns The measured cost in nanoseconds per presented rect of @p strategy.
+     **/
+    qreal costPerRect(Strategy strategy) const;
+    Strategy lastStrategy() const;
+    QString supportInformation() const;
+
+    static QString strategyToString(Strategy strategy);
+    /**
+     * Number of measurements of a strategy before its cost is trusted.
+     **/
+    static const int minimumSamples = 8;
+
+private:
+    /**
+     * Exponentially weighted means of the measured frames and the cost fitted to them.
+     **/
+    struct CostModel {
+        CostModel();
+        void add(qreal pixels, qreal rects, qreal time);
+        void fit();
+        qreal cost(qreal pixels, qreal rects) const;
+        qreal pixels;
+        qreal rects;
+        qreal time;
+        qreal pixelsPixels;
+        qreal pixelsRects;
+        qreal rectsRects;
+        qreal pixelsTime;
+        qreal rectsTime;
+        qreal perPresent;
+        qreal perRect;
+        qreal perPixel;
+        int samples;
+    };
+    static quint64 pixelCount(const QRegion &region);
+    quint64 screenPixels() const;
+
+    QSize m_screenSize;
+    bool m_bufferAge;
+    quint64 m_pendingPixels;
+    int m_pendingRects;
+    qint64 m_pendingTime;
+    bool m_hasPendingFrame;
+    CostModel m_cost[StrategyCount];
+    quint64 m_presents[StrategyCount];
+    Strategy m_lastStrategy;
+    quint64 m_frames;
+    quint64 m_repaintedPixels;
+    quint64 m_totalPixels;
+    qreal m_lastRatio;
+};
+
+inline
+QSize PartialUpdateEngine::screenSize() const
+{
+    return m_screenSize;
+}
+
+inline
+bool PartialUpdateEngine::supportsBufferAge() const
+{
+    return m_bufferAge;
+}
+
+inline
+quint64 PartialUpdateEngine::frameCount() const
+{
+    return m_frames;
+}
+
+inline
+qreal PartialUpdateEngine::lastRepaintRatio() const
+{
+    return m_lastRatio;
+}
+
+inline
+quint64 PartialUpdateEngine::presentCount(Strategy strategy) const
+{
+    return m_presents[strategy];
+}
+
+inline
+PartialUpdateEngine::Strategy PartialUpdateEngine::lastStrategy() const
+{
+    return m_lastStrategy;
+}
+
+} // namespace
+
+#endif
@@ -35,6 +35,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "options.h"
 #include "rules.h"
 #include "screens.h"
+#include "occupancymap.h"
 #endif
 
 namespace KWin
@@ -223,6 +224,26 @@ void Placement::placeSmart(Client* c, const QRect& area, Policy /*next*/)
 
     bool first_pass = true; //CT lame flag. Don't like it. What else would do?
 
+    // the windows which can overlap and their weighted area, the overlap of a candidate
+    // position is then a lookup instead of a walk over the stacking order
+    QVector<QRect> others;
+    OccupancyMap occupancy;
+    ToplevelList::ConstIterator l;
+    for (l = workspace()->stackingOrder().constBegin(); l != workspace()->stackingOrder().constEnd() ; ++l) {
+        Client *client = qobject_cast<Client*>(*l);
+        if (isIrrelevant(client, c, desktop)) {
+            continue;
+        }
+        others << client->geometry();
+        if (client->keepAbove())
+            occupancy.addRect(client->geometry(), 16);
+        else if (client->keepBelow() && !client->isDock()) // ignore KeepBelow windows
+            continue; // for placement (see Client::belongsToLayer() for Dock)
+        else
+            occupancy.addRect(client->geometry(), 1);
+    }
+    occupancy.build();
+
     //loop over possible positions
     do {
         //test if enough room in x and y directions
@@ -231,32 +252,10 @@ void Placement::placeSmart(Client* c, const QRect& area, Policy /*next*/)
         else if (x + cw > maxRect.right())
             overlap = w_wrong;
         else {
-            overlap = none; //initialize
-
+            //calc the overall overlapping
             cxl = x; cxr = x + cw;
             cyt = y; cyb = y + ch;
-            ToplevelList::ConstIterator l;
-            for (l = workspace()->stackingOrder().constBegin(); l != workspace()->stackingOrder().constEnd() ; ++l) {
-                Client *client = qobject_cast<Client*>(*l);
-                if (isIrrelevant(client, c, desktop)) {
-                    continue;
-                }
-                xl = client->x();          yt = client->y();
-                xr = xl + client->width(); yb = yt + client->height();
-
-                //if windows overlap, calc the overall overlapping
-                if ((cxl < xr) && (cxr > xl) &&
-                        (cyt < yb) && (cyb > yt)) {
-                    xl = qMax(cxl, xl); xr = qMin(cxr, xr);
-                    yt = qMax(cyt, yt); yb = qMin(cyb, yb);
-                    if (client->keepAbove())
-                        overlap += 16 * (xr - xl) * (yb - yt);
-                    else if (client->keepBelow() && !client->isDock()) // ignore KeepBelow windows
-                        overlap += 0; // for placement (see Client::belongsToLayer() for Dock)
-                    else
-                        overlap += (xr - xl) * (yb - yt);
-                }
-            }
+            overlap = occupancy.overlap(cxl, cyt, cxr, cyb);
         }
 
         //CT first time we get no overlap we stop.
@@ -284,15 +283,9 @@ void Placement::placeSmart(Client* c, const QRect& area, Policy /*next*/)
             if (possible - cw > x) possible -= cw;
 
             // compare to the position of each client on the same desk
-            ToplevelList::ConstIterator l;
-            for (l = workspace()->stackingOrder().constBegin(); l != workspace()->stackingOrder().constEnd() ; ++l) {
-                Client *client = qobject_cast<Client*>(*l);
-                if (isIrrelevant(client, c, desktop)) {
-                    continue;
-                }
-
-                xl = client->x();          yt = client->y();
-                xr = xl + client->width(); yb = yt + client->height();
+            foreach (const QRect &other, others) {
+                xl = other.x();           yt = other.y();
+                xr = xl + other.width();  yb = yt + other.height();
 
                 // if not enough room above or under the current tested client
                 // determine the first non-overlapped x position
@@ -315,15 +308,9 @@ void Placement::placeSmart(Client* c, const QRect& area, Policy /*next*/)
             if (possible - ch > y) possible -= ch;
 
             //test the position of each window on the desk
-            ToplevelList::ConstIterator l;
-            for (l = workspace()->stackingOrder().constBegin(); l != workspace()->stackingOrder().constEnd() ; ++l) {
-                Client *client = qobject_cast<Client*>(*l);
-                if (isIrrelevant(client, c, desktop)) {
-                    continue;
-                }
-
-                xl = client->x();          yt = client->y();
-                xr = xl + client->width(); yb = yt + client->height();
+            foreach (const QRect &other, others) {
+                xl = other.x();           yt = other.y();
+                xr = xl + other.width();  yb = yt + other.height();
 
                 // if not enough room to the left or right of the current tested client
                 // determine the first non-overlapped y position
@@ -68,6 +68,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "scene.h"
 
+#include <QElapsedTimer>
 #include <QQuickWindow>
 #include <QVector2D>
 
@@ -75,10 +76,12 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "decorations.h"
 #include "deleted.h"
 #include "effects.h"
+#include "hiddenpixmapbudget.h"
 #include "overlaywindow.h"
 #include "shadow.h"
 
 #include "thumbnailitem.h"
+#include "timingstatistics.h"
 #include "workspace.h"
 
 namespace KWin
@@ -91,6 +94,7 @@ namespace KWin
 Scene::Scene(Workspace* ws)
     : QObject(ws)
     , wspace(ws)
+    , m_pixmapBudgetPass(0)
 {
     last_time.invalidate(); // Initialize the timer
     connect(Workspace::self(), SIGNAL(deletedRemoved(KWin::Deleted*)), SLOT(windowDeleted(KWin::Deleted*)));
@@ -120,7 +124,10 @@ void Scene::paintScreen(int* mask, const QRegion &damage, const QRegion &repaint
     pdata.mask = *mask;
     pdata.paint = region;
 
+    QElapsedTimer effectsTimer;
+    effectsTimer.start();
     effects->prePaintScreen(pdata, time_diff);
+    TimingStatistics::addSample(TimingStatistics::EffectsPrePaint, effectsTimer.nsecsElapsed());
     *mask = pdata.mask;
     region = pdata.paint;
 
@@ -145,13 +152,19 @@ void Scene::paintScreen(int* mask, const QRegion &damage, const QRegion &repaint
     }
 
     ScreenPaintData data;
+    const qint64 paintStart = effectsTimer.nsecsElapsed();
     effects->paintScreen(*mask, region, data);
+    const qint64 paintEnd = effectsTimer.nsecsElapsed();
 
     foreach (Window *w, stacking_order) {
         effects->postPaintWindow(effectWindow(w));
     }
 
     effects->postPaintScreen();
+    TimingStatistics::addSample(TimingStatistics::EffectsPaint, paintEnd - paintStart);
+    TimingStatistics::addSample(TimingStatistics::EffectsPostPaint, effectsTimer.nsecsElapsed() - paintEnd);
+
+    evictHiddenPixmaps();
 
     // make sure not to go outside of the screen area
     *updateRegion = damaged_region;
@@ -164,6 +177,39 @@ void Scene::paintScreen(int* mask, const QRegion &damage, const QRegion &repaint
     Q_ASSERT(!PaintClipper::clip());
 }
 
+void Scene::evictHiddenPixmaps()
+{
+    const quint64 budget = quint64(options->hiddenPixmapBudget()) * 1024 * 1024;
+    if (budget == 0 || (m_pixmapBudgetTimer.isValid() && !m_pixmapBudgetTimer.hasExpired(1000))) {
+        return;
+    }
+    m_pixmapBudgetTimer.start();
+    ++m_pixmapBudgetPass;
+
+    QVector<Window*> hidden;
+    QVector<HiddenPixmapBudget::Pixmap> pixmaps;
+    foreach (Window *w, m_windows) {
+        w->updatePixmapUse(m_pixmapBudgetPass);
+        if (w->isPaintingEnabled() || w->window()->isDeleted()) {
+            continue;
+        }
+        HiddenPixmapBudget::Pixmap pixmap;
+        pixmap.memory = w->pixmapMemory();
+        if (pixmap.memory == 0) {
+            continue;
+        }
+        pixmap.lastUse = w->lastPixmapUse();
+        // only a kept window is still mapped, the pixmap of an unmapped one, e.g. a minimized
+        // window, could not be named again for a thumbnail
+        pixmap.recreatable = w->window()->isClient() && static_cast<Client*>(w->window())->hiddenPreview();
+        hidden << w;
+        pixmaps << pixmap;
+    }
+    foreach (int i, HiddenPixmapBudget::select(pixmaps, budget, m_pixmapBudgetPass)) {
+        hidden.at(i)->releasePixmap();
+    }
+}
+
 // Compute time since the last painting pass.
 void Scene::updateTimeDiff()
 {
@@ -640,6 +686,11 @@ void Scene::doneOpenGLContextCurrent()
 {
 }
 
+const PartialUpdateEngine *Scene::partialUpdate() const
+{
+    return nullptr;
+}
+
 //****************************************
 // Scene::Window
 //****************************************
@@ -651,9 +702,13 @@ Scene::Window::Window(Toplevel * c)
     , m_currentPixmap()
     , m_previousPixmap()
     , m_referencePixmapCounter(0)
+    , m_pixmapUsed(false)
+    , m_lastPixmapUse(0)
     , disable_painting(0)
     , shape_valid(false)
     , cached_quad_list(NULL)
+    , cached_grid_count(0)
+    , cached_grid_next(0)
 {
 }
 
@@ -681,6 +736,36 @@ void Scene::Window::unreferencePreviousPixmap()
     }
 }
 
+quint64 Scene::Window::pixmapMemory() const
+{
+    quint64 memory = 0;
+    if (!m_currentPixmap.isNull() && m_currentPixmap->isValid()) {
+        memory += quint64(m_currentPixmap->size().width()) * m_currentPixmap->size().height() * 4;
+    }
+    if (!m_previousPixmap.isNull() && m_previousPixmap->isValid()) {
+        memory += quint64(m_previousPixmap->size().width()) * m_previousPixmap->size().height() * 4;
+    }
+    return memory;
+}
+
+quint64 Scene::Window::releasePixmap()
+{
+    const quint64 memory = pixmapMemory();
+    m_currentPixmap.reset();
+    if (m_referencePixmapCounter == 0) {
+        m_previousPixmap.reset();
+    }
+    return memory - pixmapMemory();
+}
+
+void Scene::Window::updatePixmapUse(quint64 pass)
+{
+    if (m_pixmapUsed) {
+        m_pixmapUsed = false;
+        m_lastPixmapUse = pass;
+    }
+}
+
 void Scene::Window::pixmapDiscarded()
 {
     if (!m_currentPixmap.isNull() && m_currentPixmap->isValid()) {
@@ -696,6 +781,15 @@ void Scene::Window::discardShape()
     shape_valid = false;
     delete cached_quad_list;
     cached_quad_list = NULL;
+    discardCachedGrids();
+}
+
+void Scene::Window::discardCachedGrids() const
+{
+    for (int i = 0; i < cached_grid_count; ++i)
+        cached_grids[i].quads.clear();
+    cached_grid_count = 0;
+    cached_grid_next = 0;
 }
 
 // Find out the shape of the window using the XShape extension
@@ -833,10 +927,44 @@ WindowQuadList Scene::Window::buildQuads(bool force) const
         ret << m_shadow->shadowQuads();
     }
     effects->buildQuads(toplevel->effectWindow(), ret);
+    delete cached_quad_list;
     cached_quad_list = new WindowQuadList(ret);
+    discardCachedGrids();
     return ret;
 }
 
+WindowQuadList Scene::Window::cachedGrid(const WindowQuadList &quads, int maxQuadSize) const
+{
+    // only the unmodified quads can be cached, an effect might have changed the passed in ones
+    if (cached_quad_list == NULL || !quads.isSharedWith(*cached_quad_list))
+        return quads.makeGrid(maxQuadSize);
+    return gridFromCache(quads, maxQuadSize, -1);
+}
+
+WindowQuadList Scene::Window::cachedRegularGrid(const WindowQuadList &quads, int xSubdivisions, int ySubdivisions) const
+{
+    if (cached_quad_list == NULL || !quads.isSharedWith(*cached_quad_list))
+        return quads.makeRegularGrid(xSubdivisions, ySubdivisions);
+    return gridFromCache(quads, xSubdivisions, ySubdivisions);
+}
+
+const WindowQuadList &Scene::Window::gridFromCache(const WindowQuadList &quads, int x, int y) const
+{
+    for (int i = 0; i < cached_grid_count; ++i) {
+        if (cached_grids[i].x == x && cached_grids[i].y == y)
+            return cached_grids[i].quads;
+    }
+    // replace the entries in turn once all of them are used
+    CachedGrid &grid = cached_grids[cached_grid_next];
+    cached_grid_next = (cached_grid_next + 1) % CachedGridCount;
+    if (cached_grid_count < CachedGridCount)
+        ++cached_grid_count;
+    grid.x = x;
+    grid.y = y;
+    grid.quads = (y == -1) ? quads.makeGrid(x) : quads.makeRegularGrid(x, y);
+    return grid.quads;
+}
+
 WindowQuadList Scene::Window::makeDecorationQuads(const QRect *rects, const QRegion &region) const
 {
     WindowQuadList list;
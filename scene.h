@@ -36,6 +36,7 @@ class Deleted;
 class EffectFrameImpl;
 class EffectWindowImpl;
 class OverlayWindow;
+class PartialUpdateEngine;
 class Shadow;
 class WindowPixmap;
 
@@ -120,6 +121,12 @@ public:
 
     virtual bool makeOpenGLContextCurrent();
     virtual void doneOpenGLContextCurrent();
+    /**
+     * @brief Statistics about the repainted area per frame.
+     *
+     * @return The engine deciding about partial repaints, @c null if the Scene does not use one.
+     **/
+    virtual const PartialUpdateEngine *partialUpdate() const;
 
     /**
      * Whether the Scene uses an X11 overlay window to perform compositing.
@@ -201,7 +208,14 @@ protected:
 private:
     void paintWindowThumbnails(Scene::Window *w, QRegion region, qreal opacity, qreal brightness, qreal saturation);
     void paintDesktopThumbnails(Scene::Window *w);
+    /**
+     * Releases the least recently used pixmaps of windows which are not painted till the
+     * pixmaps of those windows fit into Options::hiddenPixmapBudget. Checked once per second.
+     **/
+    void evictHiddenPixmaps();
     QHash< Toplevel*, Window* > m_windows;
+    QElapsedTimer m_pixmapBudgetTimer;
+    quint64 m_pixmapBudgetPass;
     // windows in their stacking order
     QVector< Window* > stacking_order;
 };
@@ -258,12 +272,30 @@ public:
     void updateToplevel(Toplevel* c);
     // creates initial quad list for the window
     virtual WindowQuadList buildQuads(bool force = false) const;
+    // subdivided quads for deforming effects, cached as long as the quads are
+    WindowQuadList cachedGrid(const WindowQuadList &quads, int maxQuadSize) const;
+    WindowQuadList cachedRegularGrid(const WindowQuadList &quads, int xSubdivisions, int ySubdivisions) const;
     void suspendUnredirect(bool suspend);
     void updateShadow(Shadow* shadow);
     const Shadow* shadow() const;
     Shadow* shadow();
     void referencePreviousPixmap();
     void unreferencePreviousPixmap();
+    /**
+     * @returns The memory in bytes used by the current and the previous window pixmap.
+     **/
+    quint64 pixmapMemory() const;
+    /**
+     * Releases the window pixmaps, they get created again when they are needed the next time.
+     * A previous pixmap which is still referenced is kept.
+     * @returns The memory in bytes which got released
+     **/
+    quint64 releasePixmap();
+    /**
+     * Stores @p pass as the last use of the window pixmap if it got used since the last call.
+     **/
+    void updatePixmapUse(quint64 pass);
+    quint64 lastPixmapUse() const;
 protected:
     WindowQuadList makeQuads(WindowQuadType type, const QRegion& reg) const;
     WindowQuadList makeDecorationQuads(const QRect *rects, const QRegion &region) const;
@@ -298,10 +330,26 @@ private:
     QScopedPointer<WindowPixmap> m_currentPixmap;
     QScopedPointer<WindowPixmap> m_previousPixmap;
     int m_referencePixmapCounter;
+    bool m_pixmapUsed;
+    quint64 m_lastPixmapUse;
     int disable_painting;
     mutable QRegion shape_region;
     mutable bool shape_valid;
     mutable WindowQuadList* cached_quad_list;
+    struct CachedGrid {
+        // parameters of the grid, y is -1 for a grid created by makeGrid
+        int x;
+        int y;
+        WindowQuadList quads;
+    };
+    // a few grids are kept as effects like the cube use different sizes for the same window
+    enum { CachedGridCount = 4 };
+    const WindowQuadList &gridFromCache(const WindowQuadList &quads, int x, int y) const;
+    // the grids are built from the cached quads and have to go together with them
+    void discardCachedGrids() const;
+    mutable CachedGrid cached_grids[CachedGridCount];
+    mutable int cached_grid_count;
+    mutable int cached_grid_next;
     Q_DISABLE_COPY(Window)
 };
 
@@ -489,6 +537,12 @@ Shadow* Scene::Window::shadow()
     return m_shadow;
 }
 
+inline
+quint64 Scene::Window::lastPixmapUse() const
+{
+    return m_lastPixmapUse;
+}
+
 inline
 bool WindowPixmap::isValid() const
 {
@@ -499,6 +553,7 @@ template <typename T>
 inline
 T* Scene::Window::windowPixmap()
 {
+    m_pixmapUsed = true;
     if (m_currentPixmap.isNull()) {
         m_currentPixmap.reset(createWindowPixmap());
     }
@@ -153,6 +153,7 @@ SceneOpenGL::SceneOpenGL(Workspace* ws, OpenGLBackend *backend)
     }
     if (!viewportLimitsMatched(QSize(displayWidth(), displayHeight())))
         return;
+    m_backend->partialUpdate().setScreenSize(QSize(displayWidth(), displayHeight()));
 
     // perform Scene specific checks
     GLPlatform *glPlatform = GLPlatform::instance();
@@ -374,7 +375,10 @@ qint64 SceneOpenGL::paint(QRegion damage, ToplevelList toplevels)
     checkGLError("Paint2");
 #endif
 
+    m_backend->partialUpdate().addRenderedFrame(validRegion, m_backend->renderTime());
     m_backend->endRenderingFrame(validRegion, updateRegion);
+    // programs linked during the frame, the context is still current here
+    ShaderManager::storeProgramBinaries();
 
     // do cleanup
     clearStackingOrder();
@@ -433,23 +437,9 @@ void SceneOpenGL::extendPaintRegion(QRegion &region, bool opaqueFullscreen)
     if (m_backend->supportsBufferAge())
         return;
 
-    if (options->glPreferBufferSwap() == Options::ExtendDamage) { // only Extend "large" repaints
-        const QRegion displayRegion(0, 0, displayWidth(), displayHeight());
-        uint damagedPixels = 0;
-        const uint fullRepaintLimit = (opaqueFullscreen?0.49f:0.748f)*displayWidth()*displayHeight();
-        // 16:9 is 75% of 4:3 and 2.55:1 is 49.01% of 5:4
-        // (5:4 is the most square format and 2.55:1 is Cinemascope55 - the widest ever shot
-        // movie aspect - two times ;-) It's a Fox format, though, so maybe we want to restrict
-        // to 2.20:1 - Panavision - which has actually been used for interesting movies ...)
-        // would be 57% of 5/4
-        foreach (const QRect &r, region.rects()) {
-//                 damagedPixels += r.width() * r.height(); // combined window damage test
-            damagedPixels = r.width() * r.height(); // experimental single window damage testing
-            if (damagedPixels > fullRepaintLimit) {
-                region = displayRegion;
-                return;
-            }
-        }
+    if (options->glPreferBufferSwap() == Options::ExtendDamage) { // only Extend repaints if a full swap is cheaper
+        if (m_backend->partialUpdate().prefersFullRepaint(region, opaqueFullscreen))
+            region = QRegion(0, 0, displayWidth(), displayHeight());
     } else if (options->glPreferBufferSwap() == Options::PaintFullScreen) { // forced full rePaint
         region = QRegion(0, 0, displayWidth(), displayHeight());
     }
@@ -537,6 +527,7 @@ void SceneOpenGL::screenGeometryChanged(const QSize &size)
     Scene::screenGeometryChanged(size);
     glViewport(0,0, size.width(), size.height());
     m_backend->screenGeometryChanged(size);
+    m_backend->partialUpdate().setScreenSize(size);
     ShaderManager::instance()->resetAllShaders();
 }
 
@@ -549,6 +540,11 @@ void SceneOpenGL::paintDesktop(int desktop, int mask, const QRegion &region, Scr
     glDisable(GL_SCISSOR_TEST);
 }
 
+const PartialUpdateEngine *SceneOpenGL::partialUpdate() const
+{
+    return &m_backend->partialUpdate();
+}
+
 bool SceneOpenGL::makeOpenGLContextCurrent()
 {
     return m_backend->makeCurrent();
@@ -1259,10 +1255,12 @@ void SceneOpenGL2Window::performPaint(int mask, QRegion region, WindowPaintData
 
     GLShader *shader = data.shader;
     if (!shader) {
+        // windows painted at full saturation use a variant without the desaturation code
+        const int traits = data.saturation() != 1.0 ? ShaderManager::SaturationTrait : ShaderManager::NoTraits;
         if ((mask & Scene::PAINT_WINDOW_TRANSFORMED) || (mask & Scene::PAINT_SCREEN_TRANSFORMED)) {
-            shader = ShaderManager::instance()->pushShader(ShaderManager::GenericShader);
+            shader = ShaderManager::instance()->pushShaderVariant(ShaderManager::GenericShader, traits);
         } else {
-            shader = ShaderManager::instance()->pushShader(ShaderManager::SimpleShader);
+            shader = ShaderManager::instance()->pushShaderVariant(ShaderManager::SimpleShader, traits);
             shader->setUniform(GLShader::Offset, QVector2D(x(), y()));
         }
     }
@@ -24,6 +24,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "scene.h"
 #include "shadow.h"
+#include "partialupdateengine.h"
 
 #include "kwinglutils.h"
 #include "kwingltexture_p.h"
@@ -58,6 +59,7 @@ public:
     virtual bool makeOpenGLContextCurrent() override;
     virtual void doneOpenGLContextCurrent() override;
     virtual bool isLastFrameRendered() const override;
+    virtual const PartialUpdateEngine *partialUpdate() const override;
 
     void idle();
 
@@ -520,6 +522,16 @@ public:
      */
     void addToDamageHistory(const QRegion &region);
 
+    /**
+     * @brief The engine deciding between partial and full repaints of the backend.
+     **/
+    PartialUpdateEngine &partialUpdate() {
+        return m_partialUpdate;
+    }
+    const PartialUpdateEngine &partialUpdate() const {
+        return m_partialUpdate;
+    }
+
 protected:
     /**
      * @brief Backend specific flushing of frame to screen.
@@ -569,6 +581,7 @@ protected:
 
     void setSupportsBufferAge(bool value) {
         m_haveBufferAge = value;
+        m_partialUpdate.setSupportsBufferAge(value);
     }
 
     /**
@@ -588,6 +601,31 @@ protected:
     void startRenderTimer() {
         m_renderTimer.start();
     }
+    /**
+     * @brief Starts the timer for how long it takes to present the frame.
+     *
+     * @see presentTime
+     **/
+    void startPresentTimer() {
+        m_presentTimer.start();
+    }
+    /**
+     * @returns The time in nanoseconds since startPresentTimer.
+     **/
+    qint64 presentTime() const {
+        return m_presentTimer.nsecsElapsed();
+    }
+    /**
+     * @brief Reports the presented frame to the partial update engine.
+     *
+     * Only copying or submitting the frame should be timed, not waiting for the retrace.
+     *
+     * @param strategy How the frame actually got presented
+     * @param presentTime Time in nanoseconds, negative if the frame should not be measured
+     **/
+    void presentFinished(PartialUpdateEngine::Strategy strategy, qint64 presentTime) {
+        m_partialUpdate.addPresentedFrame(strategy, presentTime);
+    }
 
     SwapProfiler m_swapProfiler;
 
@@ -624,6 +662,11 @@ private:
      * @brief Timer to measure how long a frame renders.
      **/
     QElapsedTimer m_renderTimer;
+    /**
+     * @brief Timer to measure how long presenting a frame takes.
+     **/
+    QElapsedTimer m_presentTimer;
+    PartialUpdateEngine m_partialUpdate;
 };
 
 inline bool SceneOpenGL::hasPendingFlush() const
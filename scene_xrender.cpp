@@ -44,6 +44,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QDebug>
 #include <QtGui/QPainter>
 #include <qmath.h>
+#include <cstring>
 
 namespace KWin
 {
@@ -395,11 +396,14 @@ SceneXrender* SceneXrender::createScene()
 SceneXrender::SceneXrender(XRenderBackend *backend)
     : Scene(Workspace::self())
     , m_backend(backend)
+    , m_uploader(new XRenderShmUploader)
 {
+    XRenderUtils::setImageUploader(m_uploader.data());
 }
 
 SceneXrender::~SceneXrender()
 {
+    XRenderUtils::setImageUploader(nullptr);
     SceneXrender::Window::cleanup();
     SceneXrender::EffectFrame::cleanup();
 }
@@ -466,11 +470,133 @@ Shadow *SceneXrender::createShadow(Toplevel *toplevel)
     return new SceneXRenderShadow(toplevel);
 }
 
+//****************************************
+// XRenderPictureState
+//****************************************
+
+XRenderPictureState::XRenderPictureState()
+{
+    reset();
+}
+
+void XRenderPictureState::reset()
+{
+    const xcb_render_transform_t identity = {
+        DOUBLE_TO_FIXED(1), DOUBLE_TO_FIXED(0), DOUBLE_TO_FIXED(0),
+        DOUBLE_TO_FIXED(0), DOUBLE_TO_FIXED(1), DOUBLE_TO_FIXED(0),
+        DOUBLE_TO_FIXED(0), DOUBLE_TO_FIXED(0), DOUBLE_TO_FIXED(1)
+    };
+    m_transform = identity;
+    // the server default is "nearest", which "fast" is an alias for
+    m_filter = Scene::ImageFilterFast;
+    m_repeat = XCB_RENDER_REPEAT_NONE;
+}
+
+void XRenderPictureState::setTransform(xcb_render_picture_t pic, const xcb_render_transform_t &transform)
+{
+    if (memcmp(&m_transform, &transform, sizeof(xcb_render_transform_t)) == 0) {
+        return;
+    }
+    m_transform = transform;
+    xcb_render_set_picture_transform(connection(), pic, transform);
+}
+
+void XRenderPictureState::setFilter(xcb_render_picture_t pic, Scene::ImageFilterType filter)
+{
+    if (m_filter == filter) {
+        return;
+    }
+    m_filter = filter;
+    QByteArray filterName;
+    switch (filter) {
+    case KWin::Scene::ImageFilterFast:
+        filterName = QByteArray("fast");
+        break;
+    case KWin::Scene::ImageFilterGood:
+        filterName = QByteArray("good");
+        break;
+    }
+    xcb_render_set_picture_filter(connection(), pic, filterName.length(), filterName.constData(), 0, NULL);
+}
+
+void XRenderPictureState::setRepeat(xcb_render_picture_t pic, uint32_t repeat)
+{
+    if (m_repeat == repeat) {
+        return;
+    }
+    m_repeat = repeat;
+    const uint32_t values[] = {repeat};
+    xcb_render_change_picture(connection(), pic, XCB_RENDER_CP_REPEAT, values);
+}
+
+//****************************************
+// XRenderShmUploader
+//****************************************
+
+XRenderShmUploader::XRenderShmUploader()
+    : m_offset(0)
+{
+}
+
+XRenderShmUploader::~XRenderShmUploader()
+{
+    if (!m_shm.isNull()) {
+        // the server might still read from the segment
+        Xcb::sync();
+    }
+}
+
+bool XRenderShmUploader::upload(xcb_drawable_t drawable, xcb_gcontext_t gc, uint8_t depth,
+                                const QImage &image, const QRect &source, const QPoint &target)
+{
+    // other depths would need the scanline padding of the server
+    if (image.depth() != 32) {
+        return false;
+    }
+    const int rowBytes = source.width() * 4;
+    const int screenBytes = displayWidth() * displayHeight() * 4;
+    // the segment fits a screen sized image and grows for larger uploads up to a few screens
+    const int wantedBytes = qMin(rowBytes * source.height(), 4 * screenBytes);
+    if (m_shm.isNull() || (m_shm->isValid() && m_shm->size() < wantedBytes)) {
+        if (!m_shm.isNull()) {
+            // the server might still read from the old segment
+            Xcb::sync();
+        }
+        m_shm.reset(new Xcb::Shm(qMax(screenBytes, wantedBytes)));
+        m_offset = 0;
+    }
+    if (!m_shm->isValid()) {
+        return false;
+    }
+    const int rowsPerUpload = m_shm->size() / rowBytes;
+    if (rowsPerUpload == 0) {
+        return false;
+    }
+    uchar *buffer = reinterpret_cast<uchar*>(m_shm->buffer());
+    for (int y = 0; y < source.height(); y += rowsPerUpload) {
+        const int rows = qMin(rowsPerUpload, source.height() - y);
+        if (m_offset + rows * rowBytes > m_shm->size()) {
+            Xcb::sync();
+            m_offset = 0;
+        }
+        for (int i = 0; i < rows; ++i) {
+            memcpy(buffer + m_offset + i * rowBytes,
+                   image.constScanLine(source.y() + y + i) + source.x() * 4, rowBytes);
+        }
+        xcb_shm_put_image(connection(), drawable, gc, source.width(), rows, 0, 0, source.width(), rows,
+                          target.x(), target.y() + y, depth, XCB_IMAGE_FORMAT_Z_PIXMAP, 0,
+                          m_shm->segment(), m_offset);
+        m_offset += rows * rowBytes;
+    }
+    return true;
+}
+
 //****************************************
 // SceneXrender::Window
 //****************************************
 
 XRenderPicture *SceneXrender::Window::s_tempPicture = 0;
+XRenderPictureState SceneXrender::Window::s_tempPictureState;
 QRect SceneXrender::Window::temp_visibleRect;
 
 SceneXrender::Window::Window(Toplevel* c, SceneXrender *scene)
@@ -490,6 +616,7 @@ void SceneXrender::Window::cleanup()
 {
     delete s_tempPicture;
     s_tempPicture = NULL;
+    s_tempPictureState.reset();
 }
 
 // Maps window coordinates to screen coordinates
@@ -555,6 +682,7 @@ void SceneXrender::Window::prepareTempPixmap()
         xcb_pixmap_t pix = xcb_generate_id(connection());
         xcb_create_pixmap(connection(), 32, pix, rootWindow(), temp_visibleRect.width(), temp_visibleRect.height());
         s_tempPicture = new XRenderPicture(pix, 32);
+        s_tempPictureState.reset();
         xcb_free_pixmap(connection(), pix);
     }
     const xcb_render_color_t transparent = {0, 0, 0, 0};
@@ -630,7 +758,7 @@ void SceneXrender::Window::performPaint(int mask, QRegion region, WindowPaintDat
         DOUBLE_TO_FIXED(0), DOUBLE_TO_FIXED(1), DOUBLE_TO_FIXED(0),
         DOUBLE_TO_FIXED(0), DOUBLE_TO_FIXED(0), DOUBLE_TO_FIXED(1)
     };
-    static xcb_render_transform_t identity = {
+    static const xcb_render_transform_t identity = {
         DOUBLE_TO_FIXED(1), DOUBLE_TO_FIXED(0), DOUBLE_TO_FIXED(0),
         DOUBLE_TO_FIXED(0), DOUBLE_TO_FIXED(1), DOUBLE_TO_FIXED(0),
         DOUBLE_TO_FIXED(0), DOUBLE_TO_FIXED(0), DOUBLE_TO_FIXED(1)
@@ -650,13 +778,19 @@ void SceneXrender::Window::performPaint(int mask, QRegion region, WindowPaintDat
         xform.matrix22 = DOUBLE_TO_FIXED(1.0 / yscale);
 
         // transform the shape for clipping in paintTransformedScreen()
-        QVector<QRect> rects = transformed_shape.rects();
-        for (int i = 0; i < rects.count(); ++i) {
-            QRect& r = rects[ i ];
-            r.setRect(qRound(r.x() * xscale), qRound(r.y() * yscale),
-                      qRound(r.width() * xscale), qRound(r.height() * yscale));
+        const QSizeF scale(xscale, yscale);
+        if (m_scaledShapeScale != scale || m_scaledShapeSource != transformed_shape) {
+            m_scaledShapeSource = transformed_shape;
+            m_scaledShapeScale = scale;
+            QVector<QRect> rects = transformed_shape.rects();
+            for (int i = 0; i < rects.count(); ++i) {
+                QRect& r = rects[ i ];
+                r.setRect(qRound(r.x() * xscale), qRound(r.y() * yscale),
+                          qRound(r.width() * xscale), qRound(r.height() * yscale));
+            }
+            m_scaledShape.setRects(rects.constData(), rects.count());
         }
-        transformed_shape.setRects(rects.constData(), rects.count());
+        transformed_shape = m_scaledShape;
     }
 
     transformed_shape.translate(mapToScreen(mask, data, QPoint(0, 0)));
@@ -676,6 +810,8 @@ void SceneXrender::Window::performPaint(int mask, QRegion region, WindowPaintDat
     const bool blitInTempPixmap = xRenderOffscreen() || (data.crossFadeProgress() < 1.0 && !opaque) ||
                                  (scaled && (wantShadow || (client && !client->noBorder()) || (deleted && !deleted->noBorder())));
 
+    // The state of the window picture is kept between frames and only changed when needed
+    XRenderPictureState &picState = pixmap->pictureState();
     xcb_render_picture_t renderTarget = m_scene->bufferPicture();
     if (blitInTempPixmap) {
         if (scene_xRenderOffscreenTarget()) {
@@ -685,11 +821,13 @@ void SceneXrender::Window::performPaint(int mask, QRegion region, WindowPaintDat
             prepareTempPixmap();
             renderTarget = *s_tempPicture;
         }
+        // the window is blitted unscaled, the temp pixmap carries the transformation
+        picState.setTransform(pic, identity);
+        picState.setFilter(pic, ImageFilterFast);
+        picState.setRepeat(pic, XCB_RENDER_REPEAT_NONE);
     } else {
-        xcb_render_set_picture_transform(connection(), pic, xform);
-        if (filter == ImageFilterGood) {
-            setPictureFilter(pic, KWin::Scene::ImageFilterGood);
-        }
+        picState.setTransform(pic, scaled ? xform : identity);
+        picState.setFilter(pic, scaled ? filter : ImageFilterFast);
 
         //BEGIN OF STUPID RADEON HACK
         // This is needed to avoid hitting a fallback in the radeon driver.
@@ -703,8 +841,7 @@ void SceneXrender::Window::performPaint(int mask, QRegion region, WindowPaintDat
         // Since we only scale the picture, we can work around this by setting
         // the repeat mode to RepeatPad.
         if (!window()->hasAlpha()) {
-            const uint32_t values[] = {XCB_RENDER_REPEAT_PAD};
-            xcb_render_change_picture(connection(), pic, XCB_RENDER_CP_REPEAT, values);
+            picState.setRepeat(pic, scaled ? XCB_RENDER_REPEAT_PAD : XCB_RENDER_REPEAT_NONE);
         }
         //END OF STUPID RADEON HACK
     }
@@ -814,31 +951,21 @@ xcb_render_composite(connection(), XCB_RENDER_PICT_OP_OVER, m_xrenderShadow->pic
             if (data.crossFadeProgress() < 1.0 && data.crossFadeProgress() > 0.0) {
                 XRenderWindowPixmap *previous = previousWindowPixmap<XRenderWindowPixmap>();
                 if (previous && previous != pixmap) {
-                    static XRenderPicture cFadeAlpha(XCB_RENDER_PICTURE_NONE);
-                    static xcb_render_color_t cFadeColor = {0, 0, 0, 0};
-                    cFadeColor.alpha = uint16_t((1.0 - data.crossFadeProgress()) * 0xffff);
-                    if (cFadeAlpha == XCB_RENDER_PICTURE_NONE) {
-                        cFadeAlpha = xRenderFill(cFadeColor);
-                    } else {
-                        xcb_rectangle_t rect = {0, 0, 1, 1};
-                        xcb_render_fill_rectangles(connection(), XCB_RENDER_PICT_OP_SRC, cFadeAlpha, cFadeColor , 1, &rect);
-                    }
+                    const xcb_render_picture_t cFadeAlpha = xRenderBlendPicture(1.0 - data.crossFadeProgress());
                     if (previous->size() != pixmap->size()) {
                         xcb_render_transform_t xform2 = {
                             DOUBLE_TO_FIXED(FIXED_TO_DOUBLE(xform.matrix11) * previous->size().width() / pixmap->size().width()), DOUBLE_TO_FIXED(0), DOUBLE_TO_FIXED(0),
                             DOUBLE_TO_FIXED(0), DOUBLE_TO_FIXED(FIXED_TO_DOUBLE(xform.matrix22) * previous->size().height() / pixmap->size().height()), DOUBLE_TO_FIXED(0),
                             DOUBLE_TO_FIXED(0), DOUBLE_TO_FIXED(0), DOUBLE_TO_FIXED(1)
                             };
-                        xcb_render_set_picture_transform(connection(), previous->picture(), xform2);
+                        previous->pictureState().setTransform(previous->picture(), xform2);
+                    } else {
+                        previous->pictureState().setTransform(previous->picture(), identity);
                     }
 
                     xcb_render_composite(connection(), opaque ? XCB_RENDER_PICT_OP_OVER : XCB_RENDER_PICT_OP_ATOP,
                                          previous->picture(), cFadeAlpha, renderTarget,
                                          cr.x(), cr.y(), 0, 0, dr.x(), dr.y(), dr.width(), dr.height());
-
-                    if (previous->size() != pixmap->size()) {
-                        xcb_render_set_picture_transform(connection(), previous->picture(), identity);
-                    }
                 }
             }
             if (!opaque)
@@ -886,39 +1013,18 @@ xcb_render_composite(connection(), XCB_RENDER_PICT_OP_OVER, m_xrenderShadow->pic
         }
         if (blitInTempPixmap) {
             const QRect r = mapToScreen(mask, data, temp_visibleRect);
-            xcb_render_set_picture_transform(connection(), *s_tempPicture, xform);
-            setPictureFilter(*s_tempPicture, filter);
+            s_tempPictureState.setTransform(*s_tempPicture, xform);
+            s_tempPictureState.setFilter(*s_tempPicture, filter);
             xcb_render_composite(connection(), XCB_RENDER_PICT_OP_OVER, *s_tempPicture,
                                  XCB_RENDER_PICTURE_NONE, m_scene->bufferPicture(),
                                  0, 0, 0, 0, r.x(), r.y(), r.width(), r.height());
-            xcb_render_set_picture_transform(connection(), *s_tempPicture, identity);
-        }
-    }
-    if (scaled && !blitInTempPixmap) {
-        xcb_render_set_picture_transform(connection(), pic, identity);
-        if (filter == ImageFilterGood)
-            setPictureFilter(pic, KWin::Scene::ImageFilterFast);
-        if (!window()->hasAlpha()) {
-            const uint32_t values[] = {XCB_RENDER_REPEAT_NONE};
-            xcb_render_change_picture(connection(), pic, XCB_RENDER_CP_REPEAT, values);
         }
     }
-    if (xRenderOffscreen())
+    if (xRenderOffscreen()) {
+        // effects read the offscreen target back unscaled
+        s_tempPictureState.setTransform(*s_tempPicture, identity);
         scene_setXRenderOffscreenTarget(*s_tempPicture);
-}
-
-void SceneXrender::Window::setPictureFilter(xcb_render_picture_t pic, Scene::ImageFilterType filter)
-{
-    QByteArray filterName;
-    switch (filter) {
-    case KWin::Scene::ImageFilterFast:
-        filterName = QByteArray("fast");
-        break;
-    case KWin::Scene::ImageFilterGood:
-        filterName = QByteArray("good");
-        break;
     }
-    xcb_render_set_picture_filter(connection(), pic, filterName.length(), filterName.constData(), 0, NULL);
 }
 
 WindowPixmap* SceneXrender::Window::createWindowPixmap()
@@ -974,6 +1080,7 @@ SceneXrender::EffectFrame::EffectFrame(EffectFrameImpl* frame)
 {
     m_picture = NULL;
     m_textPicture = NULL;
+    m_textPictureOutdated = false;
     m_iconPicture = NULL;
     m_selectionPicture = NULL;
 }
@@ -1012,8 +1119,7 @@ void SceneXrender::EffectFrame::freeIconFrame()
 
 void SceneXrender::EffectFrame::freeTextFrame()
 {
-    delete m_textPicture;
-    m_textPicture = NULL;
+    m_textPictureOutdated = true;
 }
 
 void SceneXrender::EffectFrame::freeSelection()
@@ -1085,7 +1191,7 @@ void SceneXrender::EffectFrame::render(QRegion region, double opacity, double fr
 
     // Render text
     if (!m_effectFrame->text().isEmpty()) {
-        if (!m_textPicture) { // Lazy creation
+        if (!m_textPicture || m_textPictureOutdated) { // Lazy creation
             updateTextPicture();
         }
         xcb_render_composite(connection(), XCB_RENDER_PICT_OP_OVER, *m_textPicture, fill, effects->xrenderBufferPicture(),
@@ -1196,10 +1302,10 @@ void SceneXrender::EffectFrame::updatePicture()
 void SceneXrender::EffectFrame::updateTextPicture()
 {
     // Mostly copied from SceneOpenGL::EffectFrame::updateTextTexture() above
-    delete m_textPicture;
-    m_textPicture = 0L;
-
+    m_textPictureOutdated = false;
     if (m_effectFrame->text().isEmpty()) {
+        delete m_textPicture;
+        m_textPicture = 0L;
         return;
     }
 
@@ -1228,7 +1334,11 @@ void SceneXrender::EffectFrame::updateTextPicture()
     }
     p.drawText(rect, m_effectFrame->alignment(), text);
     p.end();
-    m_textPicture = new XRenderPicture(pixmap.toImage());
+    if (m_textPicture) {
+        m_textPicture->update(pixmap.toImage());
+    } else {
+        m_textPicture = new XRenderPicture(pixmap.toImage());
+    }
 }
 
 SceneXRenderShadow::SceneXRenderShadow(Toplevel *toplevel)
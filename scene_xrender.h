@@ -23,6 +23,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "scene.h"
 #include "shadow.h"
+#include "kwinxrenderutils.h"
 
 #ifdef KWIN_HAVE_XRENDER_COMPOSITING
 
@@ -208,6 +209,53 @@ private:
     static ScreenPaintData screen_paint;
     class Window;
     QScopedPointer<XRenderBackend> m_backend;
+    QScopedPointer<XRenderImageUploader> m_uploader;
+};
+
+/**
+ * @short Uploads images through a MIT-SHM segment instead of sending them in PutImage requests.
+ *
+ * The segment is used as a ring buffer: every upload is copied behind the previous one. Only
+ * when the end of the segment is reached a round trip ensures that the server processed all
+ * pending uploads before the segment gets overwritten from the start.
+ *
+ * The segment is created on the first upload with the size of a screen sized image. It gets
+ * replaced by a larger one if an image does not fit, but grows to at most four screens. Larger
+ * images are split.
+ **/
+class XRenderShmUploader : public XRenderImageUploader
+{
+public:
+    XRenderShmUploader();
+    virtual ~XRenderShmUploader();
+    virtual bool upload(xcb_drawable_t drawable, xcb_gcontext_t gc, uint8_t depth,
+                        const QImage &image, const QRect &source, const QPoint &target) override;
+private:
+    QScopedPointer<Xcb::Shm> m_shm;
+    int m_offset;
+};
+
+/**
+ * @short Remembers the transform, filter and repeat mode last set on a picture.
+ *
+ * Setters only send a request to the X server if the value differs from the one which is
+ * already set, so a picture which keeps its state over several frames costs no requests.
+ **/
+class XRenderPictureState
+{
+public:
+    XRenderPictureState();
+    /**
+     * To be called when the picture got (re)created, the server then uses the default state.
+     **/
+    void reset();
+    void setTransform(xcb_render_picture_t pic, const xcb_render_transform_t &transform);
+    void setFilter(xcb_render_picture_t pic, Scene::ImageFilterType filter);
+    void setRepeat(xcb_render_picture_t pic, uint32_t repeat);
+private:
+    xcb_render_transform_t m_transform;
+    Scene::ImageFilterType m_filter;
+    uint32_t m_repeat;
 };
 
 class SceneXrender::Window
@@ -226,13 +274,17 @@ private:
     QRect mapToScreen(int mask, const WindowPaintData &data, const QRect &rect) const;
     QPoint mapToScreen(int mask, const WindowPaintData &data, const QPoint &point) const;
     void prepareTempPixmap();
-    void setPictureFilter(xcb_render_picture_t pic, ImageFilterType filter);
     SceneXrender *m_scene;
     xcb_render_pictformat_t format;
     double alpha_cached_opacity;
     QRegion transformed_shape;
+    // the shape scaled in the last frame, reused as long as shape and scale do not change
+    QRegion m_scaledShapeSource;
+    QRegion m_scaledShape;
+    QSizeF m_scaledShapeScale;
     static QRect temp_visibleRect;
     static XRenderPicture *s_tempPicture;
+    static XRenderPictureState s_tempPictureState;
 };
 
 class XRenderWindowPixmap : public WindowPixmap
@@ -241,10 +293,12 @@ public:
     explicit XRenderWindowPixmap(Scene::Window *window, xcb_render_pictformat_t format);
     virtual ~XRenderWindowPixmap();
     xcb_render_picture_t picture() const;
+    XRenderPictureState &pictureState();
     virtual void create();
 private:
     xcb_render_picture_t m_picture;
     xcb_render_pictformat_t m_format;
+    XRenderPictureState m_pictureState;
 };
 
 class SceneXrender::EffectFrame
@@ -270,6 +324,8 @@ private:
 
     XRenderPicture* m_picture;
     XRenderPicture* m_textPicture;
+    // the text picture is kept when the text changes, so that its pixmap can be reused
+    bool m_textPictureOutdated;
     XRenderPicture* m_iconPicture;
     XRenderPicture* m_selectionPicture;
     static XRenderPicture* s_effectFrameCircle;
@@ -299,6 +355,12 @@ xcb_render_picture_t XRenderWindowPixmap::picture() const
     return m_picture;
 }
 
+inline
+XRenderPictureState &XRenderWindowPixmap::pictureState()
+{
+    return m_pictureState;
+}
+
 /**
  * @short XRender implementation of Shadow.
  *
@@ -22,9 +22,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "cursor.h"
 #include "settings.h"
 #include "workspace.h"
+#include "xcbutils.h"
 #if HAVE_WAYLAND
 #include "wayland_backend.h"
-#include <xcb/randr.h>
 #endif
 
 #include <QApplication>
@@ -166,9 +166,21 @@ int Screens::intersecting(const QRect &r) const
     return cnt;
 }
 
+int Screens::refreshRate(int screen) const
+{
+    Q_UNUSED(screen)
+    return -1;
+}
+
+void Screens::invalidateRefreshRates()
+{
+    emit refreshRatesChanged();
+}
+
 DesktopWidgetScreens::DesktopWidgetScreens(QObject *parent)
     : Screens(parent)
     , m_desktop(QApplication::desktop())
+    , m_refreshRatesDirty(true)
 {
 }
 
@@ -203,11 +215,83 @@ int DesktopWidgetScreens::number(const QPoint &pos) const
     return m_desktop->screenNumber(pos);
 }
 
+int DesktopWidgetScreens::refreshRate(int screen) const
+{
+    if (m_refreshRatesDirty) {
+        updateRefreshRates();
+    }
+    return m_refreshRates.value(screen, -1);
+}
+
+void DesktopWidgetScreens::invalidateRefreshRates()
+{
+    m_refreshRatesDirty = true;
+    Screens::invalidateRefreshRates();
+}
+
 void DesktopWidgetScreens::updateCount()
 {
+    // only mark the rates as outdated, querying the CRTCs needs several roundtrips
+    m_refreshRatesDirty = true;
     setCount(m_desktop->screenCount());
 }
 
+void DesktopWidgetScreens::updateRefreshRates() const
+{
+    m_refreshRatesDirty = false;
+    m_refreshRates.fill(-1, m_desktop->screenCount());
+    if (!Xcb::Extensions::self()->isRandrAvailable()) {
+        return;
+    }
+    xcb_connection_t *c = connection();
+    ScopedCPointer<xcb_randr_get_screen_resources_current_reply_t> resources(xcb_randr_get_screen_resources_current_reply(c,
+        xcb_randr_get_screen_resources_current(c, rootWindow()), nullptr));
+    if (resources.isNull()) {
+        return;
+    }
+    const xcb_randr_crtc_t *crtcs = xcb_randr_get_screen_resources_current_crtcs(resources.data());
+    const int crtcCount = xcb_randr_get_screen_resources_current_crtcs_length(resources.data());
+    const xcb_randr_mode_info_t *modes = xcb_randr_get_screen_resources_current_modes(resources.data());
+    const int modeCount = xcb_randr_get_screen_resources_current_modes_length(resources.data());
+
+    // send all requests before waiting for the first reply
+    QVector<xcb_randr_get_crtc_info_cookie_t> cookies(crtcCount);
+    for (int i = 0; i < crtcCount; ++i) {
+        cookies[i] = xcb_randr_get_crtc_info(c, crtcs[i], resources->config_timestamp);
+    }
+    for (int i = 0; i < crtcCount; ++i) {
+        ScopedCPointer<xcb_randr_get_crtc_info_reply_t> info(xcb_randr_get_crtc_info_reply(c, cookies[i], nullptr));
+        if (info.isNull() || info->mode == XCB_NONE) {
+            continue;
+        }
+        int rate = -1;
+        for (int j = 0; j < modeCount; ++j) {
+            const xcb_randr_mode_info_t &mode = modes[j];
+            if (mode.id != info->mode) {
+                continue;
+            }
+            quint64 dotClock = mode.dot_clock;
+            quint64 vTotal = mode.vtotal;
+            if (mode.mode_flags & XCB_RANDR_MODE_FLAG_INTERLACE) {
+                dotClock *= 2;
+            }
+            if (mode.mode_flags & XCB_RANDR_MODE_FLAG_DOUBLE_SCAN) {
+                vTotal *= 2;
+            }
+            if (mode.htotal * vTotal) {
+                rate = qRound(qreal(dotClock) / (mode.htotal * vTotal));
+            }
+            break;
+        }
+        const QRect crtcGeometry(info->x, info->y, info->width, info->height);
+        for (int screen = 0; screen < m_refreshRates.count(); ++screen) {
+            if (m_desktop->screenGeometry(screen) == crtcGeometry) {
+                m_refreshRates[screen] = qMax(m_refreshRates[screen], rate);
+            }
+        }
+    }
+}
+
 #if HAVE_WAYLAND
 WaylandScreens::WaylandScreens(QObject* parent)
     : Screens(parent)
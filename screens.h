@@ -30,6 +30,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QObject>
 #include <QRect>
 #include <QTimer>
+#include <QVector>
 
 
 class QDesktopWidget;
@@ -89,6 +90,17 @@ public:
      **/
     QSize size() const;
     virtual int number(const QPoint &pos) const = 0;
+    /**
+     * @returns The refresh rate of @p screen in Hz, @c -1 if it is not known.
+     *
+     * If several outputs show the same area the highest rate is returned.
+     **/
+    virtual int refreshRate(int screen) const;
+    /**
+     * Marks the refresh rates as outdated, e.g. because the mode of an output changed without
+     * changing its geometry, and emits refreshRatesChanged().
+     **/
+    virtual void invalidateRefreshRates();
 
     inline bool isChanging() { return m_changedTimer->isActive(); }
 
@@ -116,6 +128,11 @@ Q_SIGNALS:
      * @see size()
      **/
     void sizeChanged();
+    /**
+     * Emitted when the refresh rate of a screen might have changed.
+     * @see refreshRate()
+     **/
+    void refreshRatesChanged();
 
 protected Q_SLOTS:
     void setCount(int count);
@@ -154,11 +171,16 @@ public:
     virtual QRect geometry(int screen) const;
     virtual int number(const QPoint &pos) const;
     QSize size(int screen) const override;
+    int refreshRate(int screen) const override;
+    void invalidateRefreshRates() override;
 protected Q_SLOTS:
     void updateCount();
 
 private:
+    void updateRefreshRates() const;
     QDesktopWidget *m_desktop;
+    mutable QVector<int> m_refreshRates;
+    mutable bool m_refreshRatesDirty;
 };
 
 #if HAVE_WAYLAND
@@ -440,12 +440,23 @@ KWin::Script::~Script()
     QDBusConnection::sessionBus().unregisterObject(QStringLiteral("/") + QString::number(scriptId()));
 }
 
+void KWin::Script::setSource(const QByteArray &source)
+{
+    m_source = source;
+}
+
 void KWin::Script::run()
 {
     if (running() || m_starting) {
         return;
     }
     m_starting = true;
+    if (!m_source.isNull()) {
+        const QByteArray source = m_source;
+        m_source = QByteArray();
+        evaluate(source);
+        return;
+    }
     QFutureWatcher<QByteArray> *watcher = new QFutureWatcher<QByteArray>(this);
     connect(watcher, SIGNAL(finished()), SLOT(slotScriptLoadedFromFile()));
     watcher->setFuture(QtConcurrent::run(this, &KWin::Script::loadScriptFromFile));
@@ -468,10 +479,15 @@ void KWin::Script::slotScriptLoadedFromFile()
         // not invoked from a QFutureWatcher
         return;
     }
-    if (watcher->result().isNull()) {
+    watcher->deleteLater();
+    evaluate(watcher->result());
+}
+
+void KWin::Script::evaluate(const QByteArray &source)
+{
+    if (source.isNull()) {
         // do not load empty script
         deleteLater();
-        watcher->deleteLater();
         return;
     }
     QScriptValue optionsValue = m_engine->newQObject(options, QScriptEngine::QtOwnership,
@@ -482,14 +498,13 @@ void KWin::Script::slotScriptLoadedFromFile()
     KWin::MetaScripting::supplyConfig(m_engine);
     installScriptFunctions(m_engine);
 
-    QScriptValue ret = m_engine->evaluate(QString::fromUtf8(watcher->result()));
+    QScriptValue ret = m_engine->evaluate(QString::fromUtf8(source));
 
     if (ret.isError()) {
         sigException(ret);
         deleteLater();
     }
 
-    watcher->deleteLater();
     setRunning(true);
     m_starting = false;
 }
@@ -543,7 +558,8 @@ void KWin::DeclarativeScript::run()
         return;
     }
 
-    m_component->loadUrl(QUrl::fromLocalFile(scriptFile().fileName()));
+    // compiling the component happens in the thread of the QML type loader
+    m_component->loadUrl(QUrl::fromLocalFile(scriptFile().fileName()), QQmlComponent::Asynchronous);
     if (m_component->isLoading()) {
         connect(m_component, &QQmlComponent::statusChanged, this, &DeclarativeScript::createComponent);
     } else {
@@ -553,6 +569,9 @@ void KWin::DeclarativeScript::run()
 
 void KWin::DeclarativeScript::createComponent()
 {
+    if (m_component->isLoading()) {
+        return;
+    }
     if (m_component->isError()) {
         qDebug() << "Component failed to load: " << m_component->errors();
     } else {
@@ -601,6 +620,7 @@ KWin::Scripting::Scripting(QObject *parent)
     , m_scriptsLock(new QMutex(QMutex::Recursive))
     , m_qmlEngine(new QQmlEngine(this))
     , m_workspaceWrapper(new WorkspaceWrapper(this))
+    , m_queryWatcher(nullptr)
 {
     init();
     QDBusConnection::sessionBus().registerObject(QStringLiteral("/Scripting"), this, QDBusConnection::ExportScriptableContents | QDBusConnection::ExportScriptableInvokables);
@@ -629,30 +649,8 @@ void KWin::Scripting::init()
 
 void KWin::Scripting::start()
 {
-#if 0
-    // TODO make this threaded again once KConfigGroup is sufficiently thread safe, bug #305361 and friends
-    // perform querying for the services in a thread
-    QFutureWatcher<LoadScriptList> *watcher = new QFutureWatcher<LoadScriptList>(this);
-    connect(watcher, SIGNAL(finished()), this, SLOT(slotScriptsQueried()));
-    watcher->setFuture(QtConcurrent::run(this, &KWin::Scripting::queryScriptsToLoad, pluginStates, offers));
-#else
-    LoadScriptList scriptsToLoad = queryScriptsToLoad();
-    for (LoadScriptList::const_iterator it = scriptsToLoad.constBegin();
-            it != scriptsToLoad.constEnd();
-            ++it) {
-        if (it->first) {
-            loadScript(it->second.first, it->second.second);
-        } else {
-            loadDeclarativeScript(it->second.first, it->second.second);
-        }
-    }
-
-    runScripts();
-#endif
-}
-
-LoadScriptList KWin::Scripting::queryScriptsToLoad()
-{
+    // KConfig is not thread safe, so the config is read here and only locating and
+    // reading the script files is done in a thread
     KSharedConfig::Ptr _config = KSharedConfig::openConfig();
     static bool s_started = false;
     if (s_started) {
@@ -660,10 +658,19 @@ LoadScriptList KWin::Scripting::queryScriptsToLoad()
     } else {
         s_started = true;
     }
-    QMap<QString,QString> pluginStates = KConfigGroup(_config, "Plugins").entryMap();
+    const QMap<QString,QString> pluginStates = KConfigGroup(_config, "Plugins").entryMap();
+
+    // a still running query is outdated, its result gets ignored
+    m_queryWatcher = new QFutureWatcher<ScriptQueryResult>(this);
+    connect(m_queryWatcher, SIGNAL(finished()), this, SLOT(slotScriptsQueried()));
+    m_queryWatcher->setFuture(QtConcurrent::run(&KWin::Scripting::queryScriptsToLoad, pluginStates));
+}
+
+KWin::ScriptQueryResult KWin::Scripting::queryScriptsToLoad(const QMap<QString, QString> &pluginStates)
+{
     KService::List offers = KServiceTypeTrader::self()->query(QStringLiteral("KWin/Script"));
 
-    LoadScriptList scriptsToLoad;
+    ScriptQueryResult result;
 
     foreach (const KService::Ptr & service, offers) {
         KPluginInfo plugininfo(service);
@@ -676,10 +683,7 @@ LoadScriptList KWin::Scripting::queryScriptsToLoad()
         }
 
         if (!plugininfo.isPluginEnabled()) {
-            if (isScriptLoaded(plugininfo.pluginName())) {
-                // unload the script
-                unloadScript(plugininfo.pluginName());
-            }
+            result.disabledScripts << plugininfo.pluginName();
             continue;
         }
         const QString pluginName = service->property(QStringLiteral("X-KDE-PluginInfo-Name")).toString();
@@ -689,32 +693,57 @@ LoadScriptList KWin::Scripting::queryScriptsToLoad()
             qDebug() << "Could not find script file for " << pluginName;
             continue;
         }
-        scriptsToLoad << qMakePair(javaScript, qMakePair(file, pluginName));
+        if (javaScript) {
+            QFile scriptFile(file);
+            if (!scriptFile.open(QIODevice::ReadOnly)) {
+                qDebug() << "Could not read script file " << file;
+                continue;
+            }
+            result.sources.insert(file, scriptFile.readAll());
+        }
+        result.scriptsToLoad << qMakePair(javaScript, qMakePair(file, pluginName));
     }
-    return scriptsToLoad;
+    return result;
 }
 
 void KWin::Scripting::slotScriptsQueried()
 {
-    QFutureWatcher<LoadScriptList> *watcher = dynamic_cast< QFutureWatcher<LoadScriptList>* >(sender());
+    QFutureWatcher<ScriptQueryResult> *watcher = dynamic_cast< QFutureWatcher<ScriptQueryResult>* >(sender());
     if (!watcher) {
         // slot invoked not from a FutureWatcher
         return;
     }
+    watcher->deleteLater();
+    if (watcher != m_queryWatcher) {
+        // start got called again in the meantime
+        return;
+    }
+    m_queryWatcher = nullptr;
 
-    LoadScriptList scriptsToLoad = watcher->result();
-    for (LoadScriptList::const_iterator it = scriptsToLoad.constBegin();
-            it != scriptsToLoad.constEnd();
+    const ScriptQueryResult result = watcher->result();
+    foreach (const QString &pluginName, result.disabledScripts) {
+        if (isScriptLoaded(pluginName)) {
+            unloadScript(pluginName);
+        }
+    }
+    for (LoadScriptList::const_iterator it = result.scriptsToLoad.constBegin();
+            it != result.scriptsToLoad.constEnd();
             ++it) {
         if (it->first) {
-            loadScript(it->second.first, it->second.second);
+            // QtScript is not documented to be thread safe, so the syntax is checked here
+            const QByteArray source = result.sources.value(it->second.first);
+            const QScriptSyntaxCheckResult syntax = QScriptEngine::checkSyntax(QString::fromUtf8(source));
+            if (syntax.state() == QScriptSyntaxCheckResult::Error) {
+                qDebug() << "Syntax error in " << it->second.first << "[Line " << syntax.errorLineNumber() << "]:" << syntax.errorMessage();
+                continue;
+            }
+            loadScript(it->second.first, it->second.second, source);
         } else {
             loadDeclarativeScript(it->second.first, it->second.second);
         }
     }
 
     runScripts();
-    watcher->deleteLater();
 }
 
 bool KWin::Scripting::isScriptLoaded(const QString &pluginName) const
@@ -755,6 +784,11 @@ void KWin::Scripting::scriptDestroyed(QObject *object)
 }
 
 int KWin::Scripting::loadScript(const QString &filePath, const QString& pluginName)
+{
+    return loadScript(filePath, pluginName, QByteArray());
+}
+
+int KWin::Scripting::loadScript(const QString &filePath, const QString &pluginName, const QByteArray &source)
 {
     QMutexLocker locker(m_scriptsLock.data());
     if (isScriptLoaded(pluginName)) {
@@ -762,6 +796,7 @@ int KWin::Scripting::loadScript(const QString &filePath, const QString& pluginNa
     }
     const int id = scripts.size();
     KWin::Script *script = new KWin::Script(id, filePath, pluginName, this);
+    script->setSource(source);
     connect(script, SIGNAL(destroyed(QObject*)), SLOT(scriptDestroyed(QObject*)));
     scripts.append(script);
     return id;
@@ -30,6 +30,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QStringList>
 #include <QtScript/QScriptEngineAgent>
 
+template <typename T> class QFutureWatcher;
 class QQmlComponent;
 class QQmlContext;
 class QQmlEngine;
@@ -48,6 +49,21 @@ typedef QList< QPair<bool, QPair<QString, QString > > > LoadScriptList;
 
 namespace KWin
 {
+/**
+ * Result of Scripting::queryScriptsToLoad.
+ **/
+struct ScriptQueryResult {
+    LoadScriptList scriptsToLoad;
+    /**
+     * Content of the JavaScript files in scriptsToLoad, indexed by file path.
+     **/
+    QHash<QString, QByteArray> sources;
+    /**
+     * Plugin names of the installed scripts which are disabled.
+     **/
+    QStringList disabledScripts;
+};
+
 class Client;
 class ScriptUnloaderAgent;
 class WorkspaceWrapper;
@@ -222,6 +238,11 @@ public:
     QScriptEngine *engine() {
         return m_engine;
     }
+    /**
+     * Sets the already read content of the script file, run() evaluates it directly
+     * instead of reading the file again.
+     **/
+    void setSource(const QByteArray &source);
 
 public Q_SLOTS:
     Q_SCRIPTABLE void run();
@@ -247,7 +268,9 @@ private:
      * If file cannot be read an empty byte array is returned.
      **/
     QByteArray loadScriptFromFile();
+    void evaluate(const QByteArray &source);
     QScriptEngine *m_engine;
+    QByteArray m_source;
     bool m_starting;
     QScopedPointer<ScriptUnloaderAgent> m_agent;
 };
@@ -369,10 +392,17 @@ private Q_SLOTS:
 
 private:
     void init();
-    LoadScriptList queryScriptsToLoad();
+    int loadScript(const QString &filePath, const QString &pluginName, const QByteArray &source);
+    /**
+     * Looks up the installed scripts and reads the enabled JavaScript files. Does not access
+     * KConfig, so it can be run in a worker thread.
+     * @param pluginStates The entries of the "Plugins" config group
+     **/
+    static ScriptQueryResult queryScriptsToLoad(const QMap<QString, QString> &pluginStates);
     static Scripting *s_self;
     QQmlEngine *m_qmlEngine;
     WorkspaceWrapper *m_workspaceWrapper;
+    QFutureWatcher<ScriptQueryResult> *m_queryWatcher;
 };
 
 inline
@@ -9,9 +9,16 @@ varying vec2 varyingTexCoords;
 void main() {
     vec4 tex = texture2D(sampler, varyingTexCoords);
 
+    // The variants of the ShaderManager are compiled with KWIN_SATURATION set to 0 or 1
+#ifdef KWIN_SATURATION
+#if KWIN_SATURATION
+    tex.rgb = mix(vec3(dot( vec3( 0.30, 0.59, 0.11 ), tex.rgb )), tex.rgb, saturation);
+#endif
+#else
     if (saturation != 1.0) {
         tex.rgb = mix(vec3(dot( vec3( 0.30, 0.59, 0.11 ), tex.rgb )), tex.rgb, saturation);
     }
+#endif
 
     tex *= modulation;
 
@@ -27,11 +27,17 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <fixx11h.h>
 #include <kconfig.h>
 
+#include "atoms.h"
 #include "workspace.h"
 #include "client.h"
+#include "xcbutils.h"
+#include <KConfigGroup>
+#include <KSharedConfig>
 #include <QDebug>
 #include <QSocketNotifier>
+#include <QStandardPaths>
 #include <QSessionManager>
+#include <QtConcurrentRun>
 
 namespace KWin
 {
@@ -77,6 +83,149 @@ bool SessionManager::commitData(QSessionManager& sm)
 }
 #endif
 
+/**
+ * The session management properties of a client. The requests are sent when the object is
+ * created and the replies are only waited for when the values are read, so creating the
+ * objects for all clients first needs a single roundtrip instead of one per property.
+ *
+ * The values are the same as returned by Toplevel::sessionId() and Toplevel::wmCommand().
+ **/
+class SessionProperties
+{
+public:
+    SessionProperties() = default;
+    explicit SessionProperties(const Client *c);
+    QByteArray sessionId();
+    QByteArray wmCommand();
+
+private:
+    Xcb::StringProperty m_sessionId;
+    Xcb::StringProperty m_wmCommand;
+    Xcb::StringProperty m_leaderSessionId;
+    Xcb::StringProperty m_leaderWmCommand;
+};
+
+SessionProperties::SessionProperties(const Client *c)
+    : m_sessionId(c->window(), atoms->sm_client_id)
+    , m_wmCommand(c->window(), XCB_ATOM_WM_COMMAND)
+{
+    const xcb_window_t leader = c->wmClientLeader();
+    if (leader != c->window()) {
+        m_leaderSessionId = Xcb::StringProperty(leader, atoms->sm_client_id);
+        m_leaderWmCommand = Xcb::StringProperty(leader, XCB_ATOM_WM_COMMAND);
+    }
+}
+
+QByteArray SessionProperties::sessionId()
+{
+    QByteArray result = m_sessionId;
+    if (result.isEmpty()) {
+        result = m_leaderSessionId;
+    }
+    return result;
+}
+
+QByteArray SessionProperties::wmCommand()
+{
+    QByteArray result = m_wmCommand;
+    if (result.isEmpty()) {
+        result = m_leaderWmCommand;
+    }
+    result.replace(0, ' ');
+    return result;
+}
+
+static QVector<SessionProperties> fetchSessionProperties(const ClientList &clients)
+{
+    QVector<SessionProperties> properties;
+    properties.reserve(clients.count());
+    foreach (const Client *c, clients) {
+        properties << SessionProperties(c);
+    }
+    return properties;
+}
+
+// SessionWriter
+
+struct SessionGroupChange {
+    QString name;
+    QStandardPaths::StandardLocation location;
+    QString group;
+    QVariantMap changed;
+    QStringList removed;
+    bool replace; // remove all entries which are not in changed
+};
+
+static void writeSessionGroup(const SessionGroupChange &change)
+{
+    KConfig config(change.name, KConfig::SimpleConfig, change.location);
+    KConfigGroup cg(&config, change.group);
+    if (change.replace) {
+        foreach (const QString &key, cg.keyList()) {
+            if (!change.changed.contains(key)) {
+                cg.deleteEntry(key);
+            }
+        }
+    }
+    foreach (const QString &key, change.removed) {
+        cg.deleteEntry(key);
+    }
+    for (QVariantMap::const_iterator it = change.changed.constBegin(); it != change.changed.constEnd(); ++it) {
+        cg.writeEntry(it.key(), it.value());
+    }
+    config.sync();
+}
+
+SessionWriter::SessionWriter()
+{
+}
+
+SessionWriter::~SessionWriter()
+{
+    waitForFinished();
+}
+
+void SessionWriter::write(KConfig *config, const QString &group, const QVariantMap &entries)
+{
+    QHash<QString, WrittenGroup>::const_iterator previous = m_written.constFind(group);
+    SessionGroupChange change;
+    change.name = config->name();
+    change.location = config->locationType();
+    change.group = group;
+    // the entries of a previous write to another file don't tell anything about this one
+    change.replace = previous == m_written.constEnd() || previous->name != change.name;
+    if (change.replace) {
+        change.changed = entries;
+    } else {
+        const QVariantMap &written = previous->entries;
+        for (QVariantMap::const_iterator it = entries.constBegin(); it != entries.constEnd(); ++it) {
+            QVariantMap::const_iterator old = written.constFind(it.key());
+            if (old == written.constEnd() || old.value() != it.value()) {
+                change.changed.insert(it.key(), it.value());
+            }
+        }
+        for (QVariantMap::const_iterator it = written.constBegin(); it != written.constEnd(); ++it) {
+            if (!entries.contains(it.key())) {
+                change.removed << it.key();
+            }
+        }
+        if (change.changed.isEmpty() && change.removed.isEmpty()) {
+            return;
+        }
+    }
+    WrittenGroup &written = m_written[group];
+    written.name = change.name;
+    written.entries = entries;
+    // writes to the same file have to happen in order
+    waitForFinished();
+    m_future = QtConcurrent::run(writeSessionGroup, change);
+}
+
+void SessionWriter::waitForFinished()
+{
+    m_future.waitForFinished();
+}
+
 // Workspace
 
 /*!
@@ -86,14 +235,15 @@ bool SessionManager::commitData(QSessionManager& sm)
  */
 void Workspace::storeSession(KConfig* config, SMSavePhase phase)
 {
-    KConfigGroup cg(config, "Session");
+    QVariantMap entries;
     int count =  0;
     int active_client = -1;
 
-    for (ClientList::Iterator it = clients.begin(); it != clients.end(); ++it) {
-        Client* c = (*it);
-        QByteArray sessionId = c->sessionId();
-        QByteArray wmCommand = c->wmCommand();
+    QVector<SessionProperties> properties = fetchSessionProperties(clients);
+    for (int i = 0; i < clients.count(); ++i) {
+        Client* c = clients.at(i);
+        QByteArray sessionId = properties[i].sessionId();
+        QByteArray wmCommand = properties[i].wmCommand();
         if (sessionId.isEmpty())
             // remember also applications that are not XSMP capable
             // and use the obsolete WM_COMMAND / WM_SAVE_YOURSELF
@@ -103,7 +253,7 @@ void Workspace::storeSession(KConfig* config, SMSavePhase phase)
         if (c->isActive())
             active_client = count;
         if (phase == SMSavePhase2 || phase == SMSavePhase2Full)
-            storeClient(cg, count, c);
+            storeClient(entries, count, c, sessionId, wmCommand);
     }
     if (phase == SMSavePhase0) {
         // it would be much simpler to save these values to the config file,
@@ -111,65 +261,70 @@ void Workspace::storeSession(KConfig* config, SMSavePhase phase)
         // which results in different sessionkey and different config file :(
         session_active_client = active_client;
         session_desktop = VirtualDesktopManager::self()->current();
-    } else if (phase == SMSavePhase2) {
-        cg.writeEntry("count", count);
-        cg.writeEntry("active", session_active_client);
-        cg.writeEntry("desktop", session_desktop);
+        return;
+    }
+    if (phase == SMSavePhase2) {
+        entries.insert(QStringLiteral("count"), count);
+        entries.insert(QStringLiteral("active"), session_active_client);
+        entries.insert(QStringLiteral("desktop"), session_desktop);
     } else { // SMSavePhase2Full
-        cg.writeEntry("count", count);
-        cg.writeEntry("active", session_active_client);
-        cg.writeEntry("desktop", VirtualDesktopManager::self()->current());
+        entries.insert(QStringLiteral("count"), count);
+        entries.insert(QStringLiteral("active"), session_active_client);
+        entries.insert(QStringLiteral("desktop"), VirtualDesktopManager::self()->current());
     }
+    m_sessionWriter.write(config, QStringLiteral("Session"), entries);
+    // phase 2 is the end of the save, the session manager may quit us once it returns
+    m_sessionWriter.waitForFinished();
 }
 
-void Workspace::storeClient(KConfigGroup &cg, int num, Client *c)
+void Workspace::storeClient(QVariantMap &entries, int num, Client *c, const QByteArray &sessionId, const QByteArray &wmCommand)
 {
     c->setSessionInteract(false); //make sure we get the real values
     QString n = QString::number(num);
-    cg.writeEntry(QStringLiteral("sessionId") + n, c->sessionId().constData());
-    cg.writeEntry(QStringLiteral("windowRole") + n, c->windowRole().constData());
-    cg.writeEntry(QStringLiteral("wmCommand") + n, c->wmCommand().constData());
-    cg.writeEntry(QStringLiteral("resourceName") + n, c->resourceName().constData());
-    cg.writeEntry(QStringLiteral("resourceClass") + n, c->resourceClass().constData());
-    cg.writeEntry(QStringLiteral("geometry") + n, QRect(c->calculateGravitation(true), c->clientSize()));   // FRAME
-    cg.writeEntry(QStringLiteral("restore") + n, c->geometryRestore());
-    cg.writeEntry(QStringLiteral("fsrestore") + n, c->geometryFSRestore());
-    cg.writeEntry(QStringLiteral("maximize") + n, (int) c->maximizeMode());
-    cg.writeEntry(QStringLiteral("fullscreen") + n, (int) c->fullScreenMode());
-    cg.writeEntry(QStringLiteral("desktop") + n, c->desktop());
+    entries.insert(QStringLiteral("sessionId") + n, QString::fromUtf8(sessionId));
+    entries.insert(QStringLiteral("windowRole") + n, QString::fromUtf8(c->windowRole()));
+    entries.insert(QStringLiteral("wmCommand") + n, QString::fromUtf8(wmCommand));
+    entries.insert(QStringLiteral("resourceName") + n, QString::fromUtf8(c->resourceName()));
+    entries.insert(QStringLiteral("resourceClass") + n, QString::fromUtf8(c->resourceClass()));
+    entries.insert(QStringLiteral("geometry") + n, QRect(c->calculateGravitation(true), c->clientSize()));   // FRAME
+    entries.insert(QStringLiteral("restore") + n, c->geometryRestore());
+    entries.insert(QStringLiteral("fsrestore") + n, c->geometryFSRestore());
+    entries.insert(QStringLiteral("maximize") + n, (int) c->maximizeMode());
+    entries.insert(QStringLiteral("fullscreen") + n, (int) c->fullScreenMode());
+    entries.insert(QStringLiteral("desktop") + n, c->desktop());
     // the config entry is called "iconified" for back. comp. reasons
     // (kconf_update script for updating session files would be too complicated)
-    cg.writeEntry(QStringLiteral("iconified") + n, c->isMinimized());
-    cg.writeEntry(QStringLiteral("opacity") + n, c->opacity());
+    entries.insert(QStringLiteral("iconified") + n, c->isMinimized());
+    entries.insert(QStringLiteral("opacity") + n, c->opacity());
     // the config entry is called "sticky" for back. comp. reasons
-    cg.writeEntry(QStringLiteral("sticky") + n, c->isOnAllDesktops());
-    cg.writeEntry(QStringLiteral("shaded") + n, c->isShade());
+    entries.insert(QStringLiteral("sticky") + n, c->isOnAllDesktops());
+    entries.insert(QStringLiteral("shaded") + n, c->isShade());
     // the config entry is called "staysOnTop" for back. comp. reasons
-    cg.writeEntry(QStringLiteral("staysOnTop") + n, c->keepAbove());
-    cg.writeEntry(QStringLiteral("keepBelow") + n, c->keepBelow());
-    cg.writeEntry(QStringLiteral("skipTaskbar") + n, c->skipTaskbar(true));
-    cg.writeEntry(QStringLiteral("skipPager") + n, c->skipPager());
-    cg.writeEntry(QStringLiteral("skipSwitcher") + n, c->skipSwitcher());
+    entries.insert(QStringLiteral("staysOnTop") + n, c->keepAbove());
+    entries.insert(QStringLiteral("keepBelow") + n, c->keepBelow());
+    entries.insert(QStringLiteral("skipTaskbar") + n, c->skipTaskbar(true));
+    entries.insert(QStringLiteral("skipPager") + n, c->skipPager());
+    entries.insert(QStringLiteral("skipSwitcher") + n, c->skipSwitcher());
     // not really just set by user, but name kept for back. comp. reasons
-    cg.writeEntry(QStringLiteral("userNoBorder") + n, c->noBorder());
-    cg.writeEntry(QStringLiteral("windowType") + n, windowTypeToTxt(c->windowType()));
-    cg.writeEntry(QStringLiteral("shortcut") + n, c->shortcut().toString());
-    cg.writeEntry(QStringLiteral("stackingOrder") + n, unconstrained_stacking_order.indexOf(c));
+    entries.insert(QStringLiteral("userNoBorder") + n, c->noBorder());
+    entries.insert(QStringLiteral("windowType") + n, QString::fromLatin1(windowTypeToTxt(c->windowType())));
+    entries.insert(QStringLiteral("shortcut") + n, c->shortcut().toString());
+    entries.insert(QStringLiteral("stackingOrder") + n, unconstrained_stacking_order.indexOf(c));
     // KConfig doesn't support long so we need to live with less precision on 64-bit systems
-    cg.writeEntry(QStringLiteral("tabGroup") + n, static_cast<int>(reinterpret_cast<long>(c->tabGroup())));
-    cg.writeEntry(QStringLiteral("activities") + n, c->activities());
+    entries.insert(QStringLiteral("tabGroup") + n, static_cast<int>(reinterpret_cast<long>(c->tabGroup())));
+    entries.insert(QStringLiteral("activities") + n, c->activities());
 }
 
 void Workspace::storeSubSession(const QString &name, QSet<QByteArray> sessionIds)
 {
-    //TODO clear it first
-    KConfigGroup cg(KSharedConfig::openConfig(), QStringLiteral("SubSession: ") + name);
+    QVariantMap entries;
     int count =  0;
     int active_client = -1;
-    for (ClientList::Iterator it = clients.begin(); it != clients.end(); ++it) {
-        Client* c = (*it);
-        QByteArray sessionId = c->sessionId();
-        QByteArray wmCommand = c->wmCommand();
+    QVector<SessionProperties> properties = fetchSessionProperties(clients);
+    for (int i = 0; i < clients.count(); ++i) {
+        Client* c = clients.at(i);
+        QByteArray sessionId = properties[i].sessionId();
+        QByteArray wmCommand = properties[i].wmCommand();
         if (sessionId.isEmpty())
             // remember also applications that are not XSMP capable
             // and use the obsolete WM_COMMAND / WM_SAVE_YOURSELF
@@ -182,11 +337,12 @@ void Workspace::storeSubSession(const QString &name, QSet<QByteArray> sessionIds
         count++;
         if (c->isActive())
             active_client = count;
-        storeClient(cg, count, c);
+        storeClient(entries, count, c, sessionId, wmCommand);
     }
-    cg.writeEntry("count", count);
-    cg.writeEntry("active", active_client);
-    //cg.writeEntry( "desktop", currentDesktop());
+    entries.insert(QStringLiteral("count"), count);
+    entries.insert(QStringLiteral("active"), active_client);
+    //entries.insert(QStringLiteral("desktop"), currentDesktop());
+    m_sessionWriter.write(KSharedConfig::openConfig().data(), QStringLiteral("SubSession: ") + name, entries);
 }
 
 /*!
@@ -245,6 +401,9 @@ void Workspace::addSessionInfo(KConfigGroup &cg)
 
 void Workspace::loadSubSessionInfo(const QString &name)
 {
+    // the sub session might still be written by the worker thread
+    m_sessionWriter.waitForFinished();
+    KSharedConfig::openConfig()->reparseConfiguration();
     KConfigGroup cg(KSharedConfig::openConfig(), QStringLiteral("SubSession: ") + name);
     addSessionInfo(cg);
 }
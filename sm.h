@@ -24,7 +24,10 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <QDataStream>
 #include <kwinglobals.h>
+#include <QFuture>
+#include <QHash>
 #include <QStringList>
+#include <QVariant>
 #if KWIN_QT5_PORTING
 #include <ksessionmanager.h>
 #endif
@@ -35,6 +38,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <fixx11h.h>
 
 class QSocketNotifier;
+class KConfig;
 
 namespace KWin
 {
@@ -82,6 +86,41 @@ enum SMSavePhase {
     SMSavePhase2Full  // complete saving in phase2, there was no phase 0
 };
 
+/**
+ * @short Writes session data to config files without blocking the window manager.
+ *
+ * The entries of a group are compared with the ones written to it before, only the changed
+ * and removed entries are passed on to a worker thread, which writes and syncs the file.
+ * The first time a group gets written all other entries in it are removed. Only the last write
+ * of each group is remembered, so writing a group to a new file, e.g. the config of a new
+ * session, replaces it as well.
+ *
+ * The worker uses its own KConfig for the file, so KConfig objects on the main thread have
+ * to be reparsed after waitForFinished() to see the new values.
+ **/
+class SessionWriter
+{
+public:
+    SessionWriter();
+    ~SessionWriter();
+    /**
+     * Replaces the content of @p group in the file of @p config with @p entries.
+     **/
+    void write(KConfig *config, const QString &group, const QVariantMap &entries);
+    /**
+     * Blocks until the last write reached the config file.
+     **/
+    void waitForFinished();
+
+private:
+    struct WrittenGroup {
+        QString name; // of the config file
+        QVariantMap entries;
+    };
+    QHash<QString, WrittenGroup> m_written;
+    QFuture<void> m_future;
+};
+
 class SessionSaveDoneHelper
     : public QObject
 {
@@ -0,0 +1,119 @@
+/********************************************************************
+ KWin - the KDE window manager
+ This file is part of the KDE project.
+
+Copyright (C) 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#include "snapedgeindex.h"
+
+#include <algorithm>
+
+namespace KWin
+{
+
+SnapEdgeIndex::SnapEdgeIndex()
+    : m_serial(0)
+{
+}
+
+void SnapEdgeIndex::insert(Client *client, const QRect &geometry)
+{
+    if (m_entries.contains(client)) {
+        update(client, geometry);
+        return;
+    }
+    Entry entry;
+    entry.geometry = geometry;
+    entry.serial = m_serial++;
+    m_entries.insert(client, entry);
+    addEdges(client, geometry);
+}
+
+void SnapEdgeIndex::update(Client *client, const QRect &geometry)
+{
+    auto it = m_entries.find(client);
+    if (it == m_entries.end() || it->geometry == geometry) {
+        return;
+    }
+    removeEdges(client, it->geometry);
+    it->geometry = geometry;
+    addEdges(client, geometry);
+}
+
+void SnapEdgeIndex::remove(Client *client)
+{
+    auto it = m_entries.find(client);
+    if (it == m_entries.end()) {
+        return;
+    }
+    removeEdges(client, it->geometry);
+    m_entries.erase(it);
+}
+
+void SnapEdgeIndex::clear()
+{
+    m_entries.clear();
+    m_verticalEdges.clear();
+    m_horizontalEdges.clear();
+}
+
+void SnapEdgeIndex::addEdges(Client *client, const QRect &geometry)
+{
+    m_verticalEdges.insert(geometry.x(), client);
+    m_verticalEdges.insert(geometry.x() + geometry.width(), client);
+    m_horizontalEdges.insert(geometry.y(), client);
+    m_horizontalEdges.insert(geometry.y() + geometry.height(), client);
+}
+
+void SnapEdgeIndex::removeEdges(Client *client, const QRect &geometry)
+{
+    // QMultiMap::remove drops all matching pairs, a zero sized geometry has each edge twice
+    m_verticalEdges.remove(geometry.x(), client);
+    m_verticalEdges.remove(geometry.x() + geometry.width(), client);
+    m_horizontalEdges.remove(geometry.y(), client);
+    m_horizontalEdges.remove(geometry.y() + geometry.height(), client);
+}
+
+void SnapEdgeIndex::collect(const QMultiMap<int, Client*> &edges, int position, int distance,
+                            QList<Client*> &result)
+{
+    const int last = position + distance - 1;
+    for (auto it = edges.lowerBound(position - distance + 1); it != edges.constEnd() && it.key() <= last; ++it) {
+        result << it.value();
+    }
+}
+
+QList<Client*> SnapEdgeIndex::candidates(const QRect &geometry, int distance) const
+{
+    QList<Client*> result;
+    if (distance <= 0) {
+        return result;
+    }
+    collect(m_verticalEdges, geometry.x(), distance, result);
+    collect(m_verticalEdges, geometry.x() + geometry.width(), distance, result);
+    collect(m_horizontalEdges, geometry.y(), distance, result);
+    collect(m_horizontalEdges, geometry.y() + geometry.height(), distance, result);
+
+    std::sort(result.begin(), result.end(),
+        [this](Client *a, Client *b) {
+            return m_entries.value(a).serial < m_entries.value(b).serial;
+        }
+    );
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+    return result;
+}
+
+} // namespace
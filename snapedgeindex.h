@@ -0,0 +1,100 @@
+/********************************************************************
+ KWin - the KDE window manager
+ This file is part of the KDE project.
+
+Copyright (C) 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+
+#ifndef KWIN_SNAPEDGEINDEX_H
+#define KWIN_SNAPEDGEINDEX_H
+
+#include <QHash>
+#include <QList>
+#include <QMultiMap>
+#include <QRect>
+
+namespace KWin
+{
+
+class Client;
+
+/**
+ * @short Sorted index of the window edges used for snapping during interactive moves.
+ *
+ * The index keeps the left and right edges (x and x + width) and the top and bottom edges
+ * (y and y + height) of all inserted clients in sorted maps. A move only has to look at the
+ * clients which have an edge close to an edge of the moved window instead of all clients.
+ *
+ * The index does not know about virtual desktops, activities or minimized windows, the
+ * caller has to filter the returned candidates.
+ **/
+class SnapEdgeIndex
+{
+public:
+    SnapEdgeIndex();
+
+    /**
+     * Adds @p client with @p geometry to the index. Clients are returned in the order they
+     * were inserted.
+     **/
+    void insert(Client *client, const QRect &geometry);
+    /**
+     * Updates the edges of @p client to @p geometry. Does nothing if @p client is not indexed.
+     **/
+    void update(Client *client, const QRect &geometry);
+    void remove(Client *client);
+    void clear();
+    bool contains(Client *client) const;
+    int count() const;
+
+    /**
+     * @returns The clients with a vertical edge closer than @p distance to the left or right
+     * edge of @p geometry or a horizontal edge closer than @p distance to its top or bottom
+     * edge, in insertion order. Right and bottom edges are exclusive, i.e. x + width.
+     **/
+    QList<Client*> candidates(const QRect &geometry, int distance) const;
+
+private:
+    struct Entry {
+        QRect geometry;
+        quint64 serial;
+    };
+    void addEdges(Client *client, const QRect &geometry);
+    void removeEdges(Client *client, const QRect &geometry);
+    static void collect(const QMultiMap<int, Client*> &edges, int position, int distance,
+                        QList<Client*> &result);
+
+    QHash<Client*, Entry> m_entries;
+    QMultiMap<int, Client*> m_verticalEdges;
+    QMultiMap<int, Client*> m_horizontalEdges;
+    quint64 m_serial;
+};
+
+inline
+bool SnapEdgeIndex::contains(Client *client) const
+{
+    return m_entries.contains(client);
+}
+
+inline
+int SnapEdgeIndex::count() const
+{
+    return m_entries.count();
+}
+
+} // namespace
+
+#endif
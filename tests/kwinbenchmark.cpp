@@ -0,0 +1,487 @@
+/*
+ * Copyright 2026  agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDBusConnection>
+#include <QDBusConnectionInterface>
+#include <QDBusMessage>
+#include <QElapsedTimer>
+#include <QRect>
+#include <QRegularExpression>
+#include <QThread>
+#include <QVector>
+#include <cstring>
+#include <iostream>
+#include <poll.h>
+#include <xcb/xcb.h>
+
+/*
+ * This is a small benchmark app which generates a synthetic workload for KWin.
+ *
+ * The application creates a number of windows and runs them through the phases
+ * map, move, resize, damage, desktop switch, focus and close. For every phase it prints how long it took until
+ * KWin handled all requests and the timing statistics KWin collected during the phase
+ * (Compositor::performCompositing, the effect chain and Client::manage). The damage phase
+ * produces frames at a fixed rate, it prints the composited frames and their duration instead.
+ *
+ * The application is meant to be run on a dedicated X server against a freshly started
+ * KWin, see kwinbenchmark.sh which does this for the available compositing modes.
+ */
+
+static const char *s_kwinService = "org.kde.KWin";
+
+class Benchmark
+{
+public:
+    Benchmark(xcb_connection_t *c, xcb_screen_t *screen, int windowCount, int steps, int desktops);
+    ~Benchmark();
+
+    void map();
+    void move();
+    void resize();
+    void damage();
+    void switchDesktop();
+    void focus();
+    void close();
+
+private:
+    /**
+     * Handles all events till the X server did not send any event matching @p filter for
+     * @p quietTime milliseconds. Returns the elapsed time till the last matching event.
+     **/
+    template <typename Filter>
+    qint64 waitForQuiescence(const QElapsedTimer &timer, Filter filter, int quietTime = 200);
+    xcb_window_t eventWindow(xcb_generic_event_t *event) const;
+    bool isOurWindow(xcb_window_t window) const;
+    QRect windowGeometry(int index, int step) const;
+    xcb_atom_t atom(const char *name) const;
+    void sendRootMessage(xcb_atom_t type, uint32_t data);
+    void sendMessage(xcb_window_t window, xcb_atom_t type, uint32_t data0, uint32_t data1);
+
+    xcb_connection_t *m_connection;
+    xcb_screen_t *m_screen;
+    QVector<xcb_window_t> m_windows;
+    xcb_gcontext_t m_gc;
+    int m_steps;
+    int m_desktops;
+    xcb_atom_t m_currentDesktop;
+};
+
+static QString timingStatistics()
+{
+    QDBusMessage message = QDBusMessage::createMethodCall(QString::fromUtf8(s_kwinService), QStringLiteral("/KWin"),
+                                                          QStringLiteral("org.kde.KWin"), QStringLiteral("supportInformation"));
+    const QDBusMessage reply = QDBusConnection::sessionBus().call(message);
+    if (reply.type() != QDBusMessage::ReplyMessage || reply.arguments().isEmpty()) {
+        std::cerr << "Could not get the support information from KWin" << std::endl;
+        return QString();
+    }
+    const QString support = reply.arguments().first().toString();
+    const int index = support.indexOf(QStringLiteral("Timing Statistics"));
+    if (index == -1) {
+        return QString();
+    }
+    return support.mid(index);
+}
+
+static void printPhase(const char *name, qint64 elapsed)
+{
+    std::cout << "== " << name << " ==" << std::endl;
+    std::cout << "Completed in " << elapsed << " ms" << std::endl;
+    std::cout << qPrintable(timingStatistics()) << std::endl;
+}
+
+/*
+ * For phases which generate work at a fixed rate the elapsed time says nothing, instead
+ * the frames KWin composited during the phase are reported.
+ */
+static void printFramePhase(const char *name, qint64 elapsed)
+{
+    std::cout << "== " << name << " ==" << std::endl;
+    const QString statistics = timingStatistics();
+    const QRegularExpressionMatch match = QRegularExpression(
+        QStringLiteral("Compositing: (\\d+) samples, average ([\\d.]+) ms, maximum ([\\d.]+) ms")).match(statistics);
+    if (match.hasMatch()) {
+        const quint64 frames = match.captured(1).toULongLong();
+        std::cout << "Frames: " << frames << " (" << (elapsed ? frames * 1000 / elapsed : 0) << " per second)" << std::endl;
+        std::cout << "Per frame: average " << qPrintable(match.captured(2)) << " ms, maximum "
+                  << qPrintable(match.captured(3)) << " ms" << std::endl;
+    } else {
+        std::cout << "No frames got composited" << std::endl;
+    }
+    std::cout << qPrintable(statistics) << std::endl;
+}
+
+static void resetStatistics()
+{
+    QDBusMessage message = QDBusMessage::createMethodCall(QString::fromUtf8(s_kwinService), QStringLiteral("/KWin"),
+                                                          QStringLiteral("org.kde.KWin"), QStringLiteral("resetTimingStatistics"));
+    QDBusConnection::sessionBus().call(message);
+}
+
+Benchmark::Benchmark(xcb_connection_t *c, xcb_screen_t *screen, int windowCount, int steps, int desktops)
+    : m_connection(c)
+    , m_screen(screen)
+    , m_gc(xcb_generate_id(c))
+    , m_steps(steps)
+    , m_desktops(desktops)
+    , m_currentDesktop(atom("_NET_CURRENT_DESKTOP"))
+{
+    m_windows.resize(windowCount);
+    for (int i = 0; i < windowCount; ++i) {
+        m_windows[i] = xcb_generate_id(c);
+    }
+    xcb_create_gc(c, m_gc, screen->root, 0, nullptr);
+    // get notified about changes of _NET_CLIENT_LIST
+    const uint32_t rootValues[] = { XCB_EVENT_MASK_PROPERTY_CHANGE };
+    xcb_change_window_attributes(c, screen->root, XCB_CW_EVENT_MASK, rootValues);
+}
+
+Benchmark::~Benchmark()
+{
+    xcb_free_gc(m_connection, m_gc);
+}
+
+QRect Benchmark::windowGeometry(int index, int step) const
+{
+    const int columns = 8;
+    const int x = (index % columns) * m_screen->width_in_pixels / columns;
+    const int y = ((index / columns) * 50) % (m_screen->height_in_pixels / 2);
+    return QRect(x + (step % 10) * 5, y + (step % 10) * 5, 300 + (step % 10) * 10, 200 + (step % 10) * 10);
+}
+
+xcb_atom_t Benchmark::atom(const char *name) const
+{
+    xcb_intern_atom_reply_t *reply = xcb_intern_atom_reply(m_connection,
+        xcb_intern_atom(m_connection, false, strlen(name), name), nullptr);
+    if (!reply) {
+        return XCB_ATOM_NONE;
+    }
+    const xcb_atom_t atom = reply->atom;
+    free(reply);
+    return atom;
+}
+
+void Benchmark::sendRootMessage(xcb_atom_t type, uint32_t data)
+{
+    sendMessage(m_screen->root, type, data, 0);
+}
+
+void Benchmark::sendMessage(xcb_window_t window, xcb_atom_t type, uint32_t data0, uint32_t data1)
+{
+    xcb_client_message_event_t event;
+    memset(&event, 0, sizeof(event));
+    event.response_type = XCB_CLIENT_MESSAGE;
+    event.format = 32;
+    event.window = window;
+    event.type = type;
+    event.data.data32[0] = data0;
+    event.data.data32[1] = data1;
+    xcb_send_event(m_connection, false, m_screen->root,
+                   XCB_EVENT_MASK_SUBSTRUCTURE_REDIRECT | XCB_EVENT_MASK_SUBSTRUCTURE_NOTIFY,
+                   reinterpret_cast<const char*>(&event));
+}
+
+xcb_window_t Benchmark::eventWindow(xcb_generic_event_t *event) const
+{
+    switch (event->response_type & ~0x80) {
+    case XCB_MAP_NOTIFY:
+        return reinterpret_cast<xcb_map_notify_event_t*>(event)->window;
+    case XCB_CONFIGURE_NOTIFY:
+        return reinterpret_cast<xcb_configure_notify_event_t*>(event)->window;
+    case XCB_PROPERTY_NOTIFY:
+        return reinterpret_cast<xcb_property_notify_event_t*>(event)->window;
+    default:
+        return XCB_WINDOW_NONE;
+    }
+}
+
+bool Benchmark::isOurWindow(xcb_window_t window) const
+{
+    return m_windows.contains(window);
+}
+
+template <typename Filter>
+qint64 Benchmark::waitForQuiescence(const QElapsedTimer &timer, Filter filter, int quietTime)
+{
+    qint64 lastEvent = timer.elapsed();
+    pollfd fd;
+    fd.fd = xcb_get_file_descriptor(m_connection);
+    fd.events = POLLIN;
+    while (timer.elapsed() - lastEvent < quietTime) {
+        while (xcb_generic_event_t *event = xcb_poll_for_event(m_connection)) {
+            if (filter(event)) {
+                lastEvent = timer.elapsed();
+            }
+            free(event);
+        }
+        if (xcb_connection_has_error(m_connection)) {
+            break;
+        }
+        poll(&fd, 1, quietTime);
+    }
+    return lastEvent;
+}
+
+void Benchmark::map()
+{
+    resetStatistics();
+    QElapsedTimer timer;
+    timer.start();
+    const uint32_t values[] = {
+        m_screen->white_pixel,
+        XCB_EVENT_MASK_STRUCTURE_NOTIFY | XCB_EVENT_MASK_EXPOSURE
+    };
+    for (int i = 0; i < m_windows.size(); ++i) {
+        const QRect geo = windowGeometry(i, 0);
+        xcb_create_window(m_connection, XCB_COPY_FROM_PARENT, m_windows[i], m_screen->root,
+                          geo.x(), geo.y(), geo.width(), geo.height(), 0, XCB_WINDOW_CLASS_INPUT_OUTPUT,
+                          m_screen->root_visual, XCB_CW_BACK_PIXEL | XCB_CW_EVENT_MASK, values);
+        xcb_map_window(m_connection, m_windows[i]);
+    }
+    xcb_flush(m_connection);
+    // the window manager maps the windows once it managed them
+    int mapped = 0;
+    const qint64 elapsed = waitForQuiescence(timer, [this, &mapped](xcb_generic_event_t *event) {
+        if ((event->response_type & ~0x80) == XCB_MAP_NOTIFY && isOurWindow(eventWindow(event))) {
+            ++mapped;
+            return true;
+        }
+        return false;
+    });
+    if (mapped != m_windows.size()) {
+        std::cerr << "Only " << mapped << " of " << m_windows.size() << " windows got mapped" << std::endl;
+    }
+    printPhase("map", elapsed);
+}
+
+void Benchmark::move()
+{
+    resetStatistics();
+    QElapsedTimer timer;
+    timer.start();
+    for (int step = 1; step <= m_steps; ++step) {
+        for (int i = 0; i < m_windows.size(); ++i) {
+            const QRect geo = windowGeometry(i, step);
+            const uint32_t values[] = { uint32_t(geo.x()), uint32_t(geo.y()) };
+            xcb_configure_window(m_connection, m_windows[i], XCB_CONFIG_WINDOW_X | XCB_CONFIG_WINDOW_Y, values);
+        }
+        xcb_flush(m_connection);
+    }
+    const qint64 elapsed = waitForQuiescence(timer, [this](xcb_generic_event_t *event) {
+        return (event->response_type & ~0x80) == XCB_CONFIGURE_NOTIFY && isOurWindow(eventWindow(event));
+    });
+    printPhase("move", elapsed);
+}
+
+void Benchmark::resize()
+{
+    resetStatistics();
+    QElapsedTimer timer;
+    timer.start();
+    for (int step = 1; step <= m_steps; ++step) {
+        for (int i = 0; i < m_windows.size(); ++i) {
+            const QRect geo = windowGeometry(i, step);
+            const uint32_t values[] = { uint32_t(geo.width()), uint32_t(geo.height()) };
+            xcb_configure_window(m_connection, m_windows[i], XCB_CONFIG_WINDOW_WIDTH | XCB_CONFIG_WINDOW_HEIGHT, values);
+        }
+        xcb_flush(m_connection);
+    }
+    const qint64 elapsed = waitForQuiescence(timer, [this](xcb_generic_event_t *event) {
+        return (event->response_type & ~0x80) == XCB_CONFIGURE_NOTIFY && isOurWindow(eventWindow(event));
+    });
+    printPhase("resize", elapsed);
+}
+
+void Benchmark::damage()
+{
+    resetStatistics();
+    QElapsedTimer timer;
+    timer.start();
+    // one frame of damage on all windows every 16 msec
+    for (int step = 0; step < m_steps; ++step) {
+        const uint32_t color = (step % 2) ? m_screen->black_pixel : m_screen->white_pixel;
+        xcb_change_gc(m_connection, m_gc, XCB_GC_FOREGROUND, &color);
+        for (int i = 0; i < m_windows.size(); ++i) {
+            const xcb_rectangle_t rect = { 0, 0, 100, 100 };
+            xcb_poly_fill_rectangle(m_connection, m_windows[i], m_gc, 1, &rect);
+        }
+        xcb_flush(m_connection);
+        QThread::msleep(16);
+    }
+    xcb_discard_reply(m_connection, xcb_get_input_focus(m_connection).sequence);
+    // give the compositor the time to render the last frame
+    QThread::msleep(100);
+    printFramePhase("damage", timer.elapsed());
+}
+
+void Benchmark::switchDesktop()
+{
+    // all windows are on the first desktop, switching hides and shows all of them
+    sendRootMessage(atom("_NET_NUMBER_OF_DESKTOPS"), 2);
+    xcb_flush(m_connection);
+    QElapsedTimer timer;
+    timer.start();
+    waitForQuiescence(timer, [](xcb_generic_event_t*) { return false; }, 100);
+    resetStatistics();
+    timer.restart();
+    for (int step = 1; step <= m_steps; ++step) {
+        sendRootMessage(m_currentDesktop, step % 2);
+        xcb_flush(m_connection);
+    }
+    const qint64 elapsed = waitForQuiescence(timer, [this](xcb_generic_event_t *event) {
+        return (event->response_type & ~0x80) == XCB_PROPERTY_NOTIFY && eventWindow(event) == m_screen->root &&
+               reinterpret_cast<xcb_property_notify_event_t*>(event)->atom == m_currentDesktop;
+    });
+    printPhase("desktop switch", elapsed);
+}
+
+void Benchmark::focus()
+{
+    // spread the windows over the desktops, activating a window on another desktop switches to it
+    sendRootMessage(atom("_NET_NUMBER_OF_DESKTOPS"), m_desktops);
+    const xcb_atom_t wmDesktop = atom("_NET_WM_DESKTOP");
+    for (int i = 0; i < m_windows.size(); ++i) {
+        // source indication 2: pager
+        sendMessage(m_windows[i], wmDesktop, i % m_desktops, 2);
+    }
+    xcb_flush(m_connection);
+    QElapsedTimer timer;
+    timer.start();
+    waitForQuiescence(timer, [](xcb_generic_event_t*) { return false; }, 100);
+    resetStatistics();
+    timer.restart();
+    // activate the windows in an order which differs from the stacking and focus order,
+    // the pager source indication bypasses focus stealing prevention
+    const xcb_atom_t activeWindow = atom("_NET_ACTIVE_WINDOW");
+    for (int step = 0; step < m_steps; ++step) {
+        for (int i = 0; i < m_windows.size(); ++i) {
+            sendMessage(m_windows[(i * 7 + step) % m_windows.size()], activeWindow, 2, XCB_CURRENT_TIME);
+        }
+        xcb_flush(m_connection);
+    }
+    const qint64 elapsed = waitForQuiescence(timer, [this, activeWindow](xcb_generic_event_t *event) {
+        return (event->response_type & ~0x80) == XCB_PROPERTY_NOTIFY && eventWindow(event) == m_screen->root &&
+               reinterpret_cast<xcb_property_notify_event_t*>(event)->atom == activeWindow;
+    });
+    printPhase("focus", elapsed);
+}
+
+void Benchmark::close()
+{
+    resetStatistics();
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < m_windows.size(); ++i) {
+        xcb_destroy_window(m_connection, m_windows[i]);
+    }
+    xcb_flush(m_connection);
+    // the window manager updates _NET_CLIENT_LIST once it released the windows
+    const qint64 elapsed = waitForQuiescence(timer, [this](xcb_generic_event_t *event) {
+        return (event->response_type & ~0x80) == XCB_PROPERTY_NOTIFY && eventWindow(event) == m_screen->root;
+    });
+    printPhase("close", elapsed);
+}
+
+static bool waitForKWin(xcb_connection_t *c, int screenNumber, bool compositing)
+{
+    QDBusConnectionInterface *bus = QDBusConnection::sessionBus().interface();
+    if (!bus) {
+        std::cerr << "No D-Bus session bus" << std::endl;
+        return false;
+    }
+    const QByteArray selection = QByteArrayLiteral("_NET_WM_CM_S") + QByteArray::number(screenNumber);
+    xcb_intern_atom_reply_t *atom = xcb_intern_atom_reply(c, xcb_intern_atom(c, false, selection.length(), selection.constData()), nullptr);
+    if (!atom) {
+        return false;
+    }
+    bool ready = false;
+    for (int i = 0; i < 300 && !ready; ++i) {
+        ready = bus->isServiceRegistered(QString::fromUtf8(s_kwinService));
+        if (ready && compositing) {
+            xcb_get_selection_owner_reply_t *owner = xcb_get_selection_owner_reply(c, xcb_get_selection_owner(c, atom->atom), nullptr);
+            ready = owner && owner->owner != XCB_WINDOW_NONE;
+            free(owner);
+        }
+        if (!ready) {
+            QThread::msleep(100);
+        }
+    }
+    free(atom);
+    return ready;
+}
+
+int main(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName(QStringLiteral("kwinbenchmark"));
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption windowsOption(QStringLiteral("windows"), QStringLiteral("Number of windows."),
+                                     QStringLiteral("count"), QStringLiteral("50"));
+    QCommandLineOption stepsOption(QStringLiteral("steps"), QStringLiteral("Number of moves, resizes and damage frames per window, of desktop switches and of activations per window."),
+                                   QStringLiteral("count"), QStringLiteral("100"));
+    QCommandLineOption desktopsOption(QStringLiteral("desktops"), QStringLiteral("Number of virtual desktops the windows are spread over for the focus phase."),
+                                      QStringLiteral("count"), QStringLiteral("8"));
+    QCommandLineOption compositingOption(QStringLiteral("compositing"), QStringLiteral("Wait till KWin started compositing."));
+    parser.addOption(windowsOption);
+    parser.addOption(stepsOption);
+    parser.addOption(desktopsOption);
+    parser.addOption(compositingOption);
+    parser.process(app);
+
+    int screenNumber;
+    xcb_connection_t *c = xcb_connect(nullptr, &screenNumber);
+    if (xcb_connection_has_error(c)) {
+        std::cerr << "Could not connect to the X server" << std::endl;
+        return 1;
+    }
+    auto getScreen = [=]() {
+        const xcb_setup_t *setup = xcb_get_setup(c);
+        auto it = xcb_setup_roots_iterator (setup);
+        for (int i = 0; i < screenNumber; ++i) {
+            xcb_screen_next(&it);
+        }
+        return it.data;
+    };
+
+    if (!waitForKWin(c, screenNumber, parser.isSet(compositingOption))) {
+        std::cerr << "KWin is not running" << std::endl;
+        xcb_disconnect(c);
+        return 1;
+    }
+
+    {
+        Benchmark benchmark(c, getScreen(), qMax(1, parser.value(windowsOption).toInt()),
+                            qMax(1, parser.value(stepsOption).toInt()),
+                            qMax(1, parser.value(desktopsOption).toInt()));
+        benchmark.map();
+        benchmark.move();
+        benchmark.resize();
+        benchmark.damage();
+        benchmark.switchDesktop();
+        benchmark.focus();
+        benchmark.close();
+    }
+
+    xcb_disconnect(c);
+    return 0;
+}
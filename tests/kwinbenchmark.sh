@@ -0,0 +1,30 @@
+#!/bin/sh
+#
+# Runs kwinbenchmark against KWin on a virtual X server for all compositing modes
+# usable on X11: no compositing, XRender and OpenGL (with Mesa's llvmpipe).
+#
+# Usage: kwinbenchmark.sh [path to kwin_x11] [path to kwinbenchmark] [kwinbenchmark arguments]
+#
+# Requires Xvfb and dbus-run-session.
+
+KWIN=${1:-kwin_x11}
+BENCHMARK=${2:-$(dirname "$0")/kwinbenchmark}
+if [ $# -ge 2 ]; then shift 2; else shift $#; fi
+
+DISPLAY_NUMBER=${KWIN_BENCHMARK_DISPLAY:-:99}
+
+Xvfb $DISPLAY_NUMBER -screen 0 1920x1080x24 +extension GLX +extension COMPOSITE +extension DAMAGE +extension RENDER -nolisten tcp &
+XVFB_PID=$!
+trap 'kill $XVFB_PID' EXIT
+sleep 1
+
+for MODE in N X O; do
+    case $MODE in
+        N) NAME="no compositing"; COMPOSITING="";;
+        X) NAME="XRender"; COMPOSITING="--compositing";;
+        O) NAME="OpenGL"; COMPOSITING="--compositing";;
+    esac
+    echo "###### $NAME ######"
+    DISPLAY=$DISPLAY_NUMBER KWIN_COMPOSE=$MODE LIBGL_ALWAYS_SOFTWARE=1 dbus-run-session -- sh -c \
+        "$KWIN --replace > /dev/null 2>&1 & KWIN_PID=\$!; $BENCHMARK $COMPOSITING $*; RESULT=\$?; kill \$KWIN_PID; wait \$KWIN_PID; exit \$RESULT" || exit 1
+done
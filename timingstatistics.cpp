@@ -0,0 +1,107 @@
+/********************************************************************
+ KWin - the KDE window manager
+ This file is part of the KDE project.
+
+Copyright (C) 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#include "timingstatistics.h"
+
+namespace KWin
+{
+
+namespace
+{
+struct Samples {
+    quint64 count;
+    qint64 total;
+    qint64 maximum;
+};
+Samples s_samples[TimingStatistics::PhaseCount];
+}
+
+void TimingStatistics::addSample(Phase phase, qint64 nanoseconds)
+{
+    Samples &samples = s_samples[phase];
+    ++samples.count;
+    samples.total += nanoseconds;
+    samples.maximum = qMax(samples.maximum, nanoseconds);
+}
+
+quint64 TimingStatistics::count(Phase phase)
+{
+    return s_samples[phase].count;
+}
+
+qint64 TimingStatistics::total(Phase phase)
+{
+    return s_samples[phase].total;
+}
+
+qint64 TimingStatistics::maximum(Phase phase)
+{
+    return s_samples[phase].maximum;
+}
+
+void TimingStatistics::reset()
+{
+    for (int i = 0; i < PhaseCount; ++i) {
+        s_samples[i].count = 0;
+        s_samples[i].total = 0;
+        s_samples[i].maximum = 0;
+    }
+}
+
+QString TimingStatistics::phaseToString(Phase phase)
+{
+    switch (phase) {
+    case Compositing:
+        return QStringLiteral("Compositing");
+    case ScenePaint:
+        return QStringLiteral("Scene paint");
+    case Present:
+        return QStringLiteral("Present");
+    case EffectsPrePaint:
+        return QStringLiteral("Effects pre paint");
+    case EffectsPaint:
+        return QStringLiteral("Effects paint");
+    case EffectsPostPaint:
+        return QStringLiteral("Effects post paint");
+    case Manage:
+        return QStringLiteral("Manage");
+    case UnredirectCheck:
+        return QStringLiteral("Unredirect check");
+    default:
+        return QStringLiteral("unknown");
+    }
+}
+
+QString TimingStatistics::supportInformation()
+{
+    QString support;
+    for (int i = 0; i < PhaseCount; ++i) {
+        const Samples &samples = s_samples[i];
+        support.append(QStringLiteral("%1: %2 samples").arg(phaseToString(Phase(i))).arg(samples.count));
+        if (samples.count) {
+            support.append(QStringLiteral(", average %1 ms, maximum %2 ms")
+                .arg(samples.total / samples.count / 1000000.0, 0, 'f', 3)
+                .arg(samples.maximum / 1000000.0, 0, 'f', 3));
+        }
+        support.append(QStringLiteral("\n"));
+    }
+    return support;
+}
+
+} // namespace
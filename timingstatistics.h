@@ -0,0 +1,92 @@
+/********************************************************************
+ KWin - the KDE window manager
+ This file is part of the KDE project.
+
+Copyright (C) 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+
+#ifndef KWIN_TIMINGSTATISTICS_H
+#define KWIN_TIMINGSTATISTICS_H
+
+#include <QElapsedTimer>
+#include <QString>
+
+namespace KWin
+{
+
+/**
+ * @short Collects how long the hot phases of the window manager and the compositor take.
+ *
+ * Each phase records the number of samples, the total and the maximum duration. The values
+ * are part of the support information and can be reset through D-Bus, which allows to
+ * measure a specific workload like the one generated by tests/kwinbenchmark.
+ *
+ * Only to be used from the main thread.
+ **/
+class TimingStatistics
+{
+public:
+    enum Phase {
+        Compositing, ///< One pass of Compositor::performCompositing which paints a frame
+        ScenePaint, ///< Scene::paint including the effect chain, but without Present
+        Present, ///< Presenting a frame in the OpenGL backends, might block for the retrace
+        EffectsPrePaint, ///< The prePaintScreen pass of the effect chain
+        EffectsPaint, ///< The paintScreen pass of the effect chain including all window passes
+        EffectsPostPaint, ///< The postPaintWindow and postPaintScreen passes of the effect chain
+        Manage, ///< Client::manage
+        UnredirectCheck, ///< Compositor::delayedCheckUnredirect
+        PhaseCount
+    };
+
+    /**
+     * Measures the lifetime of the object and records it as a sample of the phase.
+     **/
+    class Measurement
+    {
+    public:
+        explicit Measurement(Phase phase);
+        ~Measurement();
+    private:
+        Phase m_phase;
+        QElapsedTimer m_timer;
+    };
+
+    static void addSample(Phase phase, qint64 nanoseconds);
+    static quint64 count(Phase phase);
+    static qint64 total(Phase phase);
+    static qint64 maximum(Phase phase);
+    static void reset();
+
+    static QString phaseToString(Phase phase);
+    static QString supportInformation();
+};
+
+inline
+TimingStatistics::Measurement::Measurement(Phase phase)
+    : m_phase(phase)
+{
+    m_timer.start();
+}
+
+inline
+TimingStatistics::Measurement::~Measurement()
+{
+    TimingStatistics::addSample(m_phase, m_timer.nsecsElapsed());
+}
+
+} // namespace
+
+#endif
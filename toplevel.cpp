@@ -26,6 +26,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "atoms.h"
 #include "client.h"
 #include "client_machine.h"
+#include "composite.h"
 #include "effects.h"
 #include "screens.h"
 #include "shadow.h"
@@ -62,6 +63,9 @@ Toplevel::Toplevel()
 Toplevel::~Toplevel()
 {
     assert(damage_handle == None);
+    if (Compositor::isCreated()) {
+        Compositor::self()->removeFromUnredirectCheck(this);
+    }
     delete info;
 }
 
@@ -103,6 +107,15 @@ void Toplevel::detectShape(Window id)
     }
 }
 
+void Toplevel::readShape(xcb_shape_query_extents_reply_t *extents)
+{
+    const bool wasShape = is_shape;
+    is_shape = extents && extents->bounding_shaped > 0;
+    if (wasShape != is_shape) {
+        emit shapedChanged();
+    }
+}
+
 // used only by Deleted::copy()
 void Toplevel::copyToDeleted(Toplevel* c)
 {
@@ -145,10 +158,20 @@ QRect Toplevel::visibleRect() const
     return r.translated(geometry().topLeft());
 }
 
+Xcb::Property Toplevel::fetchWmClientLeader() const
+{
+    return Xcb::Property(false, window(), atoms->wm_client_leader, XCB_ATOM_WINDOW, 0, 10000);
+}
+
+void Toplevel::readWmClientLeader(Xcb::Property &property)
+{
+    wmClientLeaderWin = property.value<xcb_window_t>(window());
+}
+
 void Toplevel::getWmClientLeader()
 {
-    Xcb::Property prop(false, window(), atoms->wm_client_leader, XCB_ATOM_WINDOW, 0, 10000);
-    wmClientLeaderWin = prop.value<xcb_window_t>(window());
+    Xcb::Property property = fetchWmClientLeader();
+    readWmClientLeader(property);
 }
 
 /*!
@@ -347,44 +370,37 @@ const Shadow *Toplevel::shadow() const
     }
 }
 
-void Toplevel::getWmOpaqueRegion()
+Xcb::Property Toplevel::fetchWmOpaqueRegion() const
 {
-    const int length=32768;
-    unsigned long bytes_after_return=0;
-    QRegion new_opaque_region;
-    do {
-        unsigned long* data;
-        Atom type;
-        int rformat;
-        unsigned long nitems;
-        if (XGetWindowProperty(display(), m_client,
-                               atoms->net_wm_opaque_region, 0, length, false, XCB_ATOM_CARDINAL,
-                               &type, &rformat, &nitems, &bytes_after_return,
-                               reinterpret_cast< unsigned char** >(&data)) == Success) {
-            if (type != XCB_ATOM_CARDINAL || rformat != 32 || nitems%4) {
-                // it can happen, that the window does not provide this property
-                XFree(data);
-                break;
-            }
-
-            for (unsigned int i = 0; i < nitems;) {
-                const int x = data[i++];
-                const int y = data[i++];
-                const int w = data[i++];
-                const int h = data[i++];
+    return Xcb::Property(false, window(), atoms->net_wm_opaque_region, XCB_ATOM_CARDINAL, 0, 0x1fffffff);
+}
 
-                new_opaque_region += QRect(x,y,w,h);
-            }
-            XFree(data);
-        } else {
-            qWarning() << "XGetWindowProperty failed";
-            break;
+void Toplevel::readWmOpaqueRegion(Xcb::Property &property)
+{
+    QRegion new_opaque_region;
+    bool ok = false;
+    const uint32_t *data = property.value<const uint32_t*>(nullptr, &ok);
+    // it can happen, that the window does not provide this property
+    if (ok && data && property->value_len % 4 == 0) {
+        for (uint32_t i = 0; i < property->value_len;) {
+            const int x = data[i++];
+            const int y = data[i++];
+            const int w = data[i++];
+            const int h = data[i++];
+
+            new_opaque_region += QRect(x,y,w,h);
         }
-    } while (bytes_after_return > 0);
+    }
 
     opaque_region = new_opaque_region;
 }
 
+void Toplevel::getWmOpaqueRegion()
+{
+    Xcb::Property property = fetchWmOpaqueRegion();
+    readWmOpaqueRegion(property);
+}
+
 bool Toplevel::isClient() const
 {
     return false;
@@ -423,12 +439,22 @@ xcb_window_t Toplevel::frameId() const
     return m_client;
 }
 
-void Toplevel::getSkipCloseAnimation()
+Xcb::Property Toplevel::fetchSkipCloseAnimation() const
+{
+    return Xcb::Property(false, window(), atoms->kde_skip_close_animation, XCB_ATOM_CARDINAL, 0, 1);
+}
+
+void Toplevel::readSkipCloseAnimation(Xcb::Property &property)
 {
-    Xcb::Property property(false, window(), atoms->kde_skip_close_animation, XCB_ATOM_CARDINAL, 0, 1);
     setSkipCloseAnimation(property.toBool());
 }
 
+void Toplevel::getSkipCloseAnimation()
+{
+    Xcb::Property property = fetchSkipCloseAnimation();
+    readSkipCloseAnimation(property);
+}
+
 bool Toplevel::skipsCloseAnimation() const
 {
     return m_skipCloseAnimation;
@@ -34,6 +34,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QObject>
 // xcb
 #include <xcb/damage.h>
+#include <xcb/shape.h>
 #include <xcb/xfixes.h>
 // XLib
 #include <X11/Xlib.h>
@@ -257,7 +258,17 @@ public:
     bool hasAlpha() const;
     virtual bool setupCompositing();
     virtual void finishCompositing(ReleaseReason releaseReason = ReleaseReason::Release);
-    bool updateUnredirectedState();
+    /**
+     * @returns Whether the window fulfills all conditions to be unredirected.
+     **/
+    bool canUnredirect() const;
+    /**
+     * @returns Whether the window could be unredirected if it were not covered by other
+     * windows, e.g. an active fullscreen window. Only for such windows changes of the
+     * stacking order matter.
+     **/
+    virtual bool isUnredirectCandidate() const = 0;
+    void setUnredirected(bool set);
     bool unredirected() const;
     void suspendUnredirect(bool suspend);
     Q_INVOKABLE void addRepaint(const QRect& r);
@@ -403,11 +414,19 @@ protected:
     virtual ~Toplevel();
     void setWindowHandles(xcb_window_t client);
     void detectShape(Window id);
+    /**
+     * Updates the shape state from the reply of a SHAPE QueryExtents request for the window.
+     * Allows to send the request together with other requests instead of the round trip
+     * done by detectShape.
+     **/
+    void readShape(xcb_shape_query_extents_reply_t *extents);
     virtual void propertyNotifyEvent(xcb_property_notify_event_t *e);
     virtual void damageNotifyEvent();
     void discardWindowPixmap();
     void addDamageFull();
     void getWmClientLeader();
+    Xcb::Property fetchWmClientLeader() const;
+    void readWmClientLeader(Xcb::Property &property);
     void getWmClientMachine();
     /**
      * @returns Whether there is a compositor and it is active.
@@ -419,15 +438,19 @@ protected:
      * Will only be called on corresponding property changes and for initialization.
      **/
     void getWmOpaqueRegion();
+    Xcb::Property fetchWmOpaqueRegion() const;
+    void readWmOpaqueRegion(Xcb::Property &property);
 
     void getResourceClass();
     void getSkipCloseAnimation();
+    Xcb::Property fetchSkipCloseAnimation() const;
+    void readSkipCloseAnimation(Xcb::Property &property);
     virtual void debug(QDebug& stream) const = 0;
     void copyToDeleted(Toplevel* c);
     void disownDataPassedToDeleted();
     friend QDebug& operator<<(QDebug& stream, const Toplevel*);
     void deleteEffectWindow();
-    virtual bool shouldUnredirect() const = 0;
+    bool isCovered() const;
     QRect geom;
     xcb_visualid_t m_visual;
     int bit_depth;
@@ -40,6 +40,8 @@ Unmanaged::Unmanaged()
 {
     ready_for_painting = false;
     connect(this, SIGNAL(geometryShapeChanged(KWin::Toplevel*,QRect)), SIGNAL(geometryChanged()));
+    // The window is normally shown with its first damage. This is only the fallback for a
+    // window which got painted before damage tracking was set up and does not paint again.
     QTimer::singleShot(50, this, SLOT(setReadyForPainting()));
 }
 
@@ -49,20 +51,40 @@ Unmanaged::~Unmanaged()
 
 bool Unmanaged::track(Window w)
 {
-    GRAB_SERVER_DURING_CONTEXT
+    // No server grab: the event mask is selected before the remaining state is read, so any
+    // later change (including unmapping) reaches us as an event. All requests of a step are
+    // sent before waiting for the first reply.
     Xcb::WindowAttributes attr(w);
-    Xcb::WindowGeometry geo(w);
     if (attr.isNull() || attr->map_state != XCB_MAP_STATE_VIEWABLE) {
         return false;
     }
     if (attr->_class == XCB_WINDOW_CLASS_INPUT_ONLY) {
         return false;
     }
-    if (geo.isNull()) {
-        return false;
-    }
     setWindowHandles(w);   // the window is also the frame
     Xcb::selectInput(w, attr->your_event_mask | XCB_EVENT_MASK_STRUCTURE_NOTIFY | XCB_EVENT_MASK_PROPERTY_CHANGE);
+    const bool shape = Xcb::Extensions::self()->isShapeAvailable();
+    if (shape) {
+        xcb_shape_select_input(connection(), w, true);
+    }
+    // the window might have been unmapped, moved or resized before the event mask got selected,
+    // so the map state and the geometry are read after selecting it
+    Xcb::WindowAttributes mapState(w);
+    Xcb::WindowGeometry geo(w);
+    xcb_shape_query_extents_cookie_t shapeCookie = { 0 };
+    if (shape) {
+        shapeCookie = xcb_shape_query_extents_unchecked(connection(), w);
+    }
+    Xcb::Property clientLeader = fetchWmClientLeader();
+    Xcb::Property opaqueRegion = fetchWmOpaqueRegion();
+    Xcb::Property skipCloseAnimation = fetchSkipCloseAnimation();
+    if (mapState.isNull() || mapState->map_state != XCB_MAP_STATE_VIEWABLE || geo.isNull()) {
+        if (shape) {
+            xcb_discard_reply(connection(), shapeCookie.sequence);
+        }
+        return false;
+    }
+
     geom = geo.rect();
     checkScreen();
     m_visual = attr->visual;
@@ -72,20 +94,29 @@ bool Unmanaged::track(Window w)
                           NET::WM2Opacity |
                           NET::WM2WindowRole |
                           NET::WM2WindowClass);
+    if (shape) {
+        ScopedCPointer<xcb_shape_query_extents_reply_t> extents(xcb_shape_query_extents_reply(connection(), shapeCookie, nullptr));
+        readShape(extents.data());
+    }
     getResourceClass();
-    getWmClientLeader();
+    readWmClientLeader(clientLeader);
     getWmClientMachine();
-    if (Xcb::Extensions::self()->isShapeAvailable())
-        xcb_shape_select_input(connection(), w, true);
-    detectShape(w);
-    getWmOpaqueRegion();
-    getSkipCloseAnimation();
+    readWmOpaqueRegion(opaqueRegion);
+    readSkipCloseAnimation(skipCloseAnimation);
     setupCompositing();
     if (effects)
         static_cast<EffectsHandlerImpl*>(effects)->checkInputWindowStacking();
     return true;
 }
 
+void Unmanaged::damageNotifyEvent()
+{
+    if (!ready_for_painting) { // avoid "setReadyForPainting()" function calling overhead
+        setReadyForPainting();
+    }
+    Toplevel::damageNotifyEvent();
+}
+
 void Unmanaged::release(ReleaseReason releaseReason)
 {
     Deleted* del = NULL;
@@ -54,7 +54,8 @@ public Q_SLOTS:
     void release(ReleaseReason releaseReason = ReleaseReason::Release);
 protected:
     virtual void debug(QDebug& stream) const;
-    virtual bool shouldUnredirect() const;
+    virtual void damageNotifyEvent();
+    virtual bool isUnredirectCandidate() const;
 private:
     virtual ~Unmanaged(); // use release()
     // handlers for X11 events
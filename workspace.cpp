@@ -45,12 +45,14 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "killwindow.h"
 #include "netinfo.h"
 #include "outline.h"
+#include "partialupdateengine.h"
 #include "placement.h"
 #include "rules.h"
 #ifdef KWIN_BUILD_SCREENEDGES
 #include "screenedge.h"
 #endif
 #include "screens.h"
+#include "timingstatistics.h"
 #include "scripting/scripting.h"
 #ifdef KWIN_BUILD_TABBOX
 #include "tabbox.h"
@@ -121,6 +123,8 @@ Workspace::Workspace(bool restore)
     , x_stacking_dirty(true)
     , showing_desktop(false)
     , block_showing_desktop(0)
+    , block_visibility_updates(0)
+    , pending_mapping_changes(false)
     , was_user_interaction(false)
     , session_saving(false)
     , block_focus(0)
@@ -431,6 +435,7 @@ Workspace::~Workspace()
         clients.removeAll(c);
         desktops.removeAll(c);
     }
+    m_snapEdges.clear();
     for (UnmanagedList::iterator it = unmanaged.begin(), end = unmanaged.end(); it != end; ++it)
         (*it)->release(ReleaseReason::KWinShutsDown);
     xcb_delete_property(connection(), rootWindow(), atoms->kwin_running);
@@ -456,10 +461,11 @@ Client* Workspace::createClient(xcb_window_t w, bool is_mapped)
     StackingUpdatesBlocker blocker(this);
     Client* c = new Client();
     connect(c, SIGNAL(needsRepaint()), m_compositor, SLOT(scheduleRepaint()));
-    connect(c, SIGNAL(activeChanged()), m_compositor, SLOT(checkUnredirect()));
-    connect(c, SIGNAL(fullScreenChanged()), m_compositor, SLOT(checkUnredirect()));
-    connect(c, SIGNAL(geometryChanged()), m_compositor, SLOT(checkUnredirect()));
-    connect(c, SIGNAL(geometryShapeChanged(KWin::Toplevel*,QRect)), m_compositor, SLOT(checkUnredirect()));
+    connect(c, SIGNAL(activeChanged()), m_compositor, SLOT(checkSenderUnredirect()));
+    connect(c, SIGNAL(fullScreenChanged()), m_compositor, SLOT(checkSenderUnredirect()));
+    connect(c, SIGNAL(geometryChanged()), m_compositor, SLOT(checkSenderUnredirect()));
+    connect(c, SIGNAL(geometryShapeChanged(KWin::Toplevel*,QRect)), m_compositor, SLOT(checkSenderUnredirect()));
+    connect(c, SIGNAL(opacityChanged(KWin::Toplevel*,qreal)), m_compositor, SLOT(checkSenderUnredirect()));
     connect(c, SIGNAL(blockingCompositingChanged(KWin::Client*)), m_compositor, SLOT(updateCompositeBlocking(KWin::Client*)));
 #ifdef KWIN_BUILD_SCREENEDGES
     connect(c, SIGNAL(clientFullScreenSet(KWin::Client*,bool,bool)), ScreenEdges::self(), SIGNAL(checkBlocking()));
@@ -506,6 +512,10 @@ void Workspace::addClient(Client* c)
     } else {
         FocusChain::self()->update(c, FocusChain::Update);
         clients.append(c);
+        m_snapEdges.insert(c, c->geometry());
+        connect(c, &Toplevel::geometryChanged, this, [this, c] {
+            m_snapEdges.update(c, c->geometry());
+        });
     }
     if (!unconstrained_stacking_order.contains(c))
         unconstrained_stacking_order.append(c);   // Raise if it hasn't got any stacking position yet
@@ -538,6 +548,8 @@ void Workspace::addClient(Client* c)
 
 void Workspace::addUnmanaged(Unmanaged* c)
 {
+    connect(c, SIGNAL(geometryShapeChanged(KWin::Toplevel*,QRect)), m_compositor, SLOT(checkSenderUnredirect()));
+    connect(c, SIGNAL(opacityChanged(KWin::Toplevel*,qreal)), m_compositor, SLOT(checkSenderUnredirect()));
     unmanaged.append(c);
     x_stacking_dirty = true;
 }
@@ -574,6 +586,8 @@ void Workspace::removeClient(Client* c)
     // TODO: if marked client is removed, notify the marked list
     clients.removeAll(c);
     desktops.removeAll(c);
+    pending_hidden_clients.removeAll(c);
+    m_snapEdges.remove(c);
     x_stacking_dirty = true;
     attention_chain.removeAll(c);
     showing_desktop_clients.removeAll(c);
@@ -894,20 +908,30 @@ void Workspace::slotCurrentDesktopChanged(uint oldDesktop, uint newDesktop)
 void Workspace::updateClientVisibilityOnDesktopChange(uint oldDesktop, uint newDesktop)
 {
     ++block_showing_desktop;
-    ObscuringWindows obs_wins;
+    VisibilityUpdatesBlocker visibilityBlocker(this);
+    // Decide once which clients change, unmapping is done from bottom to top and
+    // mapping from top to bottom => less exposure events
+    ClientList toHide;
+    ClientList toShow;
     for (ToplevelList::ConstIterator it = stacking_order.constBegin();
             it != stacking_order.constEnd();
             ++it) {
         Client *c = qobject_cast<Client*>(*it);
-        if (!c) {
+        if (!c || !c->isOnCurrentActivity()) {
             continue;
         }
-        if (!c->isOnDesktop(newDesktop) && c != movingClient && c->isOnCurrentActivity()) {
-            if (c->isShown(true) && c->isOnDesktop(oldDesktop) && !compositing())
-                obs_wins.create(c);
-            (c)->updateVisibility();
+        if (c->isOnDesktop(newDesktop) || c == movingClient) {
+            toShow.prepend(c);
+        } else {
+            toHide.append(c);
         }
     }
+    ObscuringWindows obs_wins;
+    foreach (Client *c, toHide) {
+        if (c->isShown(true) && c->isOnDesktop(oldDesktop) && !compositing())
+            obs_wins.create(c);
+        c->updateVisibility();
+    }
     // Now propagate the change, after hiding, before showing
     rootInfo()->setCurrentDesktop(VirtualDesktopManager::self()->current());
 
@@ -915,13 +939,8 @@ void Workspace::updateClientVisibilityOnDesktopChange(uint oldDesktop, uint newD
         movingClient->setDesktop(newDesktop);
     }
 
-    for (int i = stacking_order.size() - 1; i >= 0 ; --i) {
-        Client *c = qobject_cast<Client*>(stacking_order.at(i));
-        if (!c) {
-            continue;
-        }
-        if (c->isOnDesktop(newDesktop) && c->isOnCurrentActivity())
-            c->updateVisibility();
+    foreach (Client *c, toShow) {
+        c->updateVisibility();
     }
     --block_showing_desktop;
     if (showingDesktop())   // Do this only after desktop change to avoid flicker
@@ -1001,6 +1020,7 @@ void Workspace::updateCurrentActivity(const QString &new_activity)
     StackingUpdatesBlocker blocker(this);
 
     ++block_showing_desktop; //FIXME should I be using that?
+    blockVisibilityUpdates(true);
     // Optimized Desktop switching: unmapping done from back to front
     // mapping done from front to back => less exposure events
     //Notify::raise((Notify::Event) (Notify::DesktopChange+new_desktop));
@@ -1041,6 +1061,7 @@ void Workspace::updateCurrentActivity(const QString &new_activity)
             c->updateVisibility();
     }
 
+    blockVisibilityUpdates(false);
     --block_showing_desktop;
     //FIXME not sure if I should do this either
     if (showingDesktop())   // Do this only after desktop change to avoid flicker
@@ -1506,6 +1527,9 @@ QString Workspace::supportInformation() const
                 support.append(QStringLiteral(" yes\n"));
             else
                 support.append(QStringLiteral(" no\n"));
+            if (const PartialUpdateEngine *partialUpdate = m_compositor->scene()->partialUpdate()) {
+                support.append(partialUpdate->supportInformation());
+            }
             break;
         }
         case XRenderCompositing:
@@ -1518,6 +1542,8 @@ QString Workspace::supportInformation() const
         default:
             support.append(QStringLiteral("Something is really broken, neither OpenGL nor XRender is used"));
         }
+        support.append(m_compositor->unredirectSupportInformation());
+        support.append(m_compositor->outputSupportInformation());
         support.append(QStringLiteral("\nLoaded Effects:\n"));
         support.append(QStringLiteral(  "---------------\n"));
         foreach (const QString &effect, static_cast<EffectsHandlerImpl*>(effects)->loadedEffects()) {
@@ -1537,6 +1563,9 @@ QString Workspace::supportInformation() const
     } else {
         support.append(QStringLiteral("Compositing is not active\n"));
     }
+    support.append(QStringLiteral("\nTiming Statistics\n"));
+    support.append(QStringLiteral(  "=================\n"));
+    support.append(TimingStatistics::supportInformation());
     return support;
 }
 
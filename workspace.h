@@ -26,6 +26,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 // kwin
 #include <kdecoration.h>
 #include "sm.h"
+#include "snapedgeindex.h"
 #include "utils.h"
 // Qt
 #include <QTimer>
@@ -182,8 +183,15 @@ public:
     void restoreSessionStackingOrder(Client* c);
     void updateStackingOrder(bool propagate_new_clients = false);
     void forceRestacking();
+    void blockVisibilityUpdates(bool block);
 
     void clientHidden(Client*);
+    /**
+     * Called by a Client after its mapping state changed. For a @p hidden client the area it
+     * occupied gets repainted and the focus is moved away from it. While visibility updates
+     * are blocked this is done only once for all clients when the block ends.
+     **/
+    void clientMappingChanged(Client* c, bool hidden);
     void clientAttentionChanged(Client* c, bool set);
 
     /**
@@ -264,7 +272,7 @@ public:
     void checkTransients(xcb_window_t w);
 
     void storeSession(KConfig* config, SMSavePhase phase);
-    void storeClient(KConfigGroup &cg, int num, Client *c);
+    void storeClient(QVariantMap &entries, int num, Client *c, const QByteArray &sessionId, const QByteArray &wmCommand);
     void storeSubSession(const QString &name, QSet<QByteArray> sessionIds);
     void loadSubSessionInfo(const QString &name);
 
@@ -509,6 +517,7 @@ private:
     QPoint focusMousePos;
 
     ClientList clients;
+    SnapEdgeIndex m_snapEdges; // edges of the clients for snapping in adjustClientPosition()
     ClientList desktops;
     UnmanagedList unmanaged;
     DeletedList deleted;
@@ -525,12 +534,18 @@ private:
     ClientList showing_desktop_clients;
     int block_showing_desktop;
 
+    int block_visibility_updates; // When > 0, side effects of mapping changes are collected
+    bool pending_mapping_changes;
+    QRegion pending_hidden_region;
+    ClientList pending_hidden_clients;
+
     GroupList groups;
 
     bool was_user_interaction;
     bool session_saving;
     int session_active_client;
     int session_desktop;
+    SessionWriter m_sessionWriter;
 
     int block_focus;
 
@@ -571,6 +586,7 @@ private:
     bool blocked_propagating_new_clients; // Propagate also new clients after enabling stacking updates?
     QScopedPointer<Xcb::Window> m_nullFocus;
     friend class StackingUpdatesBlocker;
+    friend class VisibilityUpdatesBlocker;
 
     QScopedPointer<KillWindow> m_windowKiller;
 
@@ -597,6 +613,24 @@ private:
     Workspace* ws;
 };
 
+/**
+ * Helper for Workspace::blockVisibilityUpdates() being called in pairs (true/false)
+ */
+class VisibilityUpdatesBlocker
+{
+public:
+    explicit VisibilityUpdatesBlocker(Workspace* w)
+        : ws(w) {
+        ws->blockVisibilityUpdates(true);
+    }
+    ~VisibilityUpdatesBlocker() {
+        ws->blockVisibilityUpdates(false);
+    }
+
+private:
+    Workspace* ws;
+};
+
 class ColorMapper : public QObject
 {
     Q_OBJECT
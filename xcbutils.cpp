@@ -487,8 +487,9 @@ QVector<ExtensionData> Extensions::extensions() const
 //****************************************
 // Shm
 //****************************************
-Shm::Shm()
+Shm::Shm(int size)
     : m_shmId(-1)
+    , m_size(size)
     , m_buffer(NULL)
     , m_segment(XCB_NONE)
     , m_valid(false)
@@ -519,8 +520,7 @@ bool Shm::init()
         return false;
     }
     m_pixmapFormat = version->pixmap_format;
-    const int MAXSIZE = 4096 * 2048 * 4; // TODO check there are not larger windows
-    m_shmId = shmget(IPC_PRIVATE, MAXSIZE, IPC_CREAT | 0600);
+    m_shmId = shmget(IPC_PRIVATE, m_size, IPC_CREAT | 0600);
     if (m_shmId < 0) {
         qDebug() << "Failed to allocate SHM segment";
         return false;
@@ -1460,16 +1460,24 @@ void selectInput(xcb_window_t window, uint32_t events)
 class Shm
 {
 public:
-    Shm();
+    /**
+     * Creates and attaches a segment of @p size bytes.
+     **/
+    explicit Shm(int size = 4096 * 2048 * 4); // TODO check there are not larger windows
     ~Shm();
     int shmId() const;
     void *buffer() const;
     xcb_shm_seg_t segment() const;
     bool isValid() const;
     uint8_t pixmapFormat() const;
+    /**
+     * @returns Size of the segment in bytes.
+     **/
+    int size() const;
 private:
     bool init();
     int m_shmId;
+    int m_size;
     void *m_buffer;
     xcb_shm_seg_t m_segment;
     bool m_valid;
@@ -1506,6 +1514,12 @@ uint8_t Shm::pixmapFormat() const
     return m_pixmapFormat;
 }
 
+inline
+int Shm::size() const
+{
+    return m_size;
+}
+
 } // namespace X11
 
 } // namespace KWin